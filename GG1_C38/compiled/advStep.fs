@@ -38,40 +38,36 @@ float dely = 1 / res.y;
 #define VISCOSITY 1
 #define FORCEMULT 0.3
 /**
- * @file advection.fs
+ * @file stencils.fs
  * @author Eron Ristich (eron@ristich.com)
- * @brief Calculates the advection of the fluid
+ * @brief Jacobi, divergence, gradient and advection; generated from cpu/stencilSpec.h by writeStencilGLSL, do not edit
  * @version 0.1
- * @date 2022-09-04
+ * @date 2026-10-18
  */
 
-/*
-From the text; 
-
-q(x, t+del t) = q(x - u(x, t) del t, t)
+// Jacobi iteration
+// Poisson-pressure equation; x -> p, b -> del dot w, alpha -> -(delta x)^2, beta -> 4
+// Viscous x,b -> u (velocity field), alpha = (delta x)^2/v delta t, beta -> 4 + alpha
+void jacobi(vec2 coords, out vec4 xNew, float alpha, float rbeta, sampler2D x, sampler2D b) {
+    xNew = ((((texture(x, coords - vec2(delx, 0)) + texture(x, coords + vec2(delx, 0))) + texture(x, coords - vec2(0, dely))) + texture(x, coords + vec2(0, dely))) + (alpha * texture(b, coords))) * rbeta;
+}
 
-where 
-    x is our position,
-    t is time,
-    del t is change in time, 
-    u(x, t) is velocity at position x at time t
+// Divergence
+void divergence(vec2 coords, out vec4 div, sampler2D x) {
+    div = vec4(((res.x / res.y) * 0.5) * ((texture(x, coords + vec2(delx, 0)).x - texture(x, coords - vec2(delx, 0)).x) + (texture(x, coords + vec2(0, dely)).y - texture(x, coords - vec2(0, dely)).y)));
+}
 
-q is our quantity function
-*/
+// Gradient
+void gradient(vec2 coords, out vec4 uNew, sampler2D p, sampler2D w) {
+    uNew = texture(w, coords);
+    uNew.x = texture(w, coords).x - (((res.x / res.y) * 0.5) * (texture(p, coords + vec2(delx, 0)).x - texture(p, coords - vec2(delx, 0)).x));
+    uNew.y = texture(w, coords).y - (((res.x / res.y) * 0.5) * (texture(p, coords + vec2(0, dely)).x - texture(p, coords - vec2(0, dely)).x));
+}
 
-// uses global variables 
-//  velocity field u -> velTex
-//  quantity field x -> qntTex
-//  delta t (timestep) -> dt
-//  resolution of texture -> res
+// Advection; q(x, t + del t) = q(x - u(x, t) del t, t), averaged over the four neighbors of the backtraced position
 void advect(vec2 coords, out vec4 xNew) {
     vec2 pos = coords - dt * (res.x / res.y) * texture(velTex, coords).xy;
-    vec4 xL = texture(qntTex, pos - vec2(delx, 0));
-    vec4 xR = texture(qntTex, pos + vec2(delx, 0));
-    vec4 xB = texture(qntTex, pos - vec2(0, dely));
-    vec4 xT = texture(qntTex, pos + vec2(0, dely));
-    
-    xNew = mix(mix(xL, xR, 0.5), mix(xB, xT, 0.5), 0.5);
+    xNew = ((texture(qntTex, pos - vec2(delx, 0)) + texture(qntTex, pos + vec2(delx, 0))) + (texture(qntTex, pos - vec2(0, dely)) + texture(qntTex, pos + vec2(0, dely)))) * 0.25;
 }
 
 void main() {
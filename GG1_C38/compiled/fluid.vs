@@ -7,7 +7,7 @@
  */
 #version 430 core
 
-in vec2 pos;
+layout (location = 0) in vec2 pos; // the handler's quad (drawQuad)
 out vec2 uv;
 
 void main() {
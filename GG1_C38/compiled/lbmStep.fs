@@ -0,0 +1,159 @@
+/**
+ * @file lbmStep.fs
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Lattice Boltzmann (D2Q9) step; collide and stream in one pass, replacing the force, diffusion and projection steps
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#version 430 core
+
+layout (location = 0) out vec4 popA;
+layout (location = 1) out vec4 popB;
+layout (location = 2) out vec4 popC;
+layout (location = 3) out vec4 velOut;
+
+in vec2 uv;
+
+uniform int frame;
+uniform float dt;
+uniform vec2 res; // window resolution
+uniform vec2 mpos; // current mouse position
+uniform vec2 rel; // relative mouse movement (in pixels)
+uniform int mDown; // if 0 mouse is up, else, mouse is down
+
+uniform sampler2D velTex; // velocity texture
+uniform sampler2D tmpTex; // temporary texture
+uniform sampler2D prsTex; // pressure texture
+uniform sampler2D qntTex; // quantity texture
+
+uniform sampler2D popATex; // populations 1 to 4
+uniform sampler2D popBTex; // populations 5 to 8
+uniform sampler2D popCTex; // population 0
+uniform int kick; // if 0 the mouse force was already applied this frame
+
+float delx = 1 / res.x;
+float dely = 1 / res.y;
+
+/**
+ * @file constants.fs
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Stores constants for programs to use
+ * @version 0.1
+ * @date 2022-09-05
+ */
+
+#define DENSITY 1
+#define VISCOSITY 1
+#define FORCEMULT 0.3
+/**
+ * @file force.fs
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Calculates the force applied at a point of the fluid
+ * @version 0.1
+ * @date 2022-09-04
+ */
+
+void applyForce(vec2 coords, out vec4 force, float r) {
+    vec2 orgPos = mpos / res; // original mouse position rescaled
+    vec2 relMmt = rel / res; // relative mouse motion rescaled
+
+    vec2 F = relMmt * FORCEMULT;
+
+    force = vec4(F*1/distance(coords, orgPos), 0, 0);
+    //force = vec4(F*exp(pow(distance(coords, orgPos),2) / r) * dt, 0, 0);
+}
+/**
+ * @file lattice.fs
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Constants and equilibrium of the D2Q9 lattice Boltzmann step
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+/*
+Nine populations per texel, f_i moving along c_i, packed into three RGBA32F textures: popA = (f1, f2, f3, f4), popB = (f5, f6, f7, f8)
+and popC = (f0, rho, 0, 1). Density and momentum are their sums,
+
+rho = sum f_i, rho u = sum c_i f_i
+
+and a step streams every f_i one texel along c_i, then relaxes it towards
+
+feq_i = w_i rho (1 + 3 c_i.u + 4.5 (c_i.u)^2 - 1.5 |u|^2)
+
+by 1 / TAU. The lattice viscosity is (TAU - 0.5) / 3 texels squared per step.
+*/
+
+#define LBM_TAU 0.6
+#define LBM_SUBSTEPS 4
+#define LBM_MAXSPEED 0.2
+
+const ivec2 LBM_C[9] = ivec2[9](ivec2(0, 0), ivec2(1, 0), ivec2(0, 1), ivec2(-1, 0), ivec2(0, -1), ivec2(1, 1), ivec2(-1, 1), ivec2(-1, -1), ivec2(1, -1));
+const float LBM_W[9] = float[9](4.0 / 9, 1.0 / 9, 1.0 / 9, 1.0 / 9, 1.0 / 9, 1.0 / 36, 1.0 / 36, 1.0 / 36, 1.0 / 36);
+const int LBM_OPP[9] = int[9](0, 3, 4, 1, 2, 7, 8, 5, 6);
+
+// population i of texel t
+float population(ivec2 t, int i) {
+    if (i == 0)
+        return texelFetch(popCTex, t, 0).x;
+    if (i < 5)
+        return texelFetch(popATex, t, 0)[i - 1];
+    return texelFetch(popBTex, t, 0)[i - 5];
+}
+
+float equilibrium(int i, float rho, vec2 u) {
+    float cu = 3 * dot(vec2(LBM_C[i]), u);
+    return LBM_W[i] * rho * (1 - 1.5 * dot(u, u) + cu + 0.5 * cu * cu);
+}
+
+// texels per lattice step that a velocity of 1 (in the uv units advect() reads) moves the dye by
+vec2 latticeScale() {
+    return dt * (res.x / res.y) * res / LBM_SUBSTEPS;
+}
+
+void main() {
+    ivec2 t = ivec2(gl_FragCoord.xy);
+    ivec2 size = ivec2(res);
+
+    // stream; a population that would come from outside the grid is the opposite one leaving this texel, bounced back by the wall
+    float f[9];
+    for (int i = 0; i < 9; i ++) {
+        ivec2 s = t - LBM_C[i];
+        if (any(lessThan(s, ivec2(0))) || any(greaterThanEqual(s, size)))
+            f[i] = population(t, LBM_OPP[i]);
+        else
+            f[i] = population(s, i);
+    }
+
+    float rho = 0;
+    vec2 u = vec2(0);
+    for (int i = 0; i < 9; i ++) {
+        rho += f[i];
+        u += vec2(LBM_C[i]) * f[i];
+    }
+    u /= rho;
+
+    // the force of frcStep.fs in lattice units, once per frame; the populations move to the equilibrium of the kicked velocity
+    vec2 scale = latticeScale();
+    if (kick != 0 && mDown != 0) {
+        vec4 force;
+        applyForce(uv, force, 0.5);
+        vec2 target = u + force.xy * scale;
+        float speed = length(target);
+        if (speed > LBM_MAXSPEED)
+            target *= LBM_MAXSPEED / speed;
+        for (int i = 0; i < 9; i ++)
+            f[i] += equilibrium(i, rho, target) - equilibrium(i, rho, u);
+        u = target;
+    }
+
+    // collide
+    for (int i = 0; i < 9; i ++)
+        f[i] += (equilibrium(i, rho, u) - f[i]) / LBM_TAU;
+
+    popA = vec4(f[1], f[2], f[3], f[4]);
+    popB = vec4(f[5], f[6], f[7], f[8]);
+    popC = vec4(f[0], rho, 0, 1);
+
+    // the velocity advStep.fs reads; LBM_SUBSTEPS steps move the dye dt * (res.x / res.y) * res * vel texels
+    velOut = vec4(scale.x > 0 ? u / scale : vec2(0), 0, 1);
+}
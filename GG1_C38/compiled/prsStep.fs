@@ -38,47 +38,36 @@ float dely = 1 / res.y;
 #define VISCOSITY 1
 #define FORCEMULT 0.3
 /**
- * @file math.fs
+ * @file stencils.fs
  * @author Eron Ristich (eron@ristich.com)
- * @brief Computes various mathematical operations
+ * @brief Jacobi, divergence, gradient and advection; generated from cpu/stencilSpec.h by writeStencilGLSL, do not edit
  * @version 0.1
- * @date 2022-09-04
+ * @date 2026-10-18
  */
 
 // Jacobi iteration
 // Poisson-pressure equation; x -> p, b -> del dot w, alpha -> -(delta x)^2, beta -> 4
 // Viscous x,b -> u (velocity field), alpha = (delta x)^2/v delta t, beta -> 4 + alpha
 void jacobi(vec2 coords, out vec4 xNew, float alpha, float rbeta, sampler2D x, sampler2D b) {
-    vec4 xL = texture(x, coords - vec2(delx, 0));
-    vec4 xR = texture(x, coords + vec2(delx, 0));
-    vec4 xB = texture(x, coords - vec2(0, dely));
-    vec4 xT = texture(x, coords + vec2(0, dely));
-
-    vec4 bC = texture(b, coords);
-
-    xNew = (xL + xR + xB + xT + alpha * bC) * rbeta;
+    xNew = ((((texture(x, coords - vec2(delx, 0)) + texture(x, coords + vec2(delx, 0))) + texture(x, coords - vec2(0, dely))) + texture(x, coords + vec2(0, dely))) + (alpha * texture(b, coords))) * rbeta;
 }
 
 // Divergence
 void divergence(vec2 coords, out vec4 div, sampler2D x) {
-    vec4 xL = texture(x, coords - vec2(delx, 0));
-    vec4 xR = texture(x, coords + vec2(delx, 0));
-    vec4 xB = texture(x, coords - vec2(0, dely));
-    vec4 xT = texture(x, coords + vec2(0, dely));
-
-    div = vec4((res.x / res.y) * 0.5 * ((xR.x - xL.x) + (xT.y - xB.y)));
-    // div = vec4(0.5 * (res.x * (xR.x - xL.x) + res.y * (xT.y - xB.y))); // Ҳû
+    div = vec4(((res.x / res.y) * 0.5) * ((texture(x, coords + vec2(delx, 0)).x - texture(x, coords - vec2(delx, 0)).x) + (texture(x, coords + vec2(0, dely)).y - texture(x, coords - vec2(0, dely)).y)));
 }
 
 // Gradient
 void gradient(vec2 coords, out vec4 uNew, sampler2D p, sampler2D w) {
-    float pL = texture(p, coords - vec2(delx, 0)).x;
-    float pR = texture(p, coords + vec2(delx, 0)).x;
-    float pB = texture(p, coords - vec2(0, dely)).x;
-    float pT = texture(p, coords + vec2(0, dely)).x;
-    
     uNew = texture(w, coords);
-    uNew.xy -= (res.x / res.y) * 0.5 * vec2(pR - pL, pT - pB);
+    uNew.x = texture(w, coords).x - (((res.x / res.y) * 0.5) * (texture(p, coords + vec2(delx, 0)).x - texture(p, coords - vec2(delx, 0)).x));
+    uNew.y = texture(w, coords).y - (((res.x / res.y) * 0.5) * (texture(p, coords + vec2(0, dely)).x - texture(p, coords - vec2(0, dely)).x));
+}
+
+// Advection; q(x, t + del t) = q(x - u(x, t) del t, t), averaged over the four neighbors of the backtraced position
+void advect(vec2 coords, out vec4 xNew) {
+    vec2 pos = coords - dt * (res.x / res.y) * texture(velTex, coords).xy;
+    xNew = ((texture(qntTex, pos - vec2(delx, 0)) + texture(qntTex, pos + vec2(delx, 0))) + (texture(qntTex, pos - vec2(0, dely)) + texture(qntTex, pos + vec2(0, dely)))) * 0.25;
 }
 
 void main() {
@@ -0,0 +1,82 @@
+/**
+ * @file activeBlocks.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Block level map of where the fluid is in motion, so the CPU engine's passes can skip the still parts of the grid
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "activeBlocks.h"
+
+#include <cmath>
+
+ActiveBlocks::ActiveBlocks(int rx, int ry) : rx(rx), ry(ry) {
+    bx = (rx + ACTIVE_BLOCK - 1) / ACTIVE_BLOCK;
+    by = (ry + ACTIVE_BLOCK - 1) / ACTIVE_BLOCK;
+    flags.assign((size_t)bx * by, 0);
+    scratch.assign((size_t)bx * by, 0);
+
+    // the most spans there can be (every other block of every row), so that buildSpans never allocates
+    runs.reserve((size_t)by * ((bx + 1) / 2));
+}
+
+void ActiveBlocks::clear() {
+    for (uint8_t& f : flags)
+        f = 0;
+}
+
+void ActiveBlocks::fill() {
+    for (uint8_t& f : flags)
+        f = 1;
+}
+
+// v clamped to [lo, hi], before it is converted to an int
+static float clampf(float v, float lo, float hi) {
+    return std::fmin(std::fmax(v, lo), hi);
+}
+
+void ActiveBlocks::markRect(float x0, float y0, float x1, float y1) {
+    int i0 = (int)std::floor(clampf(x0, 0.0f, (float)rx) / ACTIVE_BLOCK), i1 = (int)std::floor(clampf(x1, -1.0f, (float)rx - 1) / ACTIVE_BLOCK);
+    int j0 = (int)std::floor(clampf(y0, 0.0f, (float)ry) / ACTIVE_BLOCK), j1 = (int)std::floor(clampf(y1, -1.0f, (float)ry - 1) / ACTIVE_BLOCK);
+    for (int j = j0; j <= j1; j ++)
+        for (int i = i0; i <= i1; i ++)
+            mark(i, j);
+}
+
+void ActiveBlocks::dilate() {
+    scratch = flags;
+    for (int j = 0; j < by; j ++) {
+        for (int i = 0; i < bx; i ++) {
+            if (!scratch[(size_t)j * bx + i])
+                continue;
+            for (int dj = -1; dj <= 1; dj ++)
+                for (int di = -1; di <= 1; di ++)
+                    if (i + di >= 0 && i + di < bx && j + dj >= 0 && j + dj < by)
+                        mark(i + di, j + dj);
+        }
+    }
+}
+
+void ActiveBlocks::buildSpans() {
+    runs.clear();
+    for (int j = 0; j < by; j ++) {
+        int y0 = j * ACTIVE_BLOCK, y1 = y0 + ACTIVE_BLOCK < ry ? y0 + ACTIVE_BLOCK : ry;
+        for (int i = 0; i < bx; i ++) {
+            if (!active(i, j))
+                continue;
+            int e = i;
+            while (e + 1 < bx && active(e + 1, j))
+                e ++;
+            int x1 = (e + 1) * ACTIVE_BLOCK;
+            runs.push_back({ i * ACTIVE_BLOCK, x1 < rx ? x1 : rx, y0, y1 });
+            i = e;
+        }
+    }
+}
+
+int ActiveBlocks::count() const {
+    int n = 0;
+    for (uint8_t f : flags)
+        n += f;
+    return n;
+}
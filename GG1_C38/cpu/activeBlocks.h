@@ -0,0 +1,66 @@
+/**
+ * @file activeBlocks.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Block level map of where the fluid is in motion, so the CPU engine's passes can skip the still parts of the grid
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_ACTIVE_BLOCKS_H
+#define CPU_ACTIVE_BLOCKS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// side of a block in texels
+#define ACTIVE_BLOCK 32
+
+/*
+The grid is cut into ACTIVE_BLOCK x ACTIVE_BLOCK blocks (the last row and column of blocks may be partial) with one flag each. A
+frame's map is built from the blocks whose velocity or dye the previous frame left above a threshold, plus the blocks under the
+splat and the force, grown by one block on every side so that fluid can move into its neighbors. spans() then lists the runs of active
+blocks in each block row, which is what the passes iterate over.
+
+Flags are bytes rather than bits so that tiles on different threads can set the flags of their own blocks without atomics.
+*/
+
+class ActiveBlocks {
+    public:
+        // columns [x0, x1) of rows [y0, y1); a maximal run of active blocks within one block row
+        struct Span {
+            int x0, x1, y0, y1;
+        };
+
+        ActiveBlocks() : rx(0), ry(0), bx(0), by(0) {}
+        ActiveBlocks(int rx, int ry);
+
+        void clear();
+        void fill();
+
+        void mark(int i, int j) { flags[(size_t)j * bx + i] = 1; }
+        bool active(int i, int j) const { return flags[(size_t)j * bx + i] != 0; }
+
+        // marks every block overlapping texels [x0, x1) x [y0, y1), clipped to the grid
+        void markRect(float x0, float y0, float x1, float y1);
+
+        // adds the neighbors of every active block, diagonals included
+        void dilate();
+
+        // rebuilds spans() from the flags
+        void buildSpans();
+        const std::vector<Span>& spans() const { return runs; }
+
+        int count() const;
+        int blocks() const { return bx * by; }
+
+        int rx, ry;
+        int bx, by; // blocks per row and column
+
+    private:
+        std::vector<uint8_t> flags;
+        std::vector<uint8_t> scratch;
+        std::vector<Span> runs;
+};
+
+#endif
@@ -0,0 +1,978 @@
+/**
+ * @file bench.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Headless benchmarks of the CPU engine, run from the command line instead of opening a window
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "bench.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../util/haloTransport.h"
+#include "../../util/mappedFile.h"
+#include "../../util/threadPool.h"
+#include "cpuFluid.h"
+#include "ensembleFluid.h"
+#include "layout.h"
+#include "lbmFluid.h"
+#include "slabFluid.h"
+
+/**
+ * @brief Input for frame i of a benchmark run; the mouse is held down and circles the center so the splat and force keep the work uneven
+ */
+static FluidInput benchInput(int i, int res) {
+    FluidInput in;
+    in.frame = i;
+    in.dt = 1.0f / 60.0f;
+    in.mx = res * (0.5f + 0.25f * (float)((i % 64) - 32) / 32.0f);
+    in.my = res * 0.5f;
+    in.relx = 4.0f;
+    in.rely = 2.0f;
+    in.mDown = true;
+    return in;
+}
+
+/**
+ * @brief Seconds per frame of the solver on a pool of the given size, after a few warm up frames
+ */
+static double timeFrames(int res, int frames, ThreadPool* pool) {
+    CpuFluid fluid(res, res, pool);
+    for (int i = 0; i < 3; i ++)
+        fluid.step(benchInput(i, res));
+
+    if (pool != NULL)
+        pool->resetSteals();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i ++)
+        fluid.step(benchInput(i + 3, res));
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+    return d.count() / frames;
+}
+
+/**
+ * @brief Seconds per frame of stepping fluid for frames frames, leaving its state for comparison
+ */
+static double timeFrames(CpuFluid& fluid, int res, int frames) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i ++)
+        fluid.step(benchInput(i, res));
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+    return d.count() / frames;
+}
+
+// best time of f over reps runs
+static double bestOf(int reps, const std::function<void()>& f) {
+    double t = 1e30;
+    for (int r = 0; r < reps; r ++) {
+        auto t0 = std::chrono::steady_clock::now();
+        f();
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+        t = d.count() < t ? d.count() : t;
+    }
+    return t;
+}
+
+// whether two planes hold the same bits on every texel
+static bool samePlane(const Field<float>& a, const Field<float>& b) {
+    for (int y = 0; y < a.ry; y ++)
+        if (memcmp(a.row(y), b.row(y), a.rx * sizeof(float)) != 0)
+            return false;
+    return true;
+}
+
+void benchThreads(int res, int frames) {
+    int hw = (int)std::thread::hardware_concurrency();
+    printf("thread scaling, %dx%d, %d frames, %d hardware threads\n", res, res, frames, hw);
+    printf("%8s %12s %9s %11s %10s\n", "threads", "ms/frame", "speedup", "efficiency", "steals");
+
+    double base = 0.0;
+    for (int t = 1; t <= 64; t *= 2) {
+        ThreadPool pool(t);
+        double s = timeFrames(res, frames, &pool);
+        if (t == 1)
+            base = s;
+        printf("%8d %12.3f %9.2f %10.0f%% %10lld%s\n", t, s * 1000.0, base / s, 100.0 * base / s / t,
+            pool.getSteals() / frames, t > hw ? "  (oversubscribed)" : "");
+    }
+}
+
+void benchJacobi(int res, int reps) {
+    ThreadPool pool;
+
+    Field<float> div(res, res), ref(res, res), x(res, res), tmp(res, res);
+    const StencilKernels& k = selectKernels(res, div.stride);
+    Grid g = { res, res, div.stride };
+
+    // a smooth right hand side with a few sharp features
+    for (int y = 0; y < res; y ++)
+        for (int i = 0; i < res; i ++)
+            div.at(i, y) = 0.001f * (float)((i * 7 + y * 13) % 101) - 0.05f;
+
+    printf("temporal blocking, pressure solve %dx%d, 40 iterations, %d threads\n", res, res, pool.size());
+    printf("%6s %6s %12s %9s %14s %10s\n", "depth", "band", "ms/solve", "speedup", "est. traffic", "identical");
+
+    double base = 0.0;
+    for (int depth = 1; depth <= 16; depth *= 2) {
+        BlockedJacobi solver(res, res, depth, &pool);
+
+        double best = 1e30;
+        for (int r = 0; r < reps; r ++) {
+            x.fill(0.0f);
+            auto t0 = std::chrono::steady_clock::now();
+            solver.solve(k, x, tmp, &div, g, 40, -1.0f / (res * res), 0.25f);
+            std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+            best = d.count() < best ? d.count() : best;
+        }
+
+        if (depth == 1) {
+            base = best;
+            for (int y = 0; y < res; y ++)
+                memcpy(ref.row(y), x.row(y), res * sizeof(float));
+        }
+        bool same = true;
+        for (int y = 0; y < res && same; y ++)
+            same = memcmp(ref.row(y), x.row(y), res * sizeof(float)) == 0;
+
+        printf("%6d %6d %12.3f %9.2f %13.0f%% %10s\n", depth, solver.getBandRows(), best * 1000.0, base / best,
+            100.0 * solver.trafficRatio(true), same ? "yes" : "NO");
+    }
+}
+
+void benchSizes(int reps) {
+    const StencilKernels& generic = selectKernels();
+    printf("size specialized kernels, %s, single thread, best of %d\n", isaName(generic.isa), reps);
+    printf("%6s %10s %12s %14s %9s %10s\n", "size", "kernel", "generic ms", "specialized ms", "speedup", "identical");
+
+    const int sizes[] = { STENCIL_SIZES };
+    for (int res : sizes) {
+        Field<float> x(res, res), b(res, res), a(res, res), c(res, res);
+        Grid g = { res, res, x.stride };
+        const StencilKernels& sized = getKernels(generic.isa, res, x.stride);
+
+        for (int y = 0; y < res; y ++) {
+            for (int i = 0; i < res; i ++) {
+                x.at(i, y) = 0.001f * (float)((i * 7 + y * 13) % 101);
+                b.at(i, y) = 0.002f * (float)((i * 3 + y * 5) % 37);
+            }
+        }
+
+        // best time of a kernel over the whole plane
+        auto best = [&](const std::function<void()>& f) {
+            double t = 1e30;
+            for (int r = 0; r < reps; r ++) {
+                auto t0 = std::chrono::steady_clock::now();
+                f();
+                std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+                t = d.count() < t ? d.count() : t;
+            }
+            return t;
+        };
+        auto report = [&](const char* name, double tg, double ts) {
+            printf("%6d %10s %12.3f %14.3f %9.2f %10s\n", res, name, tg * 1000.0, ts * 1000.0, tg / ts, samePlane(a, c) ? "yes" : "NO");
+        };
+
+        double tg = best([&]() { generic.jacobi(a.data(), x.data(), b.data(), g, 0, res, -0.25f, 0.25f); });
+        double ts = best([&]() { sized.jacobi(c.data(), x.data(), b.data(), g, 0, res, -0.25f, 0.25f); });
+        report("jacobi", tg, ts);
+
+        tg = best([&]() { generic.divergence(a.data(), x.data(), b.data(), g, 0, res, 0.5f); });
+        ts = best([&]() { sized.divergence(c.data(), x.data(), b.data(), g, 0, res, 0.5f); });
+        report("divergence", tg, ts);
+    }
+}
+
+void benchFused(int res, int frames) {
+    ThreadPool pool;
+    CpuOptions separate;
+    separate.fused = false;
+    CpuFluid ref(res, res, &pool, separate);
+    CpuFluid fused(res, res, &pool);
+
+    printf("fused passes, %dx%d, %d frames, %d threads\n", res, res, frames, pool.size());
+    double s = timeFrames(ref, res, frames);
+    double f = timeFrames(fused, res, frames);
+
+    bool same = samePlane(ref.velU, fused.velU) && samePlane(ref.velV, fused.velV) && samePlane(ref.prs, fused.prs) && samePlane(ref.div, fused.div);
+    for (int c = 0; c < 3; c ++)
+        same = same && samePlane(ref.qnt[c], fused.qnt[c]);
+
+    printf("%10s %12s\n", "passes", "ms/frame");
+    printf("%10s %12.3f\n", "separate", s * 1000.0);
+    printf("%10s %12.3f  (%.2fx)\n", "fused", f * 1000.0, s / f);
+    printf("identical: %s\n", same ? "yes" : "NO");
+}
+
+void benchGraph(int res, int frames) {
+    ThreadPool pool;
+    CpuOptions barriers;
+    barriers.graph = false;
+    CpuFluid ref(res, res, &pool, barriers);
+    CpuFluid graph(res, res, &pool);
+
+    printf("task graph, %dx%d, %d frames, %d threads\n", res, res, frames, pool.size());
+    if (graph.getGraph() == NULL) {
+        printf("the graph needs 2 or more threads\n");
+        return;
+    }
+    double b = timeFrames(ref, res, frames);
+    double g = timeFrames(graph, res, frames);
+
+    bool same = samePlane(ref.velU, graph.velU) && samePlane(ref.velV, graph.velV) && samePlane(ref.prs, graph.prs) && samePlane(ref.div, graph.div);
+    for (int c = 0; c < 3; c ++)
+        same = same && samePlane(ref.qnt[c], graph.qnt[c]);
+
+    printf("%10s %12s\n", "schedule", "ms/frame");
+    printf("%10s %12.3f\n", "barriers", b * 1000.0);
+    printf("%10s %12.3f  (%.2fx)\n", "graph", g * 1000.0, b / g);
+    printf("identical: %s\n", same ? "yes" : "NO");
+    printf("%d nodes:\n", graph.getGraph()->size());
+    graph.getGraph()->dump(stdout);
+}
+
+void benchExecutors(int res, int frames) {
+    std::vector<const char*> names = availableExecutors();
+    int threads = (int)std::thread::hardware_concurrency();
+    std::vector<float> ref((size_t)res * res * 4), dye((size_t)res * res * 4);
+
+    printf("executors, %dx%d, %d frames, %d threads\n", res, res, frames, threads);
+    printf("%8s %8s %12s %12s %14s %10s\n", "backend", "slots", "ms/frame", "reduce ms", "sum |u|^2", "identical");
+    for (size_t e = 0; e < names.size(); e ++) {
+        Executor* exec = makeExecutor(names[e], threads);
+        double f, r, energy = 0.0;
+        {
+            CpuFluid fluid(res, res, exec);
+            for (int i = 0; i < 2; i ++)
+                fluid.step(benchInput(i, res));
+            f = timeFrames(fluid, res, frames);
+
+            // a reduction over the final velocity, tiled like the passes
+            r = bestOf(5, [&]() {
+                energy = exec->parallelReduce(res, 16, [&](int y0, int y1) {
+                    double s = 0.0;
+                    for (int y = y0; y < y1; y ++) {
+                        const float* u = fluid.velU.row(y);
+                        const float* v = fluid.velV.row(y);
+                        for (int x = 0; x < res; x ++)
+                            s += (double)u[x] * u[x] + (double)v[x] * v[x];
+                    }
+                    return s;
+                });
+            });
+            fluid.writeQuantity(e == 0 ? ref.data() : dye.data());
+        }
+        bool same = e == 0 || memcmp(ref.data(), dye.data(), ref.size() * sizeof(float)) == 0;
+        printf("%8s %8d %12.3f %12.3f %14.8g %10s\n", names[e], exec->size(), f * 1000.0, r * 1000.0, energy, same ? "yes" : "NO");
+        delete exec;
+    }
+}
+
+void benchReduce(int res, int reps) {
+    // a velocity field to reduce over: a few frames of the engine
+    Field<float> u(res, res), v(res, res);
+    {
+        ThreadPool pool;
+        CpuFluid fluid(res, res, &pool);
+        for (int i = 0; i < 10; i ++)
+            fluid.step(benchInput(i, res));
+        for (int y = 0; y < res; y ++) {
+            memcpy(u.row(y), fluid.velU.row(y), res * sizeof(float));
+            memcpy(v.row(y), fluid.velV.row(y), res * sizeof(float));
+        }
+    }
+    auto rows = [&](int y0, int y1) {
+        double s = 0.0;
+        for (int y = y0; y < y1; y ++) {
+            const float* a = u.row(y);
+            const float* b = v.row(y);
+            for (int x = 0; x < res; x ++)
+                s += (double)a[x] * a[x] + (double)b[x] * b[x];
+        }
+        return s;
+    };
+
+    const int METHODS = 4, GRAIN = 16;
+    const char* names[METHODS] = { "atomic", "per thread", "tree", "compensated" };
+    double first[METHODS];
+    bool same[METHODS] = { true, true, true, true };
+
+    printf("reductions of |u|^2 over %dx%d, tiles of %d rows, best of %d\n", res, res, GRAIN, reps);
+    printf("%8s", "threads");
+    for (int m = 0; m < METHODS; m ++)
+        printf(" %13s", names[m]);
+    printf("   (ms, and the low 16 bits of the sum)\n");
+
+    for (int t = 1; t <= 64; t *= 2) {
+        ThreadPool pool(t);
+        double value[METHODS], ms[METHODS];
+
+        // baselines: one atomic accumulator every tile adds into, and partial sums per thread added in thread order
+        ms[0] = bestOf(reps, [&]() {
+            std::atomic<double> sum(0.0);
+            pool.parallelFor(res, GRAIN, [&](int y0, int y1) {
+                double s = rows(y0, y1), cur = sum.load();
+                while (!sum.compare_exchange_weak(cur, cur + s))
+                    ;
+            });
+            value[0] = sum.load();
+        });
+        ms[1] = bestOf(reps, [&]() {
+            struct alignas(64) Partial { double sum; };
+            std::vector<Partial> partial(t, Partial{ 0.0 });
+            pool.parallelFor(res, GRAIN, [&](int y0, int y1) {
+                partial[Executor::currentThread()].sum += rows(y0, y1);
+            });
+            value[1] = 0.0;
+            for (const Partial& p : partial)
+                value[1] += p.sum;
+        });
+        ms[2] = bestOf(reps, [&]() { value[2] = pool.parallelReduce(res, GRAIN, rows); });
+        ms[3] = bestOf(reps, [&]() { value[3] = pool.parallelReduce(res, GRAIN, rows, Combine::CompensatedSum); });
+
+        printf("%8d", t);
+        for (int m = 0; m < METHODS; m ++) {
+            if (t == 1)
+                first[m] = value[m];
+            same[m] = same[m] && memcmp(&value[m], &first[m], sizeof(double)) == 0;
+            unsigned long long bits;
+            memcpy(&bits, &value[m], sizeof(bits));
+            printf(" %7.3f  %04llx", ms[m] * 1000.0, bits & 0xffff);
+        }
+        printf("\n");
+    }
+    printf("%8s", "same");
+    for (int m = 0; m < METHODS; m ++)
+        printf(" %13s", same[m] ? "every count" : "NO");
+    printf("\n");
+
+    // the engine's own reductions, after the same frames on every thread count
+    printf("\n%8s %22s %22s %22s\n", "threads", "kinetic energy", "max speed", "pressure residual");
+    double ref[3];
+    bool engineSame = true;
+    for (int t = 1; t <= 64; t *= 2) {
+        ThreadPool pool(t);
+        CpuFluid fluid(res, res, &pool);
+        for (int i = 0; i < 10; i ++)
+            fluid.step(benchInput(i, res));
+        double d[3] = { fluid.kineticEnergy(), fluid.maxSpeed(), fluid.pressureResidual() };
+        for (int k = 0; k < 3; k ++) {
+            if (t == 1)
+                ref[k] = d[k];
+            engineSame = engineSame && memcmp(&d[k], &ref[k], sizeof(double)) == 0;
+        }
+        printf("%8d %22.17g %22.17g %22.17g\n", t, d[0], d[1], d[2]);
+    }
+    printf("identical on every thread count: %s\n", engineSame ? "yes" : "NO");
+}
+
+void benchHalf(int res, int frames) {
+    ThreadPool pool;
+    CpuOptions plainOpts, halfOpts;
+    plainOpts.blockDepth = 1;
+    plainOpts.fused = false;
+    halfOpts.half = true;
+    CpuFluid full(res, res, &pool);
+    CpuFluid plain(res, res, &pool, plainOpts);
+    CpuFluid half(res, res, &pool, halfOpts);
+
+    printf("half storage, %dx%d, %d frames, %d threads\n", res, res, frames, pool.size());
+    double f = timeFrames(full, res, frames);
+    double p = timeFrames(plain, res, frames);
+    double h = timeFrames(half, res, frames);
+
+    std::vector<float> a((size_t)res * res * 4), b((size_t)res * res * 4);
+    full.writeQuantity(a.data());
+    half.writeQuantity(b.data());
+    double maxDiff = 0.0, maxDye = 0.0;
+    for (size_t i = 0; i < a.size(); i ++) {
+        maxDiff = std::fmax(maxDiff, std::fabs(a[i] - b[i]));
+        maxDye = std::fmax(maxDye, std::fabs(a[i]));
+    }
+
+    // half mode runs plain passes, so the like for like comparison is float without blocking and fusion
+    printf("%22s %12s\n", "storage", "ms/frame");
+    printf("%22s %12.3f\n", "float", f * 1000.0);
+    printf("%22s %12.3f\n", "float, plain passes", p * 1000.0);
+    printf("%22s %12.3f  (%.2fx plain float)\n", "half, plain passes", h * 1000.0, p / h);
+    printf("dye: max difference %g, max value %g\n", maxDiff, maxDye);
+}
+
+void benchArena(int res, int frames) {
+    ThreadPool pool;
+    CpuOptions modes[4];
+    modes[1].blockDepth = 1;
+    modes[1].fused = false;
+    modes[2].half = true;
+    modes[3].sparse = true;
+    const char* names[] = { "float", "float, plain passes", "half", "sparse" };
+
+    printf("frame arena, %dx%d, %d frames after 2 warm up frames, %d threads\n", res, res, frames, pool.size());
+    // a spill is the arena falling back to the heap; steady state frames should make none, and the engine allocates its scratch nowhere else
+    printf("%20s %10s %12s %10s %12s %12s\n", "engine", "ms/frame", "capacity MB", "frame MB", "warm spills", "spills");
+    for (int m = 0; m < 4; m ++) {
+        CpuFluid fluid(res, res, &pool, modes[m]);
+        for (int i = 0; i < 2; i ++)
+            fluid.step(benchInput(i, res));
+        long long warm = fluid.getArenaStats().totalSpills;
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i ++)
+            fluid.step(benchInput(i + 2, res));
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+
+        ArenaStats st = fluid.getArenaStats();
+        printf("%20s %10.3f %12.1f %10.1f %12lld %12lld\n", names[m], d.count() / frames * 1000.0, st.capacity / 1048576.0,
+            st.highWater / 1048576.0, warm, st.totalSpills - warm);
+        if (m == 3)
+            printf("arena backed by %s\n", pageKindName(st.pages));
+    }
+}
+
+void benchSparse(int res, int frames) {
+    ThreadPool pool;
+    CpuOptions sparseOpts;
+    sparseOpts.sparse = true;
+    CpuFluid full(res, res, &pool);
+    CpuFluid sparse(res, res, &pool, sparseOpts);
+
+    printf("sparse blocks, %dx%d, %d frames per phase, %d threads, threshold %g\n", res, res, frames, pool.size(), sparseOpts.sparseEps);
+    printf("%10s %14s %14s %9s %10s %14s\n", "phase", "full ms/frame", "sparse ms/frame", "speedup", "active", "dye max diff");
+
+    std::vector<float> a((size_t)res * res * 4), b((size_t)res * res * 4);
+    const char* phases[] = { "click", "drag", "release" };
+    int frame = 0;
+    for (int p = 0; p < 3; p ++) {
+        double tf = 0.0, ts = 0.0, active = 0.0;
+        for (int i = 0; i < frames; i ++, frame ++) {
+            // clicks hold still (no force, only the splat); drags move by a few pixels a frame
+            FluidInput in = benchInput(frame, res);
+            in.mx = res * 0.25f;
+            in.my = res * 0.25f;
+            in.relx = p == 1 ? 4.0f : 0.0f;
+            in.rely = p == 1 ? 2.0f : 0.0f;
+            in.mDown = p < 2;
+
+            auto t0 = std::chrono::steady_clock::now();
+            full.step(in);
+            auto t1 = std::chrono::steady_clock::now();
+            sparse.step(in);
+            auto t2 = std::chrono::steady_clock::now();
+            tf += std::chrono::duration<double>(t1 - t0).count();
+            ts += std::chrono::duration<double>(t2 - t1).count();
+            active += (double)sparse.getActivity().count() / sparse.getActivity().blocks();
+        }
+
+        full.writeQuantity(a.data());
+        sparse.writeQuantity(b.data());
+        double maxDiff = 0.0;
+        for (size_t i = 0; i < a.size(); i ++)
+            maxDiff = std::fmax(maxDiff, std::fabs(a[i] - b[i]));
+
+        printf("%10s %14.3f %14.3f %9.2f %9.0f%% %14g\n", phases[p], tf / frames * 1000.0, ts / frames * 1000.0, tf / ts,
+            100.0 * active / frames, maxDiff);
+    }
+}
+
+/**
+ * @brief Best times of the four layout passes in layout L over the row major planes in, whose results are checked against ref
+ *
+ * @param in u, v, p and q planes
+ * @param ref Results of the row major kernels: jacobi, divergence, gradient u, gradient v and advected q
+ * @param t Seconds per pass: jacobi, divergence, gradient, advect
+ * @return Whether every result matched ref bit for bit
+ */
+template<class L>
+static bool timeLayout(const Field<float>* in, const Field<float>* ref, int reps, float kx, float ky, double* t) {
+    int rx = in[0].rx, ry = in[0].ry;
+    LayoutField<float, L> u(rx, ry), v(rx, ry), p(rx, ry), q(rx, ry), a(rx, ry), b(rx, ry);
+    u.load(in[0]);
+    v.load(in[1]);
+    p.load(in[2]);
+    q.load(in[3]);
+
+    Field<float> out(rx, ry);
+    bool same = true;
+    auto check = [&](const LayoutField<float, L>& f, const Field<float>& r) {
+        f.store(out);
+        same = same && samePlane(out, r);
+    };
+
+    t[0] = bestOf(reps, [&]() { layoutJacobi(a, p, u, -0.25f, 0.25f); });
+    check(a, ref[0]);
+    t[1] = bestOf(reps, [&]() { layoutDivergence(a, u, v, 0.5f); });
+    check(a, ref[1]);
+    t[2] = bestOf(reps, [&]() { layoutGradient(a, b, u, v, p, 0.5f); });
+    check(a, ref[2]);
+    check(b, ref[3]);
+    t[3] = bestOf(reps, [&]() { layoutAdvect(a, q, u, v, kx, ky); });
+    check(a, ref[4]);
+    return same;
+}
+
+void benchLayouts(int maxRes, int reps) {
+    const StencilKernels& k = selectKernels();
+    const char* passes[] = { "jacobi", "divergence", "gradient", "advect" };
+    const Layout layouts[] = { Layout::Row, Layout::Tile32, Layout::Tile64, Layout::Morton };
+    printf("field layouts, single thread, best of %d; ms per pass (vector: the engine's row major %s kernels)\n", reps, isaName(k.isa));
+    printf("%6s %10s %9s %9s %9s %9s %9s %8s\n", "size", "pass", "vector", "row", "tile 32", "tile 64", "morton", "best");
+
+    for (int res = 512; res <= maxRes; res *= 2) {
+        Field<float> in[4] = { Field<float>(res, res), Field<float>(res, res), Field<float>(res, res), Field<float>(res, res) };
+        Field<float> ref[5] = { Field<float>(res, res), Field<float>(res, res), Field<float>(res, res), Field<float>(res, res), Field<float>(res, res) };
+        Grid g = { res, res, in[0].stride };
+
+        // a swirling velocity, so the advection taps land a few texels away in every direction
+        for (int y = 0; y < res; y ++) {
+            for (int i = 0; i < res; i ++) {
+                in[0].at(i, y) = 0.002f * (float)((y * 13 + i * 3) % 61) - 0.06f;
+                in[1].at(i, y) = 0.002f * (float)((i * 11 + y * 5) % 67) - 0.066f;
+                in[2].at(i, y) = 0.001f * (float)((i * 7 + y * 13) % 101);
+                in[3].at(i, y) = 0.01f * (float)((i ^ y) & 63);
+            }
+        }
+        for (int c = 0; c < 4; c ++)
+            in[c].fillHalo(Border::Zero);
+
+        float kx = res / 60.0f, ky = res / 60.0f;
+        const float* q[1] = { in[3].data() };
+        float* qo[1] = { ref[4].data() };
+        double t[5][4];
+        t[0][0] = bestOf(reps, [&]() { k.jacobi(ref[0].data(), in[2].data(), in[0].data(), g, 0, res, -0.25f, 0.25f); });
+        t[0][1] = bestOf(reps, [&]() { k.divergence(ref[1].data(), in[0].data(), in[1].data(), g, 0, res, 0.5f); });
+        t[0][2] = bestOf(reps, [&]() { k.gradient(ref[2].data(), ref[3].data(), in[0].data(), in[1].data(), in[2].data(), g, 0, res, 0.5f); });
+        t[0][3] = bestOf(reps, [&]() { k.advect(qo, q, 1, in[0].data(), in[1].data(), g, 0, res, 0, res, kx, ky); });
+
+        bool same = timeLayout<RowLayout>(in, ref, reps, kx, ky, t[1]);
+        same = timeLayout<TileLayout<32>>(in, ref, reps, kx, ky, t[2]) && same;
+        same = timeLayout<TileLayout<64>>(in, ref, reps, kx, ky, t[3]) && same;
+        same = timeLayout<MortonLayout>(in, ref, reps, kx, ky, t[4]) && same;
+
+        for (int s = 0; s < 4; s ++) {
+            // the winner among the layout passes; the vector row kernels are the baseline, not a contender
+            int best = 1;
+            for (int l = 2; l < 5; l ++)
+                best = t[l][s] < t[best][s] ? l : best;
+            printf("%6d %10s %9.3f %9.3f %9.3f %9.3f %9.3f %8s\n", res, passes[s], t[0][s] * 1000.0, t[1][s] * 1000.0, t[2][s] * 1000.0,
+                t[3][s] * 1000.0, t[4][s] * 1000.0, layoutName(layouts[best - 1]));
+        }
+        printf("%6d identical to the row kernels: %s\n", res, same ? "yes" : "NO");
+    }
+}
+
+/*
+Domain decomposition runs share this block (HaloTransport::shared()): the run's parameters, what each rank measured, and the dye every
+rank writes its slab of at the end
+*/
+#define DECOMP_MAX_RANKS 64
+
+struct DecompResult {
+    int frames;
+    double seconds; // per frame, as rank 0 measured between barriers
+    HaloStats stats[DECOMP_MAX_RANKS];
+};
+
+struct DecompRun {
+    int rx, ry, overlap;
+    std::atomic<int> go; // set by rank 0 once every worker process started: 1 to run, -1 to give up
+    DecompResult result;
+};
+
+static size_t decompBytes(int rx, int ry) {
+    return sizeof(DecompRun) + (size_t)rx * ry * 4 * sizeof(float);
+}
+
+/**
+ * @brief One rank's part of a run: warm up, frames between barriers, then its slab of the dye
+ */
+static void runRank(HaloTransport* link) {
+    DecompRun* run = (DecompRun*)link->shared();
+    float* dye = (float*)(run + 1);
+    SlabFluid fluid(run->rx, run->ry, link);
+    fluid.overlap = run->overlap != 0;
+
+    for (int i = 0; i < 3; i ++)
+        fluid.step(benchInput(i, run->rx));
+    link->barrier();
+    link->resetStats();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < run->result.frames; i ++)
+        fluid.step(benchInput(i + 3, run->rx));
+    link->barrier();
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+
+    if (link->rank() == 0)
+        run->result.seconds = d.count() / run->result.frames;
+    run->result.stats[link->rank()] = link->getStats();
+    fluid.writeQuantity(dye);
+    link->barrier();
+}
+
+int runDecompWorker(const char* segment, int rank) {
+    SharedMemoryTransport* link = SharedMemoryTransport::open(segment, rank);
+    if (link == NULL) {
+        printf("rank %d: cannot open shared memory %s\n", rank, segment);
+        return 1;
+    }
+    DecompRun* run = (DecompRun*)link->shared();
+    while (run->go.load(std::memory_order_acquire) == 0)
+        std::this_thread::yield();
+    if (run->go.load() > 0)
+        runRank(link);
+    delete link;
+    return 0;
+}
+
+/**
+ * @brief A run over ranks worker processes (rank 0 is this one) on shared memory; fills dye with the result. false if it could not start
+ */
+static bool runProcesses(int rx, int ry, int ranks, int frames, DecompResult* result, std::vector<float>* dye) {
+    static int runs = 0;
+    std::string name = "gg1c38-" + std::to_string(processId()) + "-" + std::to_string(runs ++);
+    SharedMemoryTransport* link = SharedMemoryTransport::create(name, ranks, decompBytes(rx, ry));
+    if (link == NULL) {
+        printf("cannot create shared memory %s\n", name.c_str());
+        return false;
+    }
+    DecompRun* run = new (link->shared()) DecompRun();
+    run->rx = rx;
+    run->ry = ry;
+    run->result.frames = frames;
+    run->overlap = 1;
+
+    std::vector<intptr_t> workers;
+    for (int r = 1; r < ranks; r ++) {
+        intptr_t p = launchSelf({ "--decomp-worker", name, std::to_string(r) });
+        if (p == 0)
+            break;
+        workers.push_back(p);
+    }
+    bool started = (int)workers.size() == ranks - 1;
+    run->go.store(started ? 1 : -1, std::memory_order_release);
+    if (started)
+        runRank(link);
+    else
+        printf("cannot start worker processes\n");
+    for (intptr_t p : workers)
+        waitProcess(p);
+
+    if (started) {
+        *result = run->result;
+        float* d = (float*)(run + 1);
+        dye->assign(d, d + (size_t)rx * ry * 4);
+    }
+    delete link;
+    return started;
+}
+
+/**
+ * @brief A run over ranks threads on a loopback transport; returns seconds per frame
+ */
+static double runLoopback(int rx, int ry, int ranks, int frames, double latencyUs, bool overlap, double* waitShare) {
+    LoopbackGroup group(ranks, decompBytes(rx, ry), latencyUs);
+    DecompRun* run = new (group.endpoint(0)->shared()) DecompRun();
+    run->rx = rx;
+    run->ry = ry;
+    run->result.frames = frames;
+    run->overlap = overlap ? 1 : 0;
+
+    std::vector<std::thread> threads;
+    for (int r = 1; r < ranks; r ++)
+        threads.emplace_back([&group, r]() { runRank(group.endpoint(r)); });
+    runRank(group.endpoint(0));
+    for (std::thread& t : threads)
+        t.join();
+
+    double wait = 0.0;
+    for (int r = 0; r < ranks; r ++)
+        wait += run->result.stats[r].waitSeconds;
+    *waitShare = wait / ranks / (run->result.seconds * frames);
+    return run->result.seconds;
+}
+
+// per rank means of a run's traffic: KB exchanged per frame, and the share of the frame spent waiting for halos
+static void decompTraffic(const DecompResult& run, int ranks, double* kb, double* waitShare) {
+    double bytes = 0.0, wait = 0.0;
+    for (int r = 0; r < ranks; r ++) {
+        bytes += (double)run.stats[r].bytes;
+        wait += run.stats[r].waitSeconds;
+    }
+    *kb = bytes / ranks / run.frames / 1024.0;
+    *waitShare = wait / ranks / (run.seconds * run.frames);
+}
+
+void benchDecomp(int res, int frames) {
+    int hw = (int)std::thread::hardware_concurrency();
+    std::vector<float> dye, ref((size_t)res * res * 4);
+    DecompResult run;
+
+    // the single process engine the slabs should reproduce
+    {
+        CpuFluid fluid(res, res);
+        for (int i = 0; i < frames + 3; i ++)
+            fluid.step(benchInput(i, res));
+        fluid.writeQuantity(ref.data());
+    }
+
+    printf("domain decomposition over shared memory, strong scaling %dx%d, %d frames, 1 thread per rank, %d hardware threads\n", res, res,
+        frames, hw);
+    printf("%6s %10s %12s %9s %11s %12s %8s %12s\n", "ranks", "rows/rank", "ms/frame", "speedup", "efficiency", "KB/frame", "wait", "max diff");
+    double base = 0.0;
+    for (int n = 1; n <= DECOMP_MAX_RANKS && res / n >= 2; n *= 2) {
+        if (!runProcesses(res, res, n, frames, &run, &dye))
+            return;
+        if (n == 1)
+            base = run.seconds;
+        double kb, wait, diff = 0.0;
+        decompTraffic(run, n, &kb, &wait);
+        for (size_t i = 0; i < ref.size(); i ++)
+            diff = std::fmax(diff, std::fabs(ref[i] - dye[i]));
+        printf("%6d %10d %12.3f %9.2f %10.0f%% %12.1f %7.1f%% %12g%s\n", n, res / n, run.seconds * 1000.0, base / run.seconds,
+            100.0 * base / run.seconds / n, kb, 100.0 * wait, diff, n > hw ? "  (oversubscribed)" : "");
+        if (n >= 2 * hw && n >= 8)
+            break;
+    }
+
+    int slab = std::max(res / 4, 2);
+    printf("weak scaling, %d x %d rows per rank\n", res, slab);
+    printf("%6s %12s %12s %11s %12s %8s\n", "ranks", "grid", "ms/frame", "efficiency", "KB/frame", "wait");
+    for (int n = 1; n <= DECOMP_MAX_RANKS; n *= 2) {
+        if (!runProcesses(res, slab * n, n, frames, &run, &dye))
+            return;
+        if (n == 1)
+            base = run.seconds;
+        double kb, wait;
+        decompTraffic(run, n, &kb, &wait);
+        char grid[32];
+        snprintf(grid, sizeof(grid), "%dx%d", res, slab * n);
+        printf("%6d %12s %12.3f %10.0f%% %12.1f %7.1f%%%s\n", n, grid, run.seconds * 1000.0, 100.0 * base / run.seconds, kb, 100.0 * wait,
+            n > hw ? "  (oversubscribed)" : "");
+        if (n >= 2 * hw && n >= 8)
+            break;
+    }
+
+    // the loopback stand-in for a transport between nodes, with and without the interior overlapping the exchanges
+    int ranks = std::max(2, std::min(4, hw));
+    printf("loopback transport, %dx%d, %d ranks as threads\n", res, res, ranks);
+    printf("%12s %14s %14s %14s %16s\n", "latency us", "overlap ms", "no overlap ms", "overlap wait", "no overlap wait");
+    for (double lat : { 0.0, 20.0, 100.0 }) {
+        double wo, wn;
+        double o = runLoopback(res, res, ranks, frames, lat, true, &wo);
+        double s = runLoopback(res, res, ranks, frames, lat, false, &wn);
+        printf("%12.0f %14.3f %14.3f %13.1f%% %15.1f%%\n", lat, o * 1000.0, s * 1000.0, 100.0 * wo, 100.0 * wn);
+    }
+}
+
+void benchOutOfCore(int res, int frames) {
+    ThreadPool pool;
+    std::error_code err;
+    std::filesystem::path dir = std::filesystem::temp_directory_path(err) / ("gg1_c38_ooc_" + std::to_string(processId()));
+    if (err || !std::filesystem::create_directories(dir, err)) {
+        printf("cannot create a directory for the planes under %s\n", dir.string().c_str());
+        return;
+    }
+    std::string path = dir.string();
+
+    printf("out of core, %dx%d, %d frames, %d threads\n", res, res, frames, pool.size());
+    double m = 0.0, o = 0.0;
+    bool same = true;
+    size_t files = 0, window = 0, base = 0;
+    int rows = 0;
+    std::atomic<size_t> peak(0);
+    {
+        CpuOptions ooc;
+        ooc.outOfCore = path.c_str();
+        ooc.outOfCoreWindow = (size_t)13 * Field<float>::bytes(res, res) / 8;
+        CpuFluid disk(res, res, &pool, ooc);
+
+        // an eighth of the files, but no less than tiles of one row take (the wavefront is built on the first frame); under about
+        // 1024 x 1024 that minimum is the larger
+        disk.setOutOfCoreWindow(std::max(ooc.outOfCoreWindow, disk.getMinWindowBytes()));
+        disk.step(benchInput(0, res));
+        files = disk.getTiles()->fileBytes();
+        window = disk.getWindowBytes();
+        rows = disk.getWaveRows();
+        base = residentBytes();
+
+        // resident set sampled while the frames run; with eviction it stays near the window, without it it would grow to the files
+        std::atomic<bool> done(false);
+        std::thread sampler([&]() {
+            while (!done.load()) {
+                size_t r = residentBytes();
+                if (r > peak.load())
+                    peak.store(r);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        o = timeFrames(disk, res, frames);
+        done.store(true);
+        sampler.join();
+
+        CpuFluid ref(res, res, &pool);
+        ref.step(benchInput(0, res));
+        m = timeFrames(ref, res, frames);
+
+        same = samePlane(ref.velU, disk.velU) && samePlane(ref.velV, disk.velV) && samePlane(ref.prs, disk.prs) && samePlane(ref.div, disk.div);
+        for (int c = 0; c < 3; c ++)
+            same = same && samePlane(ref.qnt[c], disk.qnt[c]);
+    }
+    std::filesystem::remove_all(dir, err);
+
+    printf("%12s %12s\n", "planes", "ms/frame");
+    printf("%12s %12.3f\n", "in memory", m * 1000.0);
+    printf("%12s %12.3f  (%.2fx)\n", "out of core", o * 1000.0, m / o);
+    printf("files %.1f MB, window %.1f MB in tiles of %d rows, resident while stepping %.1f MB over the %.1f MB before\n", files / 1048576.0, window / 1048576.0, rows,
+        peak.load() > base ? (peak.load() - base) / 1048576.0 : 0.0, base / 1048576.0);
+    printf("identical: %s\n", same ? "yes" : "NO");
+}
+
+/**
+ * @brief Microseconds per instance frame of an ensemble of lanes instances at res x res and of separate CpuFluids, whether instance 0 of
+ * the ensemble matches a CpuFluid bit for bit, and the largest dye difference between instances
+ */
+static void timeEnsemble(int res, int lanes, int frames, double* usSeparate, double* usEnsemble, bool* same, double* spread) {
+    EnsembleFluid ens(res, res, lanes);
+    int K = ens.lanes();
+
+    // instance 0 keeps the defaults and the benchmark's input; the others spread around them
+    for (int k = 1; k < K; k ++) {
+        ens.members[k].viscosity = CPU_VISCOSITY * (0.5f + 1.5f * k / K);
+        ens.members[k].forceMult = CPU_FORCEMULT * (0.25f + 1.5f * (float)((k * 7) % K) / K);
+    }
+    std::vector<FluidInput> in(K);
+    auto inputs = [&](int i) {
+        for (int k = 0; k < K; k ++) {
+            in[k] = benchInput(i, res);
+            if (k == 0)
+                continue;
+            in[k].mx += res * (float)((k * 5) % 17 - 8) / 64.0f;
+            in[k].my += res * (float)((k * 3) % 13 - 6) / 64.0f;
+            in[k].rely *= 1.0f - 2.0f * (k % 2);
+            in[k].mDown = k % 5 != 4 || i % 8 < 4;
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i ++) {
+        inputs(i);
+        ens.step(in.data());
+    }
+    std::chrono::duration<double> e = std::chrono::steady_clock::now() - t0;
+
+    // the same instances as separate engines; timed on a few of them
+    const int separate = 4;
+    std::vector<CpuFluid*> fluids;
+    for (int k = 0; k < separate; k ++)
+        fluids.push_back(new CpuFluid(res, res));
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; i ++) {
+        inputs(i);
+        for (int k = 0; k < separate; k ++)
+            fluids[k]->step(in[k]);
+    }
+    std::chrono::duration<double> s = std::chrono::steady_clock::now() - t0;
+
+    *same = true;
+    auto compare = [&](const Field<float>& a, const Field<float>& b) {
+        for (int y = 0; y < res; y ++) {
+            for (int x = 0; x < res; x ++) {
+                float v = ens.at(a, 0, x, y);
+                *same = *same && memcmp(&v, &b.at(x, y), sizeof(float)) == 0;
+            }
+        }
+    };
+    compare(ens.velU, fluids[0]->velU);
+    compare(ens.velV, fluids[0]->velV);
+    compare(ens.prs, fluids[0]->prs);
+    compare(ens.div, fluids[0]->div);
+    for (int c = 0; c < 3; c ++)
+        compare(ens.qnt[c], fluids[0]->qnt[c]);
+
+    *spread = 0.0;
+    for (int k = 1; k < K; k ++)
+        for (int y = 0; y < res; y ++)
+            for (int x = 0; x < res; x ++)
+                *spread = std::fmax(*spread, std::fabs(ens.at(ens.qnt[0], k, x, y) - ens.at(ens.qnt[0], 0, x, y)));
+    for (CpuFluid* f : fluids)
+        delete f;
+
+    *usEnsemble = e.count() / frames / K * 1e6;
+    *usSeparate = s.count() / frames / separate * 1e6;
+}
+
+void benchEnsemble(int maxRes, int lanes, int frames) {
+    // widths that are and are not multiples of a register, where separate engines run scalar tails
+    std::vector<int> sizes;
+    for (int res : { 16, 24, 32, 40, 48, 64, 96, 128, 256 })
+        if (res <= maxRes)
+            sizes.push_back(res);
+    if (sizes.empty() || sizes.back() != maxRes)
+        sizes.push_back(maxRes);
+
+    std::vector<std::vector<double>> rows;
+    for (int res : sizes) {
+        double sep, ens, spread;
+        bool same;
+        timeEnsemble(res, lanes, frames, &sep, &ens, &same, &spread);
+        rows.push_back({ (double)res, sep, ens, spread, same ? 1.0 : 0.0 });
+    }
+
+    printf("ensemble of %d instances against separate engines, %d frames, 1 thread\n", lanes, frames);
+    printf("%8s %18s %18s %9s %12s %10s\n", "res", "separate us/inst", "ensemble us/inst", "speedup", "dye spread", "identical");
+    for (const std::vector<double>& r : rows)
+        printf("%8d %18.1f %18.1f %8.2fx %12.4f %10s\n", (int)r[0], r[1], r[2], r[1] / r[2], r[3], r[4] != 0.0 ? "yes" : "NO");
+}
+
+void benchLattice(int maxRes, int frames) {
+    std::vector<int> sizes;
+    for (int res = 256; res < maxRes; res *= 2)
+        sizes.push_back(res);
+    sizes.push_back(maxRes);
+
+    ThreadPool pool;
+    std::vector<std::vector<double>> rows;
+    for (int res : sizes) {
+        CpuFluid proj(res, res, &pool);
+        LbmFluid lbm(res, res, &pool);
+        for (int i = 0; i < 2; i ++) {
+            proj.step(benchInput(i, res));
+            lbm.step(benchInput(i, res));
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i ++)
+            proj.step(benchInput(i + 2, res));
+        std::chrono::duration<double> p = std::chrono::steady_clock::now() - t0;
+        t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i ++)
+            lbm.step(benchInput(i + 2, res));
+        std::chrono::duration<double> l = std::chrono::steady_clock::now() - t0;
+
+        std::vector<float> dye((size_t)res * res * 4);
+        lbm.writeQuantity(dye.data());
+        bool finite = true;
+        for (float d : dye)
+            finite = finite && std::isfinite(d);
+
+        rows.push_back({ (double)res, p.count() / frames, l.count() / frames, lbm.latticeSpeed(), finite ? 1.0 : 0.0 });
+    }
+
+    // a frame of the projection method is 20 + 20 diffusion and 40 pressure sweeps besides its 4 other passes; of the lattice, substeps
+    // collide and stream sweeps
+    printf("projection method against lattice Boltzmann (D2Q9, %d steps per frame), %d frames, %d threads\n", CPU_LBM_SUBSTEPS, frames, pool.size());
+    printf("%8s %16s %16s %9s %14s %14s %8s\n", "res", "projection ms", "lattice ms", "speedup", "lattice MLUPS", "lattice speed", "finite");
+    for (const std::vector<double>& r : rows)
+        printf("%8d %16.3f %16.3f %8.2fx %14.1f %14.4f %8s\n", (int)r[0], r[1] * 1000.0, r[2] * 1000.0, r[1] / r[2],
+            r[0] * r[0] * CPU_LBM_SUBSTEPS / r[2] / 1e6, r[3], r[4] != 0.0 ? "yes" : "NO");
+}
@@ -0,0 +1,76 @@
+/**
+ * @file bench.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Headless benchmarks of the CPU engine, run from the command line instead of opening a window
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_BENCH_H
+#define CPU_BENCH_H
+
+// frames of the full solver at res x res with 1, 2, 4, ... 64 threads; prints ms per frame, speedup, efficiency and steals
+void benchThreads(int res, int frames);
+
+// 40 pressure iterations at res x res with temporal blocking depths 1 (plain) to 16; prints time, estimated traffic and checks the results are identical
+void benchJacobi(int res, int reps);
+
+// single threaded jacobi and divergence sweeps with the generic and the size specialized kernels at every STENCIL_SIZES width
+void benchSizes(int reps);
+
+// frames of the full solver at res x res with the fused passes on and off; prints ms per frame and checks the results are identical
+void benchFused(int res, int frames);
+
+// frames of the full solver at res x res with each pass ending at a barrier and as a task graph (CpuOptions::graph); prints ms per frame,
+// checks the results are identical and lists the graph's nodes
+void benchGraph(int res, int frames);
+
+// frames of the full solver at res x res on every executor backend compiled in (executor.h), and a parallelReduce over the velocity;
+// prints ms per frame and per reduction, and checks every backend's dye matches the serial one
+void benchExecutors(int res, int frames);
+
+// reductions over a res x res velocity on 1 to 64 threads: an atomic accumulator and per thread partials against Executor::parallelReduce's
+// fixed trees, plain and compensated; prints ms and whether each gives the same bits on every thread count, then the engine's own
+// reductions (CpuFluid::kineticEnergy, maxSpeed, pressureResidual) on every thread count
+void benchReduce(int res, int reps);
+
+// frames of the full solver at res x res with float and half storage; prints ms per frame and how far the half dye is from the float one
+void benchHalf(int res, int frames);
+
+// frames of each engine mode at res x res; prints ms per frame, the frame arena's size and its spills to the heap during warm up and
+// after, which should be none
+void benchArena(int res, int frames);
+
+// the full grid and sparse (active block) engines through three phases of frames at res x res: a click that only splats dye, a drag,
+// and the settling after release; prints ms per frame, the share of active blocks and how far the sparse dye is from the full grid one
+void benchSparse(int res, int frames);
+
+// single threaded jacobi, divergence, gradient and advection sweeps on row major, tiled and Morton planes (layout.h) at 512 to maxRes;
+// prints ms per pass per layout, the row major vector kernels for reference, and checks every layout gives the same results
+void benchLayouts(int maxRes, int reps);
+
+// the engine split into slabs of rows over 1, 2, 4, ... worker processes exchanging halos through shared memory (slabFluid.h): strong
+// scaling at res x res and weak scaling at res / 4 rows per rank, with ms per frame, halo traffic, the share of the frame spent waiting
+// for halos and how far the dye is from the single process engine's; then ranks as threads on the loopback transport with a simulated
+// latency, with and without the exchanges overlapping the interior rows
+void benchDecomp(int res, int frames);
+
+// frames of the full solver at res x res in memory and out of core (CpuOptions::outOfCore) in a temporary directory, with a wavefront
+// window of an eighth of the planes; prints ms per frame, the files' and the window's size, the most the process had resident while
+// stepping out of core, and checks the results are identical
+void benchOutOfCore(int res, int frames);
+
+// an ensemble of lanes instances (ensembleFluid.h) with spread viscosities, force multipliers and mouse paths, against separate single
+// threaded CpuFluids, at 16 x 16 up to maxRes x maxRes; prints microseconds per instance frame, how far apart the instances ended up, and
+// checks the instance with the default constants and input matches a CpuFluid bit for bit
+void benchEnsemble(int maxRes, int lanes, int frames);
+
+// frames of the projection engine (CpuFluid) and the lattice Boltzmann one (lbmFluid.h) at 256 x 256 up to maxRes x maxRes on all
+// hardware threads; prints ms per frame of each, the lattice's million texel updates per second and its largest speed in cells per step,
+// and checks its dye stayed finite
+void benchLattice(int maxRes, int frames);
+
+// rank of a benchDecomp run, in a worker process started by it with --decomp-worker segment rank; returns the exit code
+int runDecompWorker(const char* segment, int rank);
+
+#endif
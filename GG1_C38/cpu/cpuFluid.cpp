@@ -0,0 +1,1072 @@
+/**
+ * @file cpuFluid.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief CPU engine running the same six passes as GG1_C38_Handler::objRendererHandler on Field planes
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "cpuFluid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/**
+ * @brief Second half of advStep.fs on columns [x0, x1) of row y of the three dye channels r of an rx by ry grid; adds the colored splat
+ * under the mouse and decays
+ */
+void splatTexels(const FluidInput& in, int rx, int ry, float* const* r, int y, int x0, int x1, int pitch) {
+    float frm = (float)in.frame;
+    float ox = in.mx / rx, oy = in.my / ry;
+
+    // the splat's tint only depends on the frame
+    float tint[3] = { 0.0f, 0.0f, 0.0f };
+    if (in.mDown) {
+        tint[0] = std::cos(frm / 200);
+        tint[1] = std::sin(frm / 100);
+        tint[2] = std::sin(frm / 300);
+    }
+
+    for (int x = x0; x < x1; x ++) {
+        float f[3] = { 0.0f, 0.0f, 0.0f };
+        if (in.mDown) {
+            float dx = (x + 0.5f) / rx - ox, dy = (y + 0.5f) / ry - oy;
+            float dist = std::sqrt(dx * dx + dy * dy);
+            if (dist < 0.15f) {
+                float val = (0.12f / (dist + 0.12f)) - 0.5f;
+                for (int c = 0; c < 3; c ++)
+                    f[c] = std::fabs(val * tint[c]) * 0.7f;
+            }
+        }
+        for (int c = 0; c < 3; c ++)
+            r[c][x * pitch] = (r[c][x * pitch] + f[c]) * 0.995f;
+    }
+}
+
+/**
+ * @brief frcStep.fs on columns [x0, x1) of row y of the velocity u, v of an rx by ry grid
+ */
+void forceTexels(const FluidInput& in, int rx, int ry, float* u, float* v, int y, int x0, int x1, int pitch, float forceMult) {
+    float fx = in.relx / rx * forceMult, fy = in.rely / ry * forceMult;
+    float ox = in.mx / rx, oy = in.my / ry;
+    for (int x = x0; x < x1; x ++) {
+        float dx = (x + 0.5f) / rx - ox, dy = (y + 0.5f) / ry - oy;
+        float dist = std::sqrt(dx * dx + dy * dy);
+        u[x * pitch] += fx / dist;
+        v[x * pitch] += fy / dist;
+    }
+}
+
+/**
+ * @brief Construct a new CpuFluid object, selecting and validating the stencil kernels for this machine
+ *
+ * @param rx X resolution of the fields
+ * @param ry Y resolution of the fields
+ * @param pool Executor the passes are split over (executor.h); NULL runs single threaded
+ * @param opts Tuning options
+ */
+CpuFluid::CpuFluid(int rx, int ry, Executor* pool, CpuOptions opts) : rx(rx), ry(ry), pool(pool), opts(opts) {
+    delx = 1.0f / rx;
+    aspect = (float)rx / (float)ry;
+    in = FluidInput();
+
+    grid.rx = halfGrid.rx = rx;
+    grid.ry = halfGrid.ry = ry;
+    grid.stride = fieldStride(rx, 1, sizeof(float));
+    halfGrid.stride = fieldStride(rx, 1, sizeof(Half));
+
+    // tiles of rows whose inputs and output (up to 4 planes, plus the rows above and below) fit in a slice of L2
+    tileRows = (int)(64 * 1024 / (grid.stride * sizeof(float) * 4));
+    if (tileRows < 2)
+        tileRows = 2;
+
+    solver = NULL;
+    store = NULL;
+    graph = NULL;
+    graphDif = graphPrs = -1;
+    difAlpha = difRbeta = 0.0f;
+    kernels = NULL;
+    windowKernels = NULL;
+    halfKernels = NULL;
+    present = NULL;
+    tiles = NULL;
+    wave = NULL;
+    waveDif = wavePrs = -1;
+    waveRows = 0;
+    waveSwapVel = waveSwapPrs = false;
+    int threads = pool != NULL ? pool->size() : 1;
+
+    // the frame's scratch: the divergence plane from the calling thread's sub-arena, and on every thread the Jacobi solver's bands and
+    // the rows of the tile it is running; sized up front so that no frame spills
+    arena = new FrameArena(threads, 0, pool);
+
+    const char* qntNames[3] = { "qnt.r", "qnt.g", "qnt.b" };
+    const char* nxtQntNames[3] = { "nxtQnt.r", "nxtQnt.g", "nxtQnt.b" };
+
+    // out of core, every plane is a file, div included, and the frame is a wavefront of plain sweeps whose ghost rows are the files' zeros
+    if (opts.outOfCore != NULL) {
+        this->opts.border = Border::Zero;
+        tiles = new TileStore(opts.outOfCore);
+        velU = tiles->make<float>("velU", rx, ry); velV = tiles->make<float>("velV", rx, ry);
+        nxtU = tiles->make<float>("nxtU", rx, ry); nxtV = tiles->make<float>("nxtV", rx, ry);
+        prs = tiles->make<float>("prs", rx, ry); nxtPrs = tiles->make<float>("nxtPrs", rx, ry);
+        div = tiles->make<float>("div", rx, ry);
+        for (int c = 0; c < 3; c ++) {
+            qnt[c] = tiles->make<float>(qntNames[c], rx, ry);
+            nxtQnt[c] = tiles->make<float>(nxtQntNames[c], rx, ry);
+        }
+        tiles->report(std::cout);
+        for (int i = 0; i < threads; i ++)
+            arena->reserve(i, FrameArena::rounded(Field<float>::bytes(rx, 4)));
+
+        kernels = &selectKernels(rx, velU.stride);
+        std::cout << "CPU stencils: max deviation from scalar reference " << validateKernels(*kernels) << "\n";
+        return;
+    }
+
+    // the planes, each row first touched by the pool thread whose tiles sweep it (fieldStore.h)
+    store = new FieldStore(pool, opts.hugePages);
+
+    if (opts.half) {
+        hVelU = store->make<Half>("velU", rx, ry); hVelV = store->make<Half>("velV", rx, ry);
+        hNxtU = store->make<Half>("nxtU", rx, ry); hNxtV = store->make<Half>("nxtV", rx, ry);
+        hPrs = store->make<Half>("prs", rx, ry); hNxtPrs = store->make<Half>("nxtPrs", rx, ry);
+        for (int c = 0; c < 3; c ++) {
+            hQnt[c] = store->make<Half>(qntNames[c], rx, ry);
+            hNxtQnt[c] = store->make<Half>(nxtQntNames[c], rx, ry);
+        }
+        store->report(std::cout);
+        for (int i = 0; i < threads; i ++)
+            arena->reserve(i, FrameArena::rounded(Field<float>::bytes(rx, 5)) + (i == 0 ? FrameArena::rounded(Field<Half>::bytes(rx, ry)) : 0));
+
+        halfKernels = &selectHalfKernels();
+        std::cout << "CPU half stencils: max deviation from scalar reference " << validateHalfKernels(*halfKernels) << "\n";
+        return;
+    }
+
+    velU = store->make<float>("velU", rx, ry); velV = store->make<float>("velV", rx, ry);
+    nxtU = store->make<float>("nxtU", rx, ry); nxtV = store->make<float>("nxtV", rx, ry);
+    prs = store->make<float>("prs", rx, ry); nxtPrs = store->make<float>("nxtPrs", rx, ry);
+    for (int c = 0; c < 3; c ++) {
+        qnt[c] = store->make<float>(qntNames[c], rx, ry);
+        nxtQnt[c] = store->make<float>(nxtQntNames[c], rx, ry);
+    }
+    // the graph only pays off with threads to overlap passes on; its ordering of the fused passes assumes Border::Zero like theirs
+    if (opts.graph && opts.fused && opts.border == Border::Zero && threads > 1) {
+        wU = store->make<float>("wU", rx, ry); wV = store->make<float>("wV", rx, ry);
+        graph = new TaskGraph();
+    }
+    store->report(std::cout);
+
+    solver = new BlockedJacobi(rx, ry, opts.blockDepth, pool, arena);
+
+    for (int i = 0; i < threads; i ++)
+        arena->reserve(i, solver->scratchBytes() + FrameArena::rounded(Field<float>::bytes(rx, 4)) + (i == 0 ? FrameArena::rounded(Field<float>::bytes(rx, ry)) : 0));
+
+    kernels = &selectKernels(rx, velU.stride);
+    std::cout << "CPU stencils: max deviation from scalar reference " << validateKernels(*kernels) << "\n";
+
+    // sparse passes run the fixed stencils on windows of columns, which the kernels specialized for the full width cannot, so they use
+    // the generic table; the dense passes keep the specialized one
+    if (opts.sparse) {
+        activity = ActiveBlocks(rx, ry);
+        moving = ActiveBlocks(rx, ry);
+        lastActivity = ActiveBlocks(rx, ry);
+        windowKernels = &selectKernels();
+        if (windowKernels != kernels)
+            std::cout << "CPU stencils: max deviation from scalar reference " << validateKernels(*windowKernels) << "\n";
+    }
+}
+
+CpuFluid::~CpuFluid() {
+    delete wave;
+    delete graph;
+    delete solver;
+    delete arena;
+    delete store;
+    delete tiles;
+}
+
+void CpuFluid::forRows(FnRef<void(int, int)> f) {
+    if (pool != NULL)
+        pool->parallelFor(ry, tileRows, f);
+    else
+        f(0, ry);
+}
+
+double CpuFluid::reduceRows(FnRef<double(int, int)> f, Combine combine) {
+    Executor* e = pool != NULL ? pool : &serial;
+    return e->parallelReduce(ry, tileRows, f, combine);
+}
+
+const float* CpuFluid::floatRow(const Field<float>& f, const Field<Half>& h, int y, float* tmp) {
+    if (!opts.half)
+        return f.row(y);
+    halfKernels->fromHalf(tmp - 1, h.row(y) - 1, rx + 2);
+    return tmp;
+}
+
+double CpuFluid::kineticEnergy() {
+    double sum = reduceRows([&](int y0, int y1) {
+        int t = Executor::currentThread();
+        ArenaScope scope(*arena, t);
+        Field<float> tmp = arena->field<float>(t, rx, 2);
+        NeumaierSum s;
+        for (int y = y0; y < y1; y ++) {
+            const float* u = floatRow(velU, hVelU, y, tmp.row(0));
+            const float* v = floatRow(velV, hVelV, y, tmp.row(1));
+            for (int x = 0; x < rx; x ++)
+                s.add((double)u[x] * u[x] + (double)v[x] * v[x]);
+        }
+        return s.value();
+    }, Combine::CompensatedSum);
+    return 0.5 * sum / ((double)rx * ry);
+}
+
+double CpuFluid::maxSpeed() {
+    double m2 = reduceRows([&](int y0, int y1) {
+        int t = Executor::currentThread();
+        ArenaScope scope(*arena, t);
+        Field<float> tmp = arena->field<float>(t, rx, 2);
+        double m = 0.0;
+        for (int y = y0; y < y1; y ++) {
+            const float* u = floatRow(velU, hVelU, y, tmp.row(0));
+            const float* v = floatRow(velV, hVelV, y, tmp.row(1));
+            for (int x = 0; x < rx; x ++) {
+                double s = (double)u[x] * u[x] + (double)v[x] * v[x];
+                m = s > m ? s : m;
+            }
+        }
+        return m;
+    }, Combine::Max);
+    return std::sqrt(m2);
+}
+
+/**
+ * @brief The residual of prsStep.fs's fixed point, xL + xR + xB + xT + alpha * div - 4 * prs with alpha = -delx^2, reading outside the
+ * grid what the solve read
+ */
+double CpuFluid::pressureResidual() {
+    // no frame yet, so no divergence
+    if ((opts.half ? (const void*)hDiv.data() : (const void*)div.data()) == NULL)
+        return 0.0;
+
+    float alpha = -(delx * delx);
+    if (opts.half)
+        hPrs.fillHalo(opts.border);
+    else
+        prs.fillHalo(opts.border);
+
+    double sum = reduceRows([&](int y0, int y1) {
+        int t = Executor::currentThread();
+        ArenaScope scope(*arena, t);
+        Field<float> tmp = arena->field<float>(t, rx, 4);
+        NeumaierSum s;
+        for (int y = y0; y < y1; y ++) {
+            const float* pb = floatRow(prs, hPrs, y - 1, tmp.row(0));
+            const float* pc = floatRow(prs, hPrs, y, tmp.row(1));
+            const float* pt = floatRow(prs, hPrs, y + 1, tmp.row(2));
+            const float* b = floatRow(div, hDiv, y, tmp.row(3));
+            for (int x = 0; x < rx; x ++) {
+                double r = (double)pc[x - 1] + pc[x + 1] + pb[x] + pt[x] + (double)alpha * b[x] - 4.0 * pc[x];
+                s.add(r * r);
+            }
+        }
+        return s.value();
+    }, Combine::CompensatedSum);
+    return std::sqrt(sum / ((double)rx * ry));
+}
+
+void CpuFluid::step(const FluidInput& input) {
+    in = input;
+
+    // the last frame's scratch is dropped here rather than at its end, so div stays readable between frames
+    arena->reset();
+
+    if (opts.half) {
+        hDiv = arena->field<Half>(0, rx, ry);
+        stepHalf();
+        return;
+    }
+    if (tiles != NULL) {
+        stepOutOfCore();
+        return;
+    }
+    div = arena->field<float>(0, rx, ry);
+    if (opts.sparse)
+        stepSparse();
+    else
+        stepDense();
+}
+
+void CpuFluid::stepDense() {
+    if (graph != NULL) {
+        stepGraph();
+        return;
+    }
+
+    // the fused diffusion reads rows outside the grid from ghost rows it cannot refresh mid pass, which only holds for Border::Zero
+    if (opts.fused && opts.border == Border::Zero) {
+        advectForceStep();
+        diffuseDivergenceStep();
+    } else if (opts.fused) {
+        advectForceStep();
+        diffusionStep();
+        divergenceStep();
+    } else {
+        advectionStep();
+        forceStep();
+        diffusionStep();
+        divergenceStep();
+    }
+    pressureStep();
+    gradientStep();
+}
+
+/**
+ * @brief Second half of advStep.fs on rows [y0, y1) of the advected dye; adds the colored splat under the mouse and decays
+ */
+void CpuFluid::splatRows(int y0, int y1) {
+    for (int y = y0; y < y1; y ++) {
+        float* r[3] = { nxtQnt[0].row(y), nxtQnt[1].row(y), nxtQnt[2].row(y) };
+        splatRow(r, y, 0, rx);
+    }
+}
+
+/**
+ * @brief splatRows on columns [x0, x1) of row y of the three dye channels r
+ */
+void CpuFluid::splatRow(float* const* r, int y, int x0, int x1) {
+    splatTexels(in, rx, ry, r, y, x0, x1);
+}
+
+/**
+ * @brief frcStep.fs on rows [y0, y1); adds the mouse drag force, falling off with distance from the cursor
+ */
+void CpuFluid::forceRows(int y0, int y1) {
+    if (!in.mDown)
+        return;
+    for (int y = y0; y < y1; y ++)
+        forceRow(velU.row(y), velV.row(y), y, 0, rx);
+}
+
+/**
+ * @brief forceRows on columns [x0, x1) of row y of the velocity, u and v
+ */
+void CpuFluid::forceRow(float* u, float* v, int y, int x0, int x1) {
+    forceTexels(in, rx, ry, u, v, y, x0, x1);
+}
+
+/**
+ * @brief advStep.fs; advects dye through the velocity field, adds the colored splat under the mouse and decays
+ */
+void CpuFluid::advectionStep() {
+    // advect() backtraces by dt * (res.x / res.y) * vel in uv units; the kernels work in texels
+    float kx = in.dt * aspect * rx;
+    float ky = in.dt * aspect * ry;
+    const float* q[3] = { qnt[0].data(), qnt[1].data(), qnt[2].data() };
+    float* out[3] = { nxtQnt[0].data(), nxtQnt[1].data(), nxtQnt[2].data() };
+
+    forRows([&](int y0, int y1) {
+        kernels->advect(out, q, 3, velU.data(), velV.data(), grid, y0, y1, 0, rx, kx, ky);
+        splatRows(y0, y1);
+    });
+
+    for (int c = 0; c < 3; c ++)
+        qnt[c].swap(nxtQnt[c]);
+}
+
+/**
+ * @brief frcStep.fs
+ */
+void CpuFluid::forceStep() {
+    if (!in.mDown)
+        return;
+    forRows([&](int y0, int y1) {
+        forceRows(y0, y1);
+    });
+}
+
+/**
+ * @brief advectionStep and forceStep in one sweep. The advection of a texel only reads the velocity of that same texel, so each tile
+ * can apply the force to its rows right after advecting them, while they are still in cache
+ */
+void CpuFluid::advectForceStep() {
+    float kx = in.dt * aspect * rx;
+    float ky = in.dt * aspect * ry;
+    const float* q[3] = { qnt[0].data(), qnt[1].data(), qnt[2].data() };
+    float* out[3] = { nxtQnt[0].data(), nxtQnt[1].data(), nxtQnt[2].data() };
+
+    forRows([&](int y0, int y1) {
+        kernels->advect(out, q, 3, velU.data(), velV.data(), grid, y0, y1, 0, rx, kx, ky);
+        splatRows(y0, y1);
+        forceRows(y0, y1);
+    });
+
+    for (int c = 0; c < 3; c ++)
+        qnt[c].swap(nxtQnt[c]);
+}
+
+/**
+ * @brief difStep.fs iterated difIters times; note that like the shader, b is the current iterate rather than the initial velocity
+ */
+void CpuFluid::diffusionStep() {
+    float alpha = delx * delx / (CPU_VISCOSITY * in.dt);
+    float rbeta = 1 / (4 + alpha);
+    solver->solve(*kernels, velU, nxtU, NULL, grid, difIters, alpha, rbeta, opts.border);
+    solver->solve(*kernels, velV, nxtV, NULL, grid, difIters, alpha, rbeta, opts.border);
+}
+
+/**
+ * @brief The last diffusion iteration and divStep.fs in one sweep. Each tile produces its rows of the diffused velocity bottom to top and
+ * takes the divergence of a row as soon as the row above it exists, from a window of three v rows (below, center, above). The v rows
+ * just outside the tile are computed into per thread halo rows rather than read from the neighboring tile, which may not have produced
+ * them yet; they get the same inputs, so the result matches the separate passes bit for bit
+ */
+void CpuFluid::diffuseDivergenceStep() {
+    if (difIters < 1) {
+        divergenceStep();
+        return;
+    }
+
+    difAlpha = delx * delx / (CPU_VISCOSITY * in.dt);
+    difRbeta = 1 / (4 + difAlpha);
+    solver->solve(*kernels, velU, nxtU, NULL, grid, difIters - 1, difAlpha, difRbeta);
+    solver->solve(*kernels, velV, nxtV, NULL, grid, difIters - 1, difAlpha, difRbeta);
+
+    // inputs of the last iteration, and the ghost rows of the output that stand in for v below and above the grid
+    velU.fillHalo(Border::Zero);
+    velV.fillHalo(Border::Zero);
+    nxtV.fillHalo(Border::Zero);
+
+    forRows([&](int y0, int y1) {
+        diffuseDivergenceRows(velU, velV, nxtU, nxtV, y0, y1);
+    });
+
+    velU.swap(nxtU);
+    velV.swap(nxtV);
+}
+
+/**
+ * @brief Rows [y0, y1) of diffuseDivergenceStep: the iteration of (u, v) into (outU, outV) with difAlpha and difRbeta, and the
+ * divergence of the result into div. The ghost cells of u, v and outV must hold 0
+ */
+void CpuFluid::diffuseDivergenceRows(const Field<float>& u, const Field<float>& v, Field<float>& outU, Field<float>& outV, int y0, int y1) {
+    float alpha = difAlpha, rbeta = difRbeta;
+    float scale = aspect * 0.5f;
+    int t = pool != NULL ? Executor::currentThread() : 0;
+    ArenaScope scope(*arena, t);
+    Field<float> halo = arena->field<float>(t, rx, 2);
+
+    // the final iteration of v at row y, into the output field inside the tile and into the halo rows outside it
+    auto diffuseV = [&](int y, float* dst) {
+        kernels->jacobiRow(dst, v.row(y), v.row(y - 1), v.row(y + 1), v.row(y), rx, alpha, rbeta);
+        return (const float*)dst;
+    };
+
+    const float* vb = y0 > 0 ? diffuseV(y0 - 1, halo.row(0)) : outV.row(-1);
+    const float* vc = diffuseV(y0, outV.row(y0));
+    for (int y = y0; y < y1; y ++) {
+        const float* vt = outV.row(ry);
+        if (y + 1 < y1)
+            vt = diffuseV(y + 1, outV.row(y + 1));
+        else if (y + 1 < ry)
+            vt = diffuseV(y + 1, halo.row(1));
+
+        kernels->jacobiRow(outU.row(y), u.row(y), u.row(y - 1), u.row(y + 1), u.row(y), rx, alpha, rbeta);
+        kernels->divergenceRow(div.row(y), outU.row(y), vb, vt, rx, scale);
+        vb = vc;
+        vc = vt;
+    }
+}
+
+/**
+ * @brief divStep.fs
+ */
+void CpuFluid::divergenceStep() {
+    velU.fillHalo(opts.border);
+    velV.fillHalo(opts.border);
+    forRows([&](int y0, int y1) {
+        kernels->divergence(div.data(), velU.data(), velV.data(), grid, y0, y1, aspect * 0.5f);
+    });
+}
+
+/**
+ * @brief prsStep.fs iterated prsIters times, warm started from the previous frame's pressure like the GPU path
+ */
+void CpuFluid::pressureStep() {
+    float alpha = -(delx * delx);
+    float rbeta = 0.25f;
+    solver->solve(*kernels, prs, nxtPrs, &div, grid, prsIters, alpha, rbeta, opts.border);
+}
+
+/**
+ * @brief grdStep.fs; subtracts the pressure gradient from the velocity
+ */
+void CpuFluid::gradientStep() {
+    prs.fillHalo(opts.border);
+    forRows([&](int y0, int y1) {
+        kernels->gradient(nxtU.data(), nxtV.data(), velU.data(), velV.data(), prs.data(), grid, y0, y1, aspect * 0.5f);
+    });
+    velU.swap(nxtU);
+    velV.swap(nxtV);
+}
+
+/**
+ * @brief stepDense as one run of the frame's task graph. Each pass becomes a node over row tiles (the Jacobi ones a node per band of
+ * depth iterations, tiles of a band each), ordered by the planes it reads and writes rather than by barriers: the dye advection waits
+ * for nothing and fills in around the velocity chain, and the u and v diffusions run side by side up to the divergence
+ */
+void CpuFluid::stepGraph() {
+    if (graphDif != difIters || graphPrs != prsIters)
+        buildGraph();
+
+    difAlpha = delx * delx / (CPU_VISCOSITY * in.dt);
+    difRbeta = 1 / (4 + difAlpha);
+    solver->bindScratch();
+    graph->run(pool);
+
+    // the nodes name fixed planes; put the frame's results back where the next frame (and the readers of the engine) expect them
+    for (int c = 0; c < 3; c ++)
+        qnt[c].swap(nxtQnt[c]);
+    int d = solver->getDepth();
+    if ((prsIters + d - 1) / d % 2 == 1)
+        prs.swap(nxtPrs);
+}
+
+/**
+ * @brief The nodes of stepGraph, in the order stepDense runs them. The force goes out of place into (wU, wV), which the diffusion then
+ * ping-pongs with (nxtU, nxtV), so that nothing but the gradient writes (velU, velV) and the advection, which reads them, has no
+ * predecessor; the gradient writes the frame's final velocity straight back into them
+ */
+void CpuFluid::buildGraph() {
+    delete graph;
+    graph = new TaskGraph();
+    graphDif = difIters;
+    graphPrs = prsIters;
+
+    int d = solver->getDepth();
+    int bandRows = solver->getBandRows();
+
+    graph->add("advect", ry, tileRows, [this](int y0, int y1) {
+        float kx = in.dt * aspect * rx;
+        float ky = in.dt * aspect * ry;
+        const float* q[3] = { qnt[0].data(), qnt[1].data(), qnt[2].data() };
+        float* out[3] = { nxtQnt[0].data(), nxtQnt[1].data(), nxtQnt[2].data() };
+        kernels->advect(out, q, 3, velU.data(), velV.data(), grid, y0, y1, 0, rx, kx, ky);
+        splatRows(y0, y1);
+    }, { &qnt[0], &qnt[1], &qnt[2], &velU, &velV }, { &nxtQnt[0], &nxtQnt[1], &nxtQnt[2] });
+
+    graph->add("force", ry, tileRows, [this](int y0, int y1) {
+        for (int y = y0; y < y1; y ++) {
+            std::copy(velU.row(y), velU.row(y) + rx, wU.row(y));
+            std::copy(velV.row(y), velV.row(y) + rx, wV.row(y));
+            if (in.mDown)
+                forceRow(wU.row(y), wV.row(y), y, 0, rx);
+        }
+    }, { &velU, &velV }, { &wU, &wV });
+
+    // n blocked Jacobi iterations of x into out, as one node; b NULL is the diffusion, otherwise the pressure
+    auto sweep = [&](const char* name, Field<float>* x, Field<float>* out, const Field<float>* b, int n) {
+        auto body = [this, x, out, b, n](int y0, int y1) {
+            if (b == NULL)
+                solver->band(*kernels, *x, *out, NULL, grid, y0, y1, n, difAlpha, difRbeta);
+            else
+                solver->band(*kernels, *x, *out, b, grid, y0, y1, n, -(delx * delx), 0.25f);
+        };
+        auto halo = [x]() {
+            x->fillHalo(Border::Zero);
+        };
+        if (b == NULL)
+            graph->add(name, ry, bandRows, body, { x }, { out }, halo);
+        else
+            graph->add(name, ry, bandRows, body, { x, b }, { out }, halo);
+    };
+
+    // difIters - 1 iterations of each component on its own, then the last one fused with the divergence
+    Field<float>* cur[2] = { &wU, &wV };
+    Field<float>* oth[2] = { &nxtU, &nxtV };
+    const char* names[2] = { "diffuse u", "diffuse v" };
+    for (int c = 0; c < 2; c ++) {
+        for (int done = 0; done < difIters - 1; done += d) {
+            sweep(names[c], cur[c], oth[c], NULL, std::min(d, difIters - 1 - done));
+            std::swap(cur[c], oth[c]);
+        }
+    }
+
+    Field<float>* u = cur[0];
+    Field<float>* v = cur[1];
+    if (difIters >= 1) {
+        Field<float>* ou = oth[0];
+        Field<float>* ov = oth[1];
+        graph->add("diffuse + divergence", ry, tileRows, [this, u, v, ou, ov](int y0, int y1) {
+            diffuseDivergenceRows(*u, *v, *ou, *ov, y0, y1);
+        }, { u, v }, { ou, ov, &div }, [u, v, ov]() {
+            u->fillHalo(Border::Zero);
+            v->fillHalo(Border::Zero);
+            ov->fillHalo(Border::Zero);
+        });
+        u = ou;
+        v = ov;
+    } else {
+        graph->add("divergence", ry, tileRows, [this, u, v](int y0, int y1) {
+            kernels->divergence(div.data(), u->data(), v->data(), grid, y0, y1, aspect * 0.5f);
+        }, { u, v }, { &div }, [u, v]() {
+            u->fillHalo(Border::Zero);
+            v->fillHalo(Border::Zero);
+        });
+    }
+
+    Field<float>* p = &prs;
+    Field<float>* q = &nxtPrs;
+    for (int done = 0; done < prsIters; done += d) {
+        sweep("pressure", p, q, &div, std::min(d, prsIters - done));
+        std::swap(p, q);
+    }
+
+    graph->add("gradient", ry, tileRows, [this, u, v, p](int y0, int y1) {
+        kernels->gradient(velU.data(), velV.data(), u->data(), v->data(), p->data(), grid, y0, y1, aspect * 0.5f);
+    }, { u, v, p }, { &velU, &velV }, [p]() {
+        p->fillHalo(Border::Zero);
+    });
+}
+
+/**
+ * @brief step() out of core, as one run of the frame's wavefront. Ahead of each step the tile above the front is read in, and the tile
+ * two below the last level, which nothing reads any more, is written back and dropped; the rows the last steps leave resident are
+ * dropped at the end, so the next frame starts from the bottom with only its window in memory
+ */
+void CpuFluid::stepOutOfCore() {
+    if (waveDif != difIters || wavePrs != prsIters)
+        buildWavefront();
+
+    difAlpha = delx * delx / (CPU_VISCOSITY * in.dt);
+    difRbeta = 1 / (4 + difAlpha);
+    int evicted = 0;
+    wave->run(pool, ry, waveRows, [&](int front, int back) {
+        if (front == 0)
+            tiles->prefetch(0, waveRows);
+        tiles->prefetch((front + 1) * waveRows, std::min(ry, (front + 2) * waveRows));
+        int below = std::max(0, (back - 1) * waveRows);
+        tiles->evict(evicted, below);
+        evicted = std::max(evicted, below);
+    });
+    tiles->evict(evicted, ry);
+
+    for (int c = 0; c < 3; c ++)
+        qnt[c].swap(nxtQnt[c]);
+    if (waveSwapVel) {
+        velU.swap(nxtU);
+        velV.swap(nxtV);
+    }
+    if (waveSwapPrs)
+        prs.swap(nxtPrs);
+}
+
+/**
+ * @brief The levels of stepOutOfCore, the passes of stepDense as plain sweeps: advection + force, with the force in place like
+ * advectForceStep; difIters diffusion iterations ping-ponging the velocity with (nxtU, nxtV); the divergence; prsIters pressure
+ * iterations; and the gradient into whichever velocity plane the last diffusion iteration did not write. Every level reads its
+ * predecessors' output at most a row outside its tile and only ever overwrites a plane two levels back (wavefront.h), so the sweep gives
+ * the same bits as the passes one after the other
+ */
+void CpuFluid::buildWavefront() {
+    delete wave;
+    wave = new Wavefront();
+    waveDif = difIters;
+    wavePrs = prsIters;
+
+    wave->add("advect + force", [this](int y0, int y1) {
+        float kx = in.dt * aspect * rx;
+        float ky = in.dt * aspect * ry;
+        const float* q[3] = { qnt[0].data(), qnt[1].data(), qnt[2].data() };
+        float* out[3] = { nxtQnt[0].data(), nxtQnt[1].data(), nxtQnt[2].data() };
+        kernels->advect(out, q, 3, velU.data(), velV.data(), grid, y0, y1, 0, rx, kx, ky);
+        splatRows(y0, y1);
+        forceRows(y0, y1);
+    });
+
+    Field<float>* cur[2] = { &velU, &velV };
+    Field<float>* oth[2] = { &nxtU, &nxtV };
+    for (int i = 0; i < difIters; i ++) {
+        Field<float>* xu = cur[0];
+        Field<float>* xv = cur[1];
+        Field<float>* ou = oth[0];
+        Field<float>* ov = oth[1];
+        wave->add("diffuse", [this, xu, xv, ou, ov](int y0, int y1) {
+            kernels->jacobi(ou->data(), xu->data(), xu->data(), grid, y0, y1, difAlpha, difRbeta);
+            kernels->jacobi(ov->data(), xv->data(), xv->data(), grid, y0, y1, difAlpha, difRbeta);
+        });
+        std::swap(cur, oth);
+    }
+
+    Field<float>* u = cur[0];
+    Field<float>* v = cur[1];
+    wave->add("divergence", [this, u, v](int y0, int y1) {
+        kernels->divergence(div.data(), u->data(), v->data(), grid, y0, y1, aspect * 0.5f);
+    });
+
+    Field<float>* p = &prs;
+    Field<float>* q = &nxtPrs;
+    for (int i = 0; i < prsIters; i ++) {
+        wave->add("pressure", [this, p, q](int y0, int y1) {
+            kernels->jacobi(q->data(), p->data(), div.data(), grid, y0, y1, -(delx * delx), 0.25f);
+        });
+        std::swap(p, q);
+    }
+
+    Field<float>* gu = oth[0];
+    Field<float>* gv = oth[1];
+    wave->add("gradient", [this, u, v, p, gu, gv](int y0, int y1) {
+        kernels->gradient(gu->data(), gv->data(), u->data(), v->data(), p->data(), grid, y0, y1, aspect * 0.5f);
+    });
+    waveSwapVel = gu == &nxtU;
+    waveSwapPrs = p == &nxtPrs;
+    sizeWindow();
+}
+
+// the levels buildWavefront adds: advection + force, the diffusion iterations, the divergence, the pressure iterations and the gradient
+static int waveLevels(int difIters, int prsIters) {
+    return difIters + prsIters + 3;
+}
+
+size_t CpuFluid::getMinWindowBytes() const {
+    if (tiles == NULL)
+        return 0;
+    // span() tiles of every plane, and the tile read ahead
+    return tiles->rowBytes() * (size_t)(2 * waveLevels(difIters, prsIters) + 2);
+}
+
+void CpuFluid::setOutOfCoreWindow(size_t bytes) {
+    opts.outOfCoreWindow = bytes;
+    if (wave != NULL)
+        sizeWindow();
+}
+
+/**
+ * @brief The tiles' height from the window; tiles are at least a row, so a window under getMinWindowBytes cannot be kept to
+ */
+void CpuFluid::sizeWindow() {
+    size_t perRow = getMinWindowBytes();
+    if (opts.outOfCoreWindow < perRow)
+        std::cout << "CPU out of core: WARNING: a window of " << opts.outOfCoreWindow / 1048576.0 << " MB is under the "
+            << perRow / 1048576.0 << " MB that tiles of one row need; the window is exceeded\n";
+    waveRows = (int)std::max((size_t)1, std::min((size_t)ry, opts.outOfCoreWindow / perRow));
+    std::cout << "CPU out of core: " << wave->size() << " passes over tiles of " << waveRows << " rows, " << wave->span() + 1
+        << " tiles in use, a window of " << getWindowBytes() / 1048576.0 << " MB (" << opts.outOfCoreWindow / 1048576.0 << " MB asked for)\n";
+}
+
+/**
+ * @brief step() in half mode. Every pass reads and writes half planes like the shaders do RGBA16F textures; the Jacobi solves run plain
+ * iterations, since the blocked solver's bands and the fused passes' row windows are float
+ */
+void CpuFluid::stepHalf() {
+    advectForceHalf();
+
+    float alpha = delx * delx / (CPU_VISCOSITY * in.dt);
+    float rbeta = 1 / (4 + alpha);
+    jacobiHalf(hVelU, hNxtU, NULL, difIters, alpha, rbeta);
+    jacobiHalf(hVelV, hNxtV, NULL, difIters, alpha, rbeta);
+
+    divergenceHalf();
+    jacobiHalf(hPrs, hNxtPrs, &hDiv, prsIters, -(delx * delx), 0.25f);
+    gradientHalf();
+}
+
+/**
+ * @brief advectForceStep on half planes. The splat and force work on float copies of each row, taken while the row is in cache; unlike
+ * advStep.fs the advected dye is rounded to half once before the splat as well as after it
+ */
+void CpuFluid::advectForceHalf() {
+    float kx = in.dt * aspect * rx;
+    float ky = in.dt * aspect * ry;
+    const Half* q[3] = { hQnt[0].data(), hQnt[1].data(), hQnt[2].data() };
+    Half* out[3] = { hNxtQnt[0].data(), hNxtQnt[1].data(), hNxtQnt[2].data() };
+
+    forRows([&](int y0, int y1) {
+        halfKernels->advect(out, q, 3, hVelU.data(), hVelV.data(), halfGrid, y0, y1, 0, rx, kx, ky);
+
+        int t = pool != NULL ? Executor::currentThread() : 0;
+        ArenaScope scope(*arena, t);
+        Field<float> s = arena->field<float>(t, rx, 5);
+        float* r[3] = { s.row(0), s.row(1), s.row(2) };
+        for (int y = y0; y < y1; y ++) {
+            for (int c = 0; c < 3; c ++)
+                halfKernels->fromHalf(r[c], hNxtQnt[c].row(y), rx);
+            splatRow(r, y, 0, rx);
+            for (int c = 0; c < 3; c ++)
+                halfKernels->toHalf(hNxtQnt[c].row(y), r[c], rx);
+
+            if (in.mDown) {
+                halfKernels->fromHalf(s.row(3), hVelU.row(y), rx);
+                halfKernels->fromHalf(s.row(4), hVelV.row(y), rx);
+                forceRow(s.row(3), s.row(4), y, 0, rx);
+                halfKernels->toHalf(hVelU.row(y), s.row(3), rx);
+                halfKernels->toHalf(hVelV.row(y), s.row(4), rx);
+            }
+        }
+    });
+
+    for (int c = 0; c < 3; c ++)
+        hQnt[c].swap(hNxtQnt[c]);
+}
+
+/**
+ * @brief iters Jacobi iterations of x on half planes, with tmp as the ping-pong partner; b is the right hand side, or the current iterate
+ * if NULL (as in difStep.fs)
+ */
+void CpuFluid::jacobiHalf(Field<Half>& x, Field<Half>& tmp, const Field<Half>* b, int iters, float alpha, float rbeta) {
+    for (int it = 0; it < iters; it ++) {
+        x.fillHalo(opts.border);
+        const Half* bp = b != NULL ? b->data() : x.data();
+        forRows([&](int y0, int y1) {
+            halfKernels->jacobi(tmp.data(), x.data(), bp, halfGrid, y0, y1, alpha, rbeta);
+        });
+        x.swap(tmp);
+    }
+}
+
+/**
+ * @brief divergenceStep on half planes
+ */
+void CpuFluid::divergenceHalf() {
+    hVelU.fillHalo(opts.border);
+    hVelV.fillHalo(opts.border);
+    forRows([&](int y0, int y1) {
+        halfKernels->divergence(hDiv.data(), hVelU.data(), hVelV.data(), halfGrid, y0, y1, aspect * 0.5f);
+    });
+}
+
+/**
+ * @brief gradientStep on half planes
+ */
+void CpuFluid::gradientHalf() {
+    hPrs.fillHalo(opts.border);
+    forRows([&](int y0, int y1) {
+        halfKernels->gradient(hNxtU.data(), hNxtV.data(), hVelU.data(), hVelV.data(), hPrs.data(), halfGrid, y0, y1, aspect * 0.5f);
+    });
+    hVelU.swap(hNxtU);
+    hVelV.swap(hNxtV);
+}
+
+/**
+ * @brief step() in sparse mode; the six passes as separate, plain sweeps, each over the spans of the frame's active blocks only.
+ * Blocks outside the map hold 0 in every plane, so the stencils at a span's edges read the same 0 there that they would at the grid's
+ * border, and the advection, which only writes the span's own texels, reads 0 from them too
+ */
+void CpuFluid::stepSparse() {
+    updateActivity();
+
+    // with every block active the spans are whole rows, and the dense passes do the same work with blocking and fusion, to the same bits
+    if (activity.count() == activity.blocks()) {
+        stepDense();
+        forSpans([&](const ActiveBlocks::Span& s) {
+            markMoving(s, velU, velV);
+        });
+        return;
+    }
+
+    float kx = in.dt * aspect * rx;
+    float ky = in.dt * aspect * ry;
+    const float* q[3] = { qnt[0].data(), qnt[1].data(), qnt[2].data() };
+    float* out[3] = { nxtQnt[0].data(), nxtQnt[1].data(), nxtQnt[2].data() };
+    forSpans([&](const ActiveBlocks::Span& s) {
+        windowKernels->advect(out, q, 3, velU.data(), velV.data(), grid, s.y0, s.y1, s.x0, s.x1, kx, ky);
+        for (int y = s.y0; y < s.y1; y ++) {
+            float* r[3] = { nxtQnt[0].row(y), nxtQnt[1].row(y), nxtQnt[2].row(y) };
+            splatRow(r, y, s.x0, s.x1);
+            if (in.mDown)
+                forceRow(velU.row(y), velV.row(y), y, s.x0, s.x1);
+        }
+    });
+    for (int c = 0; c < 3; c ++)
+        qnt[c].swap(nxtQnt[c]);
+
+    float alpha = delx * delx / (CPU_VISCOSITY * in.dt);
+    float rbeta = 1 / (4 + alpha);
+    jacobiSparse(velU, nxtU, NULL, difIters, alpha, rbeta);
+    jacobiSparse(velV, nxtV, NULL, difIters, alpha, rbeta);
+
+    // the fixed stencils run on the span as a window of the planes: pointers offset to its first column, rx narrowed to its width
+    velU.fillHalo(opts.border);
+    velV.fillHalo(opts.border);
+    forSpans([&](const ActiveBlocks::Span& s) {
+        Grid w = { s.x1 - s.x0, ry, grid.stride };
+        windowKernels->divergence(div.data() + s.x0, velU.data() + s.x0, velV.data() + s.x0, w, s.y0, s.y1, aspect * 0.5f);
+    });
+
+    jacobiSparse(prs, nxtPrs, &div, prsIters, -(delx * delx), 0.25f);
+
+    // the gradient, and the maxima of the frame's final velocity and dye, which decide the blocks of the next frame
+    prs.fillHalo(opts.border);
+    forSpans([&](const ActiveBlocks::Span& s) {
+        Grid w = { s.x1 - s.x0, ry, grid.stride };
+        windowKernels->gradient(nxtU.data() + s.x0, nxtV.data() + s.x0, velU.data() + s.x0, velV.data() + s.x0, prs.data() + s.x0, w, s.y0, s.y1,
+            aspect * 0.5f);
+        markMoving(s, nxtU, nxtV);
+    });
+    velU.swap(nxtU);
+    velV.swap(nxtV);
+}
+
+/**
+ * @brief Marks the blocks of span s in which the velocity (u, v) or the dye is above sparseEps in the next frame's map
+ */
+void CpuFluid::markMoving(const ActiveBlocks::Span& s, const Field<float>& u, const Field<float>& v) {
+    for (int x0 = s.x0; x0 < s.x1; x0 += ACTIVE_BLOCK) {
+        int x1 = x0 + ACTIVE_BLOCK < s.x1 ? x0 + ACTIVE_BLOCK : s.x1;
+        // a row at a time, stopping at the first row above the threshold; blocks in motion are usually found in their first row
+        bool above = false;
+        for (int y = s.y0; y < s.y1 && !above; y ++) {
+            const float* r[5] = { u.row(y), v.row(y), qnt[0].row(y), qnt[1].row(y), qnt[2].row(y) };
+            float m = 0.0f;
+            for (int c = 0; c < 5; c ++) {
+                for (int x = x0; x < x1; x ++) {
+                    float a = std::fabs(r[c][x]);
+                    m = a > m ? a : m;
+                }
+            }
+            above = m > opts.sparseEps;
+        }
+        if (above)
+            moving.mark(x0 / ACTIVE_BLOCK, s.y0 / ACTIVE_BLOCK);
+    }
+}
+
+/**
+ * @brief Builds this frame's map: the blocks the last frame left in motion, and those under the splat and wherever the force is above
+ * sparseEps, grown by a block. Blocks that drop out of the map are cleared in every plane
+ */
+void CpuFluid::updateActivity() {
+    if (in.mDown) {
+        float ox = in.mx / rx, oy = in.my / ry;
+        auto markDisk = [&](float r) {
+            moving.markRect((ox - r) * rx - 1, (oy - r) * ry - 1, (ox + r) * rx + 1, (oy + r) * ry + 1);
+        };
+
+        // the splat's radius (splatRow), and where |f| / dist >= sparseEps
+        markDisk(0.15f);
+        float f = std::fmax(std::fabs(in.relx / rx), std::fabs(in.rely / ry)) * CPU_FORCEMULT;
+        markDisk(f / opts.sparseEps);
+    }
+    moving.dilate();
+
+    std::swap(lastActivity, activity);
+    std::swap(activity, moving);
+    moving.clear();
+    activity.buildSpans();
+
+    for (int j = 0; j < activity.by; j ++)
+        for (int i = 0; i < activity.bx; i ++)
+            if (lastActivity.active(i, j) && !activity.active(i, j))
+                clearBlock(i, j);
+}
+
+/**
+ * @brief Zeroes block (i, j) of every plane, ping-pong partners included
+ */
+void CpuFluid::clearBlock(int i, int j) {
+    Field<float>* planes[] = { &velU, &velV, &nxtU, &nxtV, &prs, &nxtPrs, &div, &qnt[0], &qnt[1], &qnt[2], &nxtQnt[0], &nxtQnt[1], &nxtQnt[2] };
+    int x0 = i * ACTIVE_BLOCK, x1 = x0 + ACTIVE_BLOCK < rx ? x0 + ACTIVE_BLOCK : rx;
+    int y0 = j * ACTIVE_BLOCK, y1 = y0 + ACTIVE_BLOCK < ry ? y0 + ACTIVE_BLOCK : ry;
+    for (Field<float>* p : planes)
+        for (int y = y0; y < y1; y ++)
+            for (int x = x0; x < x1; x ++)
+                p->at(x, y) = 0.0f;
+}
+
+/**
+ * @brief Plain Jacobi iterations over the active spans; b is the right hand side, or the current iterate if NULL (as in difStep.fs)
+ */
+void CpuFluid::jacobiSparse(Field<float>& x, Field<float>& tmp, const Field<float>* b, int iters, float alpha, float rbeta) {
+    for (int it = 0; it < iters; it ++) {
+        x.fillHalo(opts.border);
+        const float* bp = b != NULL ? b->data() : x.data();
+        forSpans([&](const ActiveBlocks::Span& s) {
+            Grid w = { s.x1 - s.x0, ry, grid.stride };
+            windowKernels->jacobi(tmp.data() + s.x0, x.data() + s.x0, bp + s.x0, w, s.y0, s.y1, alpha, rbeta);
+        });
+        x.swap(tmp);
+    }
+}
+
+/**
+ * @brief Runs f over the spans of the frame's map, one span per tile
+ */
+void CpuFluid::forSpans(FnRef<void(const ActiveBlocks::Span&)> f) {
+    const std::vector<ActiveBlocks::Span>& spans = activity.spans();
+    if (pool == NULL) {
+        for (const ActiveBlocks::Span& s : spans)
+            f(s);
+        return;
+    }
+    pool->parallelFor((int)spans.size(), 1, [&](int i0, int i1) {
+        for (int i = i0; i < i1; i ++)
+            f(spans[i]);
+    });
+}
+
+/**
+ * @brief Interleaves the dye planes into RGBA texels, alpha 1
+ *
+ * @param rgba Destination of rx * ry * 4 floats, rows bottom to top
+ */
+void CpuFluid::writeQuantity(float* rgba) const {
+    if (opts.half) {
+        ArenaScope scope(*arena, 0);
+        Field<float> rows = arena->field<float>(0, rx, 3);
+        for (int y = 0; y < ry; y ++) {
+            for (int c = 0; c < 3; c ++)
+                halfKernels->fromHalf(rows.row(c), hQnt[c].row(y), rx);
+            float* o = rgba + (size_t)y * rx * 4;
+            for (int x = 0; x < rx; x ++) {
+                o[4 * x + 0] = rows.at(x, 0);
+                o[4 * x + 1] = rows.at(x, 1);
+                o[4 * x + 2] = rows.at(x, 2);
+                o[4 * x + 3] = 1.0f;
+            }
+        }
+        return;
+    }
+
+    for (int y = 0; y < ry; y ++) {
+        const float* r = qnt[0].row(y);
+        const float* g = qnt[1].row(y);
+        const float* b = qnt[2].row(y);
+        float* o = rgba + (size_t)y * rx * 4;
+        for (int x = 0; x < rx; x ++) {
+            o[4 * x + 0] = r[x];
+            o[4 * x + 1] = g[x];
+            o[4 * x + 2] = b[x];
+            o[4 * x + 3] = 1.0f;
+        }
+    }
+}
+
+/**
+ * @brief Writes the dye the way fluid.fs draws it into the window, clamped and rounded to 8 bits, with the rows flipped to the top
+ * down order of a texture; in half mode the halfs are converted in the kernel
+ *
+ * @param pixels Destination of ry rows of rx pixels
+ * @param pitch Bytes between rows of pixels
+ */
+void CpuFluid::presentQuantity(uint32_t* pixels, int pitch) {
+    if (present == NULL) {
+        present = &selectPresentKernels();
+        std::cout << "CPU presentation: max deviation from scalar reference " << validatePresentKernels(*present) << "\n";
+    }
+
+    forRows([&](int y0, int y1) {
+        for (int y = y0; y < y1; y ++) {
+            uint32_t* o = (uint32_t*)((char*)pixels + (size_t)(ry - 1 - y) * pitch);
+            if (opts.half) {
+                const Half* q[3] = { hQnt[0].row(y), hQnt[1].row(y), hQnt[2].row(y) };
+                present->presentHalf(o, q, rx);
+            } else {
+                const float* q[3] = { qnt[0].row(y), qnt[1].row(y), qnt[2].row(y) };
+                present->present(o, q, rx);
+            }
+        }
+    });
+}
@@ -0,0 +1,225 @@
+/**
+ * @file cpuFluid.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief CPU engine running the same six passes as GG1_C38_Handler::objRendererHandler on Field planes
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_FLUID_H
+#define CPU_FLUID_H
+
+#include <vector>
+
+#include "../../util/executor.h"
+#include "../../util/taskGraph.h"
+#include "../../util/wavefront.h"
+#include "activeBlocks.h"
+#include "field.h"
+#include "fieldStore.h"
+#include "frameArena.h"
+#include "jacobiBlocked.h"
+#include "stencil.h"
+#include "tileStore.h"
+
+// mirrors math/constants.fs
+const float CPU_VISCOSITY = 1.0f;
+const float CPU_FORCEMULT = 0.3f;
+
+/**
+ * @brief Per frame values that the GPU path passes to the shaders as uniforms (see GG1_C38_Handler::setShader)
+ */
+struct FluidInput {
+    int frame;
+    float dt;
+    float mx, my;     // mpos; mouse position in pixels, origin at the bottom left
+    float relx, rely; // rel; mouse motion in pixels
+    bool mDown;
+};
+
+// the splat and decay of advStep.fs and the force of frcStep.fs on columns [x0, x1) of row y of an rx by ry grid, for every engine.
+// Texel x of a row is at x * pitch (an ensemble's lane, see ensembleFluid.h), and forceMult stands in for FORCEMULT
+void splatTexels(const FluidInput& in, int rx, int ry, float* const* r, int y, int x0, int x1, int pitch = 1);
+void forceTexels(const FluidInput& in, int rx, int ry, float* u, float* v, int y, int x0, int x1, int pitch = 1, float forceMult = CPU_FORCEMULT);
+
+/**
+ * @brief Tuning of the CPU engine; the defaults are the fastest configuration, the alternatives exist for validation and comparison
+ */
+struct CpuOptions {
+    int blockDepth = 4; // Jacobi iterations per cache resident band (see jacobiBlocked.h); 1 is plain iteration
+    bool fused = true;  // advection + force, and the last diffusion iteration + divergence, each in one sweep; false runs the six passes separately
+    Border border = Border::Zero; // what the stencils read outside the grid; Zero matches the GPU path (advection always reads 0)
+    bool half = false;  // store every plane as IEEE halfs, like the GPU path's RGBA16F textures, computing in float; runs plain passes (no blocking or fusion)
+    bool sparse = false; // only run the passes over blocks in motion (activeBlocks.h); approximate, so off by default. Float storage, plain passes
+    float sparseEps = 1e-4f; // velocity and dye magnitudes below which a block counts as still
+    const char* executor = "pool"; // backend the handler runs the passes on (executor.h): serial, pool, std or openmp
+    bool pin = false;       // pin the pool's threads to CPUs node by node (the handler makes the pool; see ThreadPool)
+    bool hugePages = false; // map the planes on 2 MB pages where the OS allows (fieldStore.h)
+    bool graph = true;      // run the fused Border::Zero frame as a task graph on pools of 2+ threads, so the dye advection overlaps the
+                            // velocity chain instead of every pass ending at a barrier; same results
+    const char* outOfCore = NULL; // directory to keep every plane in as a mapped file (tileStore.h), for grids larger than memory; NULL
+                                  // keeps them in memory. The frame runs as one wavefront over tiles of rows (wavefront.h), float storage
+                                  // and Border::Zero; same results as the in memory passes
+    size_t outOfCoreWindow = (size_t)256 << 20; // bytes of plane rows the wavefront keeps in use at once, which sets the tiles' height.
+                                                // It holds 2 * levels + 1 tiles of every plane and the tile read ahead (levels =
+                                                // difIters + prsIters + 3, 63 by default), and a tile is at least a row, so anything
+                                                // under that many rows of every plane (CpuFluid::getMinWindowBytes) is exceeded, with a
+                                                // warning
+};
+
+/**
+ * @brief CPU counterpart of the seven TexturePairs and six step shaders. Only the channels the shaders actually use are stored:
+ * velocity xy, pressure x, divergence x and dye (quantity) xyz
+ */
+class CpuFluid {
+    public:
+        CpuFluid(int rx, int ry, Executor* pool = NULL, CpuOptions opts = CpuOptions());
+        ~CpuFluid();
+
+        // advances one frame, in the same order as the GPU path
+        void step(const FluidInput& in);
+
+        // writes the dye as rx * ry RGBA texels (e.g. into a StreamBuffer slot)
+        void writeQuantity(float* rgba) const;
+
+        // writes the dye as rx * ry RGBA8 pixels (PresentFn), top row first and rows pitch bytes apart (e.g. into a locked SDL texture),
+        // split over the pool
+        void presentQuantity(uint32_t* pixels, int pitch);
+
+        int getRX() { return rx; }
+        int getRY() { return ry; }
+
+        // the blocks the last frame ran on in sparse mode
+        const ActiveBlocks& getActivity() const { return activity; }
+
+        // the scratch arena, as of the last frame
+        ArenaStats getArenaStats() const { return arena->getStats(); }
+
+        // the frame's task graph (CpuOptions::graph) as of the last frame; NULL if the engine does not use one
+        const TaskGraph* getGraph() const { return graph; }
+
+        // out of core mode (CpuOptions::outOfCore); the files behind the planes, NULL in memory, the rows of a wavefront tile, and the
+        // bytes of plane rows the wavefront had in use at once, as of the last frame
+        const TileStore* getTiles() const { return tiles; }
+        int getWaveRows() const { return waveRows; }
+        size_t getWindowBytes() const { return wave != NULL ? tiles->rowBytes() * waveRows * (wave->span() + 1) : 0; }
+        // the least window the wavefront can keep to with the current iteration counts, tiles of one row; 0 in memory
+        size_t getMinWindowBytes() const;
+        // changes CpuOptions::outOfCoreWindow, from the next frame on
+        void setOutOfCoreWindow(size_t bytes);
+
+        // diagnostics of the current state, in any storage mode; each is the same bits on every backend and thread count
+        // (Executor::parallelReduce). Mean kinetic energy per cell, 0.5 * |vel|^2, in uv units per second
+        double kineticEnergy();
+        // the largest |vel|, e.g. for a CFL bound on dt
+        double maxSpeed();
+        // root mean square residual of the pressure equation after the last frame's iterations; how far the projection is from converged
+        double pressureResidual();
+
+        int difIters = 20;
+        int prsIters = 40;
+
+        // the engine's state; empty in half mode (CpuOptions::half), whose state is only readable through writeQuantity. div is the
+        // last frame's, a view into the frame arena (out of core, a file like the rest)
+        Field<float> velU, velV, prs, div, qnt[3];
+
+    private:
+        void advectionStep();
+        void forceStep();
+        void diffusionStep();
+        void divergenceStep();
+        void pressureStep();
+        void gradientStep();
+
+        // row ranges of the advection splat and decay, and of the force, and their single row forms on rows of floats
+        void splatRows(int y0, int y1);
+        void forceRows(int y0, int y1);
+        void splatRow(float* const* q, int y, int x0, int x1);
+        void forceRow(float* u, float* v, int y, int x0, int x1);
+
+        // fused forms of advectionStep + forceStep, and of the last diffusion iteration + divergenceStep
+        void advectForceStep();
+        void diffuseDivergenceStep();
+        void diffuseDivergenceRows(const Field<float>& u, const Field<float>& v, Field<float>& outU, Field<float>& outV, int y0, int y1);
+
+        // the dense frame as a task graph; built on first use and again whenever difIters or prsIters change
+        void stepGraph();
+        void buildGraph();
+
+        // the frame in out of core mode, as a wavefront over tiles of rows; built on first use and again whenever difIters or prsIters change
+        void stepOutOfCore();
+        void buildWavefront();
+        void sizeWindow();
+
+        // the frame in half mode; advection + force in one sweep, then plain Jacobi sweeps and the remaining passes
+        void stepHalf();
+        void advectForceHalf();
+        void jacobiHalf(Field<Half>& x, Field<Half>& tmp, const Field<Half>* b, int iters, float alpha, float rbeta);
+        void divergenceHalf();
+        void gradientHalf();
+
+        // the frame in float storage over the whole grid
+        void stepDense();
+
+        // the frame in sparse mode; every pass runs over the spans of active blocks only
+        void stepSparse();
+        void updateActivity();
+        void markMoving(const ActiveBlocks::Span& s, const Field<float>& u, const Field<float>& v);
+        void clearBlock(int i, int j);
+        void jacobiSparse(Field<float>& x, Field<float>& tmp, const Field<float>* b, int iters, float alpha, float rbeta);
+        void forSpans(FnRef<void(const ActiveBlocks::Span&)> f);
+
+        // runs f over row tiles on the pool (or serially without one)
+        void forRows(FnRef<void(int, int)> f);
+
+        // f over the same row tiles, combined by tile in a fixed order (serially without a pool)
+        double reduceRows(FnRef<double(int, int)> f, Combine combine);
+
+        // row y of a plane as floats, columns -1 to rx: f's own row, or in half mode h's converted into tmp
+        const float* floatRow(const Field<float>& f, const Field<Half>& h, int y, float* tmp);
+
+        int rx, ry;
+        Executor* pool;
+        SerialExecutor serial; // reduceRows without a pool
+        CpuOptions opts;
+        int tileRows;
+        float delx, aspect;
+        FluidInput in;
+
+        const StencilKernels* kernels;
+        const StencilKernels* windowKernels; // the generic table, for the sparse passes' column windows
+        Grid grid;
+        BlockedJacobi* solver;
+        FrameArena* arena;
+        FieldStore* store; // owns every plane but the frame arena's
+
+        // ping-pong partners
+        Field<float> nxtU, nxtV, nxtPrs, nxtQnt[3];
+
+        // graph mode; the velocity after the force, which diffusion ping-pongs with nxtU / nxtV, the graph, the iteration counts it was
+        // built for, and the diffusion's coefficients for the frame
+        Field<float> wU, wV;
+        TaskGraph* graph;
+        int graphDif, graphPrs;
+        float difAlpha, difRbeta;
+
+        // out of core mode; the planes' files, the frame's wavefront, the iteration counts it was built for, the tiles' height, and
+        // whether the frame leaves the velocity and pressure in the ping-pong partners
+        TileStore* tiles;
+        Wavefront* wave;
+        int waveDif, wavePrs, waveRows;
+        bool waveSwapVel, waveSwapPrs;
+
+        // half mode; the planes and their ping-pong partners (hDiv is a view into the frame arena)
+        const HalfKernels* halfKernels;
+        const PresentKernels* present; // selected on the first presentQuantity
+        Grid halfGrid;
+        Field<Half> hVelU, hVelV, hPrs, hDiv, hQnt[3];
+        Field<Half> hNxtU, hNxtV, hNxtPrs, hNxtQnt[3];
+
+        // sparse mode; the blocks this frame runs on, the blocks this frame leaves in motion (the next frame's map before it is grown),
+        // and the previous frame's map
+        ActiveBlocks activity, moving, lastActivity;
+};
+
+#endif
@@ -0,0 +1,200 @@
+/**
+ * @file ensembleFluid.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Many small instances of the CPU engine stepped together, interleaved per texel so that each vector lane advances its own instance
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "ensembleFluid.h"
+
+#include <cmath>
+#include <iostream>
+
+/**
+ * @brief Construct a new EnsembleFluid object, selecting and validating the ensemble kernels for this machine
+ *
+ * @param rx X resolution of every instance
+ * @param ry Y resolution of every instance
+ * @param lanes Instances; rounded up to a multiple of the kernels' register width
+ * @param pool Executor the passes are split over (executor.h); NULL runs single threaded
+ */
+EnsembleFluid::EnsembleFluid(int rx, int ry, int lanes, Executor* pool) : rx(rx), ry(ry), pool(pool) {
+    kernels = &selectEnsembleKernels();
+    std::cout << "CPU ensemble stencils: max deviation from scalar reference " << validateEnsembleKernels(*kernels) << "\n";
+
+    int w = kernels->width;
+    int n = lanes < 1 ? 1 : lanes;
+    K = (n + w - 1) / w * w;
+    members.assign(K, EnsembleMember());
+
+    delx = 1.0f / rx;
+    aspect = (float)rx / (float)ry;
+
+    // a ghost texel is K floats, so the planes' halo is K
+    velU = Field<float>(rx * K, ry, K); velV = Field<float>(rx * K, ry, K);
+    nxtU = Field<float>(rx * K, ry, K); nxtV = Field<float>(rx * K, ry, K);
+    prs = Field<float>(rx * K, ry, K); nxtPrs = Field<float>(rx * K, ry, K);
+    div = Field<float>(rx * K, ry, K);
+    for (int c = 0; c < 3; c ++) {
+        qnt[c] = Field<float>(rx * K, ry, K);
+        nxtQnt[c] = Field<float>(rx * K, ry, K);
+    }
+
+    grid.rx = rx;
+    grid.ry = ry;
+    grid.stride = velU.stride;
+
+    // as CpuFluid's, for rows K times as long
+    tileRows = (int)(64 * 1024 / (grid.stride * sizeof(float) * 4));
+    if (tileRows < 2)
+        tileRows = 2;
+
+    kx.resize(K); ky.resize(K);
+    frcX.resize(K); frcY.resize(K); mouseX.resize(K); mouseY.resize(K);
+    difAlpha.resize(K); difRbeta.resize(K);
+    prsAlpha.assign(K, -(delx * delx));
+    prsRbeta.assign(K, 0.25f);
+}
+
+void EnsembleFluid::forRows(FnRef<void(int, int)> f) {
+    if (pool != NULL)
+        pool->parallelFor(ry, tileRows, f);
+    else
+        f(0, ry);
+}
+
+/**
+ * @brief The six passes in the GPU path's order, each once over every instance. The ghost cells are never written, so they keep the 0
+ * of Border::Zero
+ */
+void EnsembleFluid::step(const FluidInput* in) {
+    for (int k = 0; k < K; k ++) {
+        kx[k] = in[k].dt * aspect * rx;
+        ky[k] = in[k].dt * aspect * ry;
+        difAlpha[k] = delx * delx / (members[k].viscosity * in[k].dt);
+        difRbeta[k] = 1 / (4 + difAlpha[k]);
+    }
+
+    advectionStep(in);
+    forceStep(in);
+    jacobi(velU, nxtU, NULL, difIters, difAlpha.data(), difRbeta.data());
+    jacobi(velV, nxtV, NULL, difIters, difAlpha.data(), difRbeta.data());
+    divergenceStep();
+    jacobi(prs, nxtPrs, &div, prsIters, prsAlpha.data(), prsRbeta.data());
+    gradientStep();
+}
+
+/**
+ * @brief advStep.fs; the advection of every lane, then the splat and decay. Only instances whose mouse is down near a row splat anything
+ * into it, and they run splatTexels on their lane; every other run of lanes just decays, which is the same (r + 0) * 0.995
+ */
+void EnsembleFluid::advectionStep(const FluidInput* in) {
+    const float* q[3] = { qnt[0].data(), qnt[1].data(), qnt[2].data() };
+    float* out[3] = { nxtQnt[0].data(), nxtQnt[1].data(), nxtQnt[2].data() };
+
+    // a row further than 0.16 from the mouse is out of the splat's 0.15 reach whatever the rounding of its distances
+    auto near = [&](int k, int y) {
+        return in[k].mDown && std::fabs((y + 0.5f) / ry - in[k].my / ry) <= 0.16f;
+    };
+
+    forRows([&](int y0, int y1) {
+        kernels->advect(out, q, 3, velU.data(), velV.data(), grid, K, y0, y1, kx.data(), ky.data());
+        for (int y = y0; y < y1; y ++) {
+            for (int k0 = 0; k0 < K; ) {
+                if (near(k0, y)) {
+                    float* r[3] = { nxtQnt[0].row(y) + k0, nxtQnt[1].row(y) + k0, nxtQnt[2].row(y) + k0 };
+                    splatTexels(in[k0], rx, ry, r, y, 0, rx, K);
+                    k0 ++;
+                    continue;
+                }
+                int k1 = k0 + 1;
+                while (k1 < K && !near(k1, y))
+                    k1 ++;
+                for (int c = 0; c < 3; c ++) {
+                    float* r = nxtQnt[c].row(y);
+                    for (ptrdiff_t i = 0; i < (ptrdiff_t)rx * K; i += K)
+                        for (int k = k0; k < k1; k ++)
+                            r[i + k] = (r[i + k] + 0.0f) * 0.995f;
+                }
+                k0 = k1;
+            }
+        }
+    });
+
+    for (int c = 0; c < 3; c ++)
+        qnt[c].swap(nxtQnt[c]);
+}
+
+/**
+ * @brief frcStep.fs with each instance's FORCEMULT, over the runs of lanes whose mouse is down
+ */
+void EnsembleFluid::forceStep(const FluidInput* in) {
+    for (int k = 0; k < K; k ++) {
+        frcX[k] = in[k].relx / rx * members[k].forceMult;
+        frcY[k] = in[k].rely / ry * members[k].forceMult;
+        mouseX[k] = in[k].mx / rx;
+        mouseY[k] = in[k].my / ry;
+    }
+
+    forRows([&](int y0, int y1) {
+        for (int k0 = 0; k0 < K; ) {
+            if (!in[k0].mDown) {
+                k0 ++;
+                continue;
+            }
+            int k1 = k0 + 1;
+            while (k1 < K && in[k1].mDown)
+                k1 ++;
+            for (int y = y0; y < y1; y ++)
+                kernels->force(velU.data(), velV.data(), grid, K, y, k0, k1, frcX.data(), frcY.data(), mouseX.data(), mouseY.data());
+            k0 = k1;
+        }
+    });
+}
+
+/**
+ * @brief iters Jacobi iterations of x with tmp as the ping-pong partner; b is the right hand side, or the current iterate if NULL (as in
+ * difStep.fs)
+ */
+void EnsembleFluid::jacobi(Field<float>& x, Field<float>& tmp, const Field<float>* b, int iters, const float* alpha, const float* rbeta) {
+    for (int it = 0; it < iters; it ++) {
+        const float* bp = b != NULL ? b->data() : x.data();
+        forRows([&](int y0, int y1) {
+            kernels->jacobi(tmp.data(), x.data(), bp, grid, K, y0, y1, alpha, rbeta);
+        });
+        x.swap(tmp);
+    }
+}
+
+/**
+ * @brief divStep.fs
+ */
+void EnsembleFluid::divergenceStep() {
+    forRows([&](int y0, int y1) {
+        kernels->divergence(div.data(), velU.data(), velV.data(), grid, K, y0, y1, aspect * 0.5f);
+    });
+}
+
+/**
+ * @brief grdStep.fs
+ */
+void EnsembleFluid::gradientStep() {
+    forRows([&](int y0, int y1) {
+        kernels->gradient(nxtU.data(), nxtV.data(), velU.data(), velV.data(), prs.data(), grid, K, y0, y1, aspect * 0.5f);
+    });
+    velU.swap(nxtU);
+    velV.swap(nxtV);
+}
+
+void EnsembleFluid::writeQuantity(int k, float* rgba) const {
+    for (int y = 0; y < ry; y ++) {
+        float* o = rgba + ((size_t)y * rx) * 4;
+        for (int x = 0; x < rx; x ++) {
+            o[4 * x + 0] = at(qnt[0], k, x, y);
+            o[4 * x + 1] = at(qnt[1], k, x, y);
+            o[4 * x + 2] = at(qnt[2], k, x, y);
+            o[4 * x + 3] = 1.0f;
+        }
+    }
+}
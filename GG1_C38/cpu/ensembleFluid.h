@@ -0,0 +1,94 @@
+/**
+ * @file ensembleFluid.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Many small instances of the CPU engine stepped together, interleaved per texel so that each vector lane advances its own instance
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_ENSEMBLE_FLUID_H
+#define CPU_ENSEMBLE_FLUID_H
+
+#include <vector>
+
+#include "../../util/executor.h"
+#include "cpuFluid.h"
+#include "field.h"
+#include "stencil.h"
+
+/*
+Parameter sweeps run thousands of small simulations that differ only in their constants and forcing. One CpuFluid per instance at 64x64
+has too few rows to split over threads and too short rows to fill a vector register for long, so an ensemble stores K instances as one
+set of planes with the instances interleaved per texel (lane k of texel (x, y) at x * K + k of row y, see stencil.h) and runs every pass
+once for all of them: each register holds one texel of W instances, every lane takes the same taps, and the per instance viscosity
+enters the diffusion as a vector of coefficients. K is best a multiple of the kernels' register width (lanes() rounds up to one).
+
+Each instance computes exactly what a CpuFluid with the same constants and input would (Border::Zero, float storage); benchEnsemble
+checks its lanes against one.
+*/
+
+/**
+ * @brief What one instance of an ensemble varies; the defaults are those of math/constants.fs
+ */
+struct EnsembleMember {
+    float viscosity = CPU_VISCOSITY;
+    float forceMult = CPU_FORCEMULT;
+};
+
+class EnsembleFluid {
+    public:
+        // lanes instances of an rx by ry grid, rounded up to a multiple of the register width; pool splits the rows, NULL runs single threaded
+        EnsembleFluid(int rx, int ry, int lanes, Executor* pool = NULL);
+
+        EnsembleFluid(const EnsembleFluid&) = delete;
+        EnsembleFluid& operator=(const EnsembleFluid&) = delete;
+
+        // advances every instance one frame, instance k under in[k] (lanes() inputs)
+        void step(const FluidInput* in);
+
+        // writes instance k's dye as rx * ry RGBA texels
+        void writeQuantity(int k, float* rgba) const;
+
+        // texel (x, y) of instance k of one of the planes
+        float at(const Field<float>& f, int k, int x, int y) const { return f.at(x * K + k, y); }
+
+        int lanes() const { return K; }
+        int getRX() const { return rx; }
+        int getRY() const { return ry; }
+
+        // one per instance, set before stepping
+        std::vector<EnsembleMember> members;
+
+        int difIters = 20;
+        int prsIters = 40;
+
+        // the instances' state, rx * K floats wide; div is the last frame's
+        Field<float> velU, velV, prs, div, qnt[3];
+
+    private:
+        void advectionStep(const FluidInput* in);
+        void forceStep(const FluidInput* in);
+        void jacobi(Field<float>& x, Field<float>& tmp, const Field<float>* b, int iters, const float* alpha, const float* rbeta);
+        void divergenceStep();
+        void gradientStep();
+
+        // runs f over row tiles on the pool (or serially without one)
+        void forRows(FnRef<void(int, int)> f);
+
+        int rx, ry, K;
+        Executor* pool;
+        int tileRows;
+        float delx, aspect;
+
+        const EnsembleKernels* kernels;
+        Grid grid;
+
+        // ping-pong partners
+        Field<float> nxtU, nxtV, nxtPrs, nxtQnt[3];
+
+        // the frame's per lane coefficients: the advection's backtrace scale, the force's scale and the mouse's uv, the diffusion's and
+        // the pressure's Jacobi constants
+        std::vector<float> kx, ky, frcX, frcY, mouseX, mouseY, difAlpha, difRbeta, prsAlpha, prsRbeta;
+};
+
+#endif
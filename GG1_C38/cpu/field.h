@@ -0,0 +1,179 @@
+/**
+ * @file field.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Single channel 2D grid used by the CPU engine; the CPU counterpart of one channel of a TexturePair texture
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_FIELD_H
+#define CPU_FIELD_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+// alignment of every field allocation and row; one cache line, and a full AVX-512 register
+#define FIELD_ALIGN 64
+
+inline void* alignedAlloc(size_t bytes) {
+#ifdef _MSC_VER
+    void* p = _aligned_malloc(bytes, FIELD_ALIGN);
+#else
+    void* p = NULL;
+    if (posix_memalign(&p, FIELD_ALIGN, bytes) != 0)
+        p = NULL;
+#endif
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+inline void alignedFree(void* p) {
+#ifdef _MSC_VER
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// elements per FIELD_ALIGN line, and the left padding that holds halo ghost cells while keeping texel 0 aligned
+constexpr ptrdiff_t fieldLine(size_t elem) { return (ptrdiff_t)(FIELD_ALIGN / elem); }
+constexpr ptrdiff_t fieldLeft(int halo, size_t elem) { return (halo + fieldLine(elem) - 1) / fieldLine(elem) * fieldLine(elem); }
+
+/**
+ * @brief Row stride, in elements, of a Field of width rx with halo ghost cells; a compile time constant for the size specialized kernels
+ */
+constexpr ptrdiff_t fieldStride(int rx, int halo, size_t elem) {
+    // the left ghost cells padded to a full line, the row and the right ghost cells, rounded up to a full line
+    return (fieldLeft(halo, elem) + rx + halo + fieldLine(elem) - 1) / fieldLine(elem) * fieldLine(elem);
+}
+
+/**
+ * @brief What ghost cells hold; the value of a tap that falls outside the grid
+ */
+enum class Border {
+    Zero,     // 0, like GL_CLAMP_TO_BORDER with the black border TexturePair uses
+    Clamp,    // the nearest edge texel (GL_CLAMP_TO_EDGE)
+    Periodic, // the texel from the opposite edge (GL_REPEAT)
+    Mirror    // the texel reflected about the edge (GL_MIRRORED_REPEAT)
+};
+
+/**
+ * @brief Row major rx by ry grid surrounded by halo ghost cells on every side. Rows are padded to FIELD_ALIGN bytes and the left ghost
+ * cells are padded out to a full FIELD_ALIGN line, so texel 0 of every row is aligned. Row 0 is the bottom row (matching texture v = 0).
+ *
+ * data(), row(y) and at(x, y) address the interior; rows -halo to ry + halo - 1 and columns -halo to rx + halo - 1 are valid, so a
+ * stencil reaching at most halo texels can read its taps without bounds checks. The ghost cells start out 0 (Border::Zero) and are
+ * refreshed from the interior by fillHalo, once per pass, instead of being checked per tap.
+ *
+ * A field can also be a view over storage it does not own (a FrameArena's, see frameArena.h); views start out uninitialized, ghost
+ * cells included, and leave the storage alone when destroyed
+ */
+template<typename T>
+class Field {
+    public:
+        Field() : rx(0), ry(0), stride(0), halo(0), mem(NULL), origin(NULL), owner(false) {}
+
+        Field(int rx, int ry, int halo = 1) : rx(rx), ry(ry), halo(halo), owner(true) {
+            stride = fieldStride(rx, halo, sizeof(T));
+            mem = (T*)alignedAlloc(bytes(rx, ry, halo));
+            origin = mem + halo * stride + fieldLeft(halo, sizeof(T));
+            fill(T(0));
+        }
+
+        // view over storage, FIELD_ALIGN aligned and at least bytes(rx, ry, halo) long
+        Field(int rx, int ry, int halo, void* storage) : rx(rx), ry(ry), halo(halo), owner(false) {
+            stride = fieldStride(rx, halo, sizeof(T));
+            mem = (T*)storage;
+            origin = mem + halo * stride + fieldLeft(halo, sizeof(T));
+        }
+
+        ~Field() {
+            if (owner && mem != NULL)
+                alignedFree(mem);
+        }
+
+        // bytes of storage of a field, ghost cells and padding included
+        static size_t bytes(int rx, int ry, int halo = 1) { return sizeof(T) * fieldStride(rx, halo, sizeof(T)) * (ry + 2 * halo); }
+
+        Field(const Field&) = delete;
+        Field& operator=(const Field&) = delete;
+
+        Field(Field&& o) noexcept : rx(0), ry(0), stride(0), halo(0), mem(NULL), origin(NULL), owner(false) { swap(o); }
+        Field& operator=(Field&& o) noexcept { swap(o); return *this; }
+
+        // exchanges storage with another field of the same size (ping-pong)
+        void swap(Field& o) noexcept {
+            std::swap(rx, o.rx);
+            std::swap(ry, o.ry);
+            std::swap(stride, o.stride);
+            std::swap(halo, o.halo);
+            std::swap(mem, o.mem);
+            std::swap(origin, o.origin);
+            std::swap(owner, o.owner);
+        }
+
+        // sets every texel, ghost cells included
+        void fill(T v) {
+            for (ptrdiff_t i = 0; i < stride * (ry + 2 * halo); i ++)
+                mem[i] = v;
+        }
+
+        /**
+         * @brief Refreshes the ghost cells from the interior. Columns first, then whole ghost rows (ghost columns included), so the corners
+         * follow the policy in both directions
+         */
+        void fillHalo(Border b) {
+            for (int y = 0; y < ry; y ++) {
+                T* r = row(y);
+                for (int k = 1; k <= halo; k ++) {
+                    r[-k] = b == Border::Zero ? T(0) : r[ghost(b, -k, rx)];
+                    r[rx - 1 + k] = b == Border::Zero ? T(0) : r[ghost(b, rx - 1 + k, rx)];
+                }
+            }
+            for (int k = 1; k <= halo; k ++) {
+                T* lo = row(-k);
+                T* hi = row(ry - 1 + k);
+                const T* loSrc = row(ghost(b, -k, ry));
+                const T* hiSrc = row(ghost(b, ry - 1 + k, ry));
+                for (int x = -halo; x < rx + halo; x ++) {
+                    lo[x] = b == Border::Zero ? T(0) : loSrc[x];
+                    hi[x] = b == Border::Zero ? T(0) : hiSrc[x];
+                }
+            }
+        }
+
+        T* data() { return origin; }
+        const T* data() const { return origin; }
+        T* row(int y) { return origin + y * stride; }
+        const T* row(int y) const { return origin + y * stride; }
+        T& at(int x, int y) { return origin[y * stride + x]; }
+        const T& at(int x, int y) const { return origin[y * stride + x]; }
+
+        int rx, ry;
+        ptrdiff_t stride; // in elements
+        int halo;         // ghost cells on each side
+
+    private:
+        // interior index that ghost index i (outside [0, n)) takes its value from; unused for Border::Zero
+        static int ghost(Border b, int i, int n) {
+            switch (b) {
+                case Border::Clamp: return i < 0 ? 0 : n - 1;
+                case Border::Periodic: return ((i % n) + n) % n;
+                case Border::Mirror: return i < 0 ? -1 - i : 2 * n - 1 - i;
+                default: return 0;
+            }
+        }
+
+        T* mem;
+        T* origin;
+        bool owner; // whether mem is freed with the field
+};
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @file fieldExpr.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Lazy expression templates over Field planes, so stencils can be written like the GLSL helpers in math/stencils.fs
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_FIELD_EXPR_H
+#define CPU_FIELD_EXPR_H
+
+#include <cstddef>
+
+#include "field.h"
+
+/*
+An expression such as
+
+    (shiftL(x) + shiftR(x) + shiftB(x) + shiftT(x) + alpha * b) * rbeta
+
+builds a small tree of value types and computes nothing; assign() then evaluates the whole tree in a single loop over the destination,
+without a temporary plane per sub expression. shiftL/R/B/T(e) read e one texel to the left, right, below and above, like the
+texture(tex, uv - vec2(delx, 0)) etc. taps of the shaders. Taps outside the grid read the planes' ghost cells (see Field::fillHalo),
+or 0 beyond them (GL_CLAMP_TO_BORDER, black border).
+
+Every node provides
+    at(x, y)        the value at one texel, with bounds checks; used for the texels near the border
+    row(y)[x]       a cursor over row y without any checks; used for the interior, where the loop vectorizes
+    slackX/Y()      how far past the grid's edge the node can read without checks: the planes' ghost cells, less the shifts applied
+                    on top of them. Where it is negative, assign() checks the border texels that deep
+Arithmetic is evaluated in the order it is written, so an expression gives the same bits as the equivalent scalar formula.
+*/
+
+template<class E>
+struct FieldExpr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+/**
+ * @brief Leaf; a read only view of a plane, either a Field or a raw pointer with its shape
+ */
+template<typename T>
+struct Plane : FieldExpr<Plane<T>> {
+    typedef T value_type;
+
+    struct Row {
+        const T* r;
+        T operator[](int x) const { return r[x]; }
+    };
+
+    Plane(const T* p, int rx, int ry, ptrdiff_t stride, int halo = 0) : p(p), rx(rx), ry(ry), stride(stride), halo(halo) {}
+    Plane(const Field<T>& f) : p(f.data()), rx(f.rx), ry(f.ry), stride(f.stride), halo(f.halo) {}
+
+    // reads the ghost cells within the halo, and 0 beyond it
+    T at(int x, int y) const {
+        if (x < -halo || y < -halo || x >= rx + halo || y >= ry + halo)
+            return T(0);
+        return p[y * stride + x];
+    }
+    Row row(int y) const { return Row{ p + y * stride }; }
+    int slackX() const { return halo; }
+    int slackY() const { return halo; }
+
+    const T* p;
+    int rx, ry;
+    ptrdiff_t stride;
+    int halo;
+};
+
+/**
+ * @brief e read DX texels to the right and DY texels up; the offsets are template arguments so the interior loads fold to fixed offsets
+ */
+template<class E, int DX, int DY>
+struct Shift : FieldExpr<Shift<E, DX, DY>> {
+    typedef typename E::value_type value_type;
+
+    struct Row {
+        typename E::Row r;
+        value_type operator[](int x) const { return r[x + DX]; }
+    };
+
+    explicit Shift(const E& e) : e(e) {}
+
+    value_type at(int x, int y) const { return e.at(x + DX, y + DY); }
+    Row row(int y) const { return Row{ e.row(y + DY) }; }
+    int slackX() const { return e.slackX() - (DX < 0 ? -DX : DX); }
+    int slackY() const { return e.slackY() - (DY < 0 ? -DY : DY); }
+
+    E e;
+};
+
+/**
+ * @brief Constant operand of an arithmetic node
+ */
+template<typename T>
+struct Scalar : FieldExpr<Scalar<T>> {
+    typedef T value_type;
+
+    struct Row {
+        T s;
+        T operator[](int) const { return s; }
+    };
+
+    explicit Scalar(T s) : s(s) {}
+
+    T at(int, int) const { return s; }
+    Row row(int) const { return Row{ s }; }
+    int slackX() const { return 1 << 20; }
+    int slackY() const { return 1 << 20; }
+
+    T s;
+};
+
+struct OpAdd { template<typename T> static T apply(T a, T b) { return a + b; } };
+struct OpSub { template<typename T> static T apply(T a, T b) { return a - b; } };
+struct OpMul { template<typename T> static T apply(T a, T b) { return a * b; } };
+struct OpDiv { template<typename T> static T apply(T a, T b) { return a / b; } };
+
+template<class A, class B, class Op>
+struct Binary : FieldExpr<Binary<A, B, Op>> {
+    typedef typename A::value_type value_type;
+
+    struct Row {
+        typename A::Row a;
+        typename B::Row b;
+        value_type operator[](int x) const { return Op::apply(a[x], b[x]); }
+    };
+
+    Binary(const A& a, const B& b) : a(a), b(b) {}
+
+    value_type at(int x, int y) const { return Op::apply(a.at(x, y), b.at(x, y)); }
+    Row row(int y) const { return Row{ a.row(y), b.row(y) }; }
+    int slackX() const { return a.slackX() < b.slackX() ? a.slackX() : b.slackX(); }
+    int slackY() const { return a.slackY() < b.slackY() ? a.slackY() : b.slackY(); }
+
+    A a;
+    B b;
+};
+
+template<class E> Shift<E, -1, 0> shiftL(const FieldExpr<E>& e) { return Shift<E, -1, 0>(e.self()); }
+template<class E> Shift<E, 1, 0> shiftR(const FieldExpr<E>& e) { return Shift<E, 1, 0>(e.self()); }
+template<class E> Shift<E, 0, -1> shiftB(const FieldExpr<E>& e) { return Shift<E, 0, -1>(e.self()); }
+template<class E> Shift<E, 0, 1> shiftT(const FieldExpr<E>& e) { return Shift<E, 0, 1>(e.self()); }
+
+// Fields take part in expressions through their Plane view
+template<typename T> Plane<T> expr(const Field<T>& f) { return Plane<T>(f); }
+template<typename T> Shift<Plane<T>, -1, 0> shiftL(const Field<T>& f) { return shiftL(Plane<T>(f)); }
+template<typename T> Shift<Plane<T>, 1, 0> shiftR(const Field<T>& f) { return shiftR(Plane<T>(f)); }
+template<typename T> Shift<Plane<T>, 0, -1> shiftB(const Field<T>& f) { return shiftB(Plane<T>(f)); }
+template<typename T> Shift<Plane<T>, 0, 1> shiftT(const Field<T>& f) { return shiftT(Plane<T>(f)); }
+
+#define FIELD_EXPR_OPERATOR(op, Op) \
+    template<class A, class B> \
+    Binary<A, B, Op> operator op(const FieldExpr<A>& a, const FieldExpr<B>& b) { return Binary<A, B, Op>(a.self(), b.self()); } \
+    template<class A> \
+    Binary<A, Scalar<typename A::value_type>, Op> operator op(const FieldExpr<A>& a, typename A::value_type s) { \
+        return Binary<A, Scalar<typename A::value_type>, Op>(a.self(), Scalar<typename A::value_type>(s)); } \
+    template<class B> \
+    Binary<Scalar<typename B::value_type>, B, Op> operator op(typename B::value_type s, const FieldExpr<B>& b) { \
+        return Binary<Scalar<typename B::value_type>, B, Op>(Scalar<typename B::value_type>(s), b.self()); }
+
+FIELD_EXPR_OPERATOR(+, OpAdd)
+FIELD_EXPR_OPERATOR(-, OpSub)
+FIELD_EXPR_OPERATOR(*, OpMul)
+FIELD_EXPR_OPERATOR(/, OpDiv)
+
+#undef FIELD_EXPR_OPERATOR
+
+/**
+ * @brief Evaluates e into rows [y0, y1) of an rx by ry plane; the destination must not be read by e (no in place stencils)
+ */
+template<typename T, class E>
+void assign(T* out, int rx, int ry, ptrdiff_t stride, const FieldExpr<E>& expr, int y0, int y1) {
+    const E& e = expr.self();
+    const int r = e.slackX() < 0 ? -e.slackX() : 0;
+    const int ry0 = e.slackY() < 0 ? -e.slackY() : 0;
+
+    for (int y = y0; y < y1; y ++) {
+        T* o = out + y * stride;
+        if (y < ry0 || y >= ry - ry0 || rx <= 2 * r) {
+            for (int x = 0; x < rx; x ++)
+                o[x] = e.at(x, y);
+            continue;
+        }
+
+        for (int x = 0; x < r; x ++)
+            o[x] = e.at(x, y);
+
+        // interior; every tap is in the grid or its ghost cells, and the cursor reduces to loads at fixed offsets that the compiler vectorizes
+        const typename E::Row c = e.row(y);
+        for (int x = r; x < rx - r; x ++)
+            o[x] = c[x];
+
+        for (int x = rx - r; x < rx; x ++)
+            o[x] = e.at(x, y);
+    }
+}
+
+template<typename T, class E>
+void assign(Field<T>& out, const FieldExpr<E>& e, int y0, int y1) {
+    assign(out.data(), out.rx, out.ry, out.stride, e, y0, y1);
+}
+
+template<typename T, class E>
+void assign(Field<T>& out, const FieldExpr<E>& e) {
+    assign(out.data(), out.rx, out.ry, out.stride, e, 0, out.ry);
+}
+
+#endif
@@ -0,0 +1,108 @@
+/**
+ * @file fieldStore.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief NUMA aware storage for the CPU engine's planes: first touched by the pool threads that sweep them, optionally on huge pages
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "fieldStore.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+FieldStore::FieldStore(Executor* pool, bool huge) : pool(pool), huge(huge), pages(huge ? PageKind::Huge : PageKind::Normal) {}
+
+FieldStore::~FieldStore() {
+    for (Plane& p : planes)
+        unmapPages(p.base, p.mapped);
+}
+
+void FieldStore::rowsOf(const Plane& p, int i, int threads, int& r0, int& r1) const {
+    r0 = i == 0 ? 0 : p.halo + (int)((long long)p.ry * i / threads);
+    r1 = i == threads - 1 ? p.ry + 2 * p.halo : p.halo + (int)((long long)p.ry * (i + 1) / threads);
+}
+
+/**
+ * @brief Maps bytes untouched, then zeroes each thread's rows from that thread
+ */
+void* FieldStore::place(const char* name, size_t bytes, size_t rowBytes, int ry, int halo) {
+    Plane p;
+    p.name = name;
+    p.bytes = bytes;
+    p.mapped = bytes;
+    p.rowBytes = rowBytes;
+    p.ry = ry;
+    p.halo = halo;
+
+    PageKind got;
+    p.base = (char*)mapPages(p.mapped, huge, &got);
+    pages = std::min(pages, got);
+
+    int threads = pool != NULL ? pool->size() : 1;
+    auto touch = [&](int i) {
+        int r0, r1;
+        rowsOf(p, i, threads, r0, r1);
+        if (r1 > r0)
+            memset(p.base + r0 * rowBytes, 0, (size_t)(r1 - r0) * rowBytes);
+    };
+    if (pool != NULL)
+        pool->runOnEach(touch);
+    else
+        touch(0);
+
+    planes.push_back(p);
+    return p.base;
+}
+
+void FieldStore::report(std::ostream& out) const {
+    int nodes = numaNodeCount();
+    int threads = pool != NULL ? pool->size() : 1;
+    bool pinned = pool != NULL && pool->getCpu(0) >= 0;
+
+    size_t total = 0;
+    for (const Plane& p : planes)
+        total += p.bytes;
+
+    char line[256];
+    snprintf(line, sizeof(line), "CPU fields: %d planes, %.1f MB on %s, %d NUMA node%s, %s threads\n", (int)planes.size(), total / 1048576.0,
+        pageKindName(pages), nodes, nodes > 1 ? "s" : "", pinned ? "pinned" : "unpinned");
+    out << line;
+
+    // on one node every page is local; nothing more to say
+    if (nodes < 2)
+        return;
+
+    std::vector<long long> perNode, part;
+    for (const Plane& p : planes) {
+        if (!pageNodes(p.base, p.bytes, perNode)) {
+            out << "    page placement unknown on this OS\n";
+            return;
+        }
+        long long resident = 0;
+        for (long long n : perNode)
+            resident += n;
+
+        int at = snprintf(line, sizeof(line), "    %-8s", p.name);
+        for (int n = 0; n < nodes && at < (int)sizeof(line); n ++)
+            at += snprintf(line + at, sizeof(line) - at, " node %d %5.1f%%", n, resident > 0 ? 100.0 * perNode[n] / resident : 0.0);
+
+        // pages on the node of the thread whose rows they hold; only meaningful if threads stay on their CPUs
+        if (pinned && at < (int)sizeof(line)) {
+            long long local = 0, counted = 0;
+            for (int i = 0; i < threads; i ++) {
+                int r0, r1;
+                rowsOf(p, i, threads, r0, r1);
+                if (r1 <= r0 || !pageNodes(p.base + r0 * p.rowBytes, (size_t)(r1 - r0) * p.rowBytes, part))
+                    continue;
+                int node = cpuNode(pool->getCpu(i));
+                for (int n = 0; n < nodes; n ++)
+                    counted += part[n];
+                local += part[node];
+            }
+            at += snprintf(line + at, sizeof(line) - at, "   local %5.1f%%", counted > 0 ? 100.0 * local / counted : 0.0);
+        }
+        out << line << "\n";
+    }
+}
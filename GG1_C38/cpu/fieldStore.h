@@ -0,0 +1,72 @@
+/**
+ * @file fieldStore.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief NUMA aware storage for the CPU engine's planes: first touched by the pool threads that sweep them, optionally on huge pages
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_FIELD_STORE_H
+#define CPU_FIELD_STORE_H
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "../../util/numa.h"
+#include "../../util/executor.h"
+#include "field.h"
+
+/*
+A Field allocated and zeroed by the thread constructing it has every page on that thread's node, so on a multi-socket machine half the
+pool sweeps its rows over the interconnect. Planes made here are mapped untouched instead and zeroed by the pool: thread i of T zeroes
+interior rows [ry * i / T, ry * (i + 1) / T) (thread 0 the ghost rows below, thread T - 1 those above), which is where parallelFor's
+contiguous dealing puts thread i's tiles whatever their height, so with a pinned pool (ThreadPool, numa.h) every row's pages sit on
+the node of the thread that computes it. Work stealing moves a few tiles per pass, not the bulk.
+
+report() prints, per plane, how its pages are spread over the nodes and what share of them is on the node of the thread owning their
+rows.
+*/
+
+class FieldStore {
+    public:
+        // pool may be NULL (everything touched by the calling thread); huge maps the planes on 2 MB pages where the OS allows
+        FieldStore(Executor* pool, bool huge);
+        ~FieldStore();
+
+        FieldStore(const FieldStore&) = delete;
+        FieldStore& operator=(const FieldStore&) = delete;
+
+        // a zeroed rx by ry plane, owned by the store; name labels it in report()
+        template<typename T>
+        Field<T> make(const char* name, int rx, int ry, int halo = 1) {
+            void* p = place(name, Field<T>::bytes(rx, ry, halo), sizeof(T) * fieldStride(rx, halo, sizeof(T)), ry, halo);
+            return Field<T>(rx, ry, halo, p);
+        }
+
+        void report(std::ostream& out) const;
+
+        // the least of what backs the planes
+        PageKind getPages() const { return pages; }
+
+    private:
+        struct Plane {
+            const char* name;
+            char* base;
+            size_t bytes, mapped;
+            size_t rowBytes;
+            int ry, halo;
+        };
+
+        void* place(const char* name, size_t bytes, size_t rowBytes, int ry, int halo);
+
+        // storage rows (ghost rows included) thread i of threads first touches
+        void rowsOf(const Plane& p, int i, int threads, int& r0, int& r1) const;
+
+        Executor* pool;
+        bool huge;
+        PageKind pages;
+        std::vector<Plane> planes;
+};
+
+#endif
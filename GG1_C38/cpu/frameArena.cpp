@@ -0,0 +1,128 @@
+/**
+ * @file frameArena.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Per frame bump allocator for the CPU engine's scratch buffers, one sub-arena per pool thread
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "frameArena.h"
+
+#include <algorithm>
+#include <cstring>
+
+/**
+ * @brief Construct a new FrameArena object
+ *
+ * @param threads Sub-arenas, one per thread that allocates (the pool's size)
+ * @param bytesPerThread Initial capacity of each; sub-arenas that spill grow at the next reset
+ * @param pool Pool whose thread i first touches sub-arena i; NULL touches them all from the calling thread
+ */
+FrameArena::FrameArena(int threads, size_t bytesPerThread, Executor* pool) : subs(threads < 1 ? 1 : threads), pool(pool), highWater(0),
+    frames(0), totalSpills(0), pages(PageKind::Huge) {
+    for (int t = 0; t < (int)subs.size(); t ++)
+        map(t, bytesPerThread);
+}
+
+FrameArena::~FrameArena() {
+    for (Sub& s : subs) {
+        for (void* p : s.spilled)
+            alignedFree(p);
+        unmap(s);
+    }
+}
+
+/**
+ * @brief Maps at least bytes for sub-arena thread, on huge pages if possible, and touches every page from that thread
+ */
+void FrameArena::map(int thread, size_t bytes) {
+    Sub& s = subs[thread];
+    size_t b = bytes;
+    PageKind got;
+    s.base = (char*)mapPages(b, true, &got);
+    s.capacity = b;
+    s.used = 0;
+    pages = std::min(pages, got);
+
+    // fault every page in now rather than in the first frames, on the node of the thread that will use it
+    auto touch = [&](int i) {
+        if (i == thread)
+            memset(s.base, 0, s.capacity);
+    };
+    if (pool != NULL && pool->size() == (int)subs.size())
+        pool->runOnEach(touch);
+    else
+        touch(thread);
+}
+
+void FrameArena::unmap(Sub& s) {
+    unmapPages(s.base, s.capacity);
+    s.base = NULL;
+    s.capacity = 0;
+}
+
+/**
+ * @brief Bump allocates from sub-arena thread, or from the heap if it is full
+ */
+void* FrameArena::alloc(int thread, size_t bytes) {
+    Sub& s = subs[thread];
+    size_t n = rounded(bytes);
+
+    void* p;
+    if (s.used + n <= s.capacity) {
+        p = s.base + s.used;
+        s.used += n;
+    } else {
+        p = alignedAlloc(n);
+        s.spilled.push_back(p);
+        s.spillBytes += n;
+    }
+    s.frameBytes = std::max(s.frameBytes, s.used + s.spillBytes);
+    return p;
+}
+
+/**
+ * @brief Frees the frame's allocations, and regrows every sub-arena that spilled to what the frame needed
+ */
+void FrameArena::reset() {
+    size_t frame = 0;
+    for (int t = 0; t < (int)subs.size(); t ++) {
+        Sub& s = subs[t];
+        if (!s.spilled.empty()) {
+            for (void* p : s.spilled)
+                alignedFree(p);
+            totalSpills += (long long)s.spilled.size();
+            s.spilled.clear();
+            unmap(s);
+            map(t, s.frameBytes);
+        }
+        frame += s.frameBytes;
+        s.used = 0;
+        s.spillBytes = 0;
+        s.frameBytes = 0;
+    }
+    highWater = std::max(highWater, frame);
+    frames ++;
+}
+
+void FrameArena::reserve(int thread, size_t bytes) {
+    Sub& s = subs[thread];
+    if (bytes <= s.capacity)
+        return;
+    unmap(s);
+    map(thread, bytes);
+}
+
+ArenaStats FrameArena::getStats() const {
+    ArenaStats st = {};
+    for (const Sub& s : subs) {
+        st.capacity += s.capacity;
+        st.used += s.frameBytes;
+        st.spills += (long long)s.spilled.size();
+    }
+    st.highWater = std::max(highWater, st.used);
+    st.frames = frames;
+    st.totalSpills = totalSpills + st.spills;
+    st.pages = pages;
+    return st;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file frameArena.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Per frame bump allocator for the CPU engine's scratch buffers, one sub-arena per pool thread
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_FRAME_ARENA_H
+#define CPU_FRAME_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+#include "../../util/numa.h"
+#include "../../util/executor.h"
+#include "field.h"
+
+/*
+Scratch that only lives for a frame (the divergence plane, the Jacobi solver's band buffers, per thread halo and staging rows) comes
+from here instead of the heap. Each pool thread bumps a pointer through its own sub-arena, so allocating takes no lock and scratch a
+thread writes stays in memory it alone touches; every allocation is FIELD_ALIGN aligned. reset() drops everything at once when the
+next frame starts, so the last frame's scratch stays readable in between.
+
+Sub-arenas are mapped up front, backed by huge pages where the OS grants them (2 MB pages cut TLB misses on the large planes), and
+touched once by their own threads, so frames take no page faults and each sub-arena sits on its thread's NUMA node. An allocation that does not fit is served by the heap and counted as a spill; reset() then
+regrows that sub-arena to the frame's high water mark, so from the next frame on steady state frames do no heap allocations at all,
+which getStats() lets callers confirm.
+*/
+
+struct ArenaStats {
+    size_t capacity;       // bytes mapped over all sub-arenas
+    size_t used;           // most bytes in use at once since the last reset, summed over sub-arenas, spills included
+    size_t highWater;      // most bytes any frame used
+    long long frames;      // resets so far
+    long long spills;      // allocations since the last reset that came from the heap
+    long long totalSpills; // spills over every frame
+    PageKind pages;        // the least of what backs the sub-arenas
+};
+
+class FrameArena {
+    public:
+        // threads sub-arenas of at least bytesPerThread each, touched first by the threads of pool (which should have threads threads)
+        FrameArena(int threads, size_t bytesPerThread, Executor* pool = NULL);
+        ~FrameArena();
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        // bytes from sub-arena thread; a thread may only allocate from its own sub-arena while a pass runs, the thread between passes
+        // from any
+        void* alloc(int thread, size_t bytes);
+        // from the calling pool thread's own sub-arena
+        void* alloc(size_t bytes) { return alloc(Executor::currentThread(), bytes); }
+
+        // an uninitialized Field view of rx by ry texels
+        template<typename T>
+        Field<T> field(int thread, int rx, int ry, int halo = 1) {
+            return Field<T>(rx, ry, halo, alloc(thread, Field<T>::bytes(rx, ry, halo)));
+        }
+
+        // position of a sub-arena, and a return to it, freeing everything allocated from it since
+        size_t mark(int thread) const { return subs[thread].used; }
+        void rewind(int thread, size_t m) { subs[thread].used = m; }
+
+        // frees every allocation; the start of a frame
+        void reset();
+
+        // grows sub-arena thread to at least bytes; only while nothing is allocated from it
+        void reserve(int thread, size_t bytes);
+
+        ArenaStats getStats() const;
+        int size() const { return (int)subs.size(); }
+
+        // bytes an allocation takes, alignment included
+        static size_t rounded(size_t bytes) { return (bytes + FIELD_ALIGN - 1) / FIELD_ALIGN * FIELD_ALIGN; }
+
+    private:
+        struct alignas(FIELD_ALIGN) Sub {
+            char* base = NULL;
+            size_t capacity = 0, used = 0;
+            size_t spillBytes = 0;
+            size_t frameBytes = 0; // used + spillBytes at their highest this frame
+            std::vector<void*> spilled;
+        };
+
+        void map(int thread, size_t bytes);
+        void unmap(Sub& s);
+
+        std::vector<Sub> subs;
+        Executor* pool;
+        size_t highWater;
+        long long frames, totalSpills;
+        PageKind pages;
+};
+
+/**
+ * @brief Frees what a scope allocated from a sub-arena when it ends, so passes can take per tile scratch without growing the frame's use
+ */
+class ArenaScope {
+    public:
+        ArenaScope(FrameArena& arena, int thread) : arena(arena), thread(thread), m(arena.mark(thread)) {}
+        ~ArenaScope() { arena.rewind(thread, m); }
+
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+
+    private:
+        FrameArena& arena;
+        int thread;
+        size_t m;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @file half.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief IEEE binary16 storage for CPU fields, the format of the GPU path's RGBA16F textures
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_HALF_H
+#define CPU_HALF_H
+
+#include <cstdint>
+#include <cstring>
+
+/*
+A Half is only a storage format: kernels convert it to float on load, compute in float and round back on store, like a fragment
+shader writing to an RGBA16F render target. The conversions here are the reference for the F16C / AVX-512 ones in the vector kernels
+(round to nearest even, denormals kept, overflow to infinity, nan stays nan), and give the same bits.
+*/
+
+typedef uint16_t Half;
+
+inline float halfToFloat(Half h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t e = (h >> 10) & 0x1f;
+    uint32_t m = h & 0x3ff;
+
+    uint32_t bits;
+    if (e == 0x1f) {
+        bits = sign | 0x7f800000 | (m << 13);
+    } else if (e != 0) {
+        bits = sign | ((e + 112) << 23) | (m << 13);
+    } else if (m == 0) {
+        bits = sign;
+    } else {
+        // denormal; normalize the mantissa
+        e = 113;
+        while (!(m & 0x400)) {
+            m <<= 1;
+            e --;
+        }
+        bits = sign | (e << 23) | ((m & 0x3ff) << 13);
+    }
+
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+inline Half floatToHalf(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t a = x & 0x7fffffff;
+
+    // infinity, and nan with its upper mantissa bits and the quiet bit set
+    if (a >= 0x7f800000)
+        return (Half)(sign | 0x7c00 | (a > 0x7f800000 ? 0x200 | ((a >> 13) & 0x3ff) : 0));
+    // 65520 and above round to infinity
+    if (a >= 0x477ff000)
+        return (Half)(sign | 0x7c00);
+
+    // below 2^-14: a denormal half in units of 2^-24, or 0 at and below 2^-25
+    if (a < 0x38800000) {
+        if (a <= 0x33000000)
+            return (Half)sign;
+        uint32_t m = (a & 0x7fffff) | 0x800000;
+        int shift = 126 - (int)(a >> 23);
+        uint32_t r = m >> shift, rem = m & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+        if (rem > halfway || (rem == halfway && (r & 1)))
+            r ++;
+        return (Half)(sign | r);
+    }
+
+    // rebias the exponent and round the mantissa to 10 bits; a carry moves into the exponent, which is still a correct encoding
+    uint32_t r = (a - 0x38000000) >> 13, rem = a & 0x1fff;
+    if (rem > 0x1000 || (rem == 0x1000 && (r & 1)))
+        r ++;
+    return (Half)(sign | r);
+}
+
+#endif
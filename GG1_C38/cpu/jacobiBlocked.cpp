@@ -0,0 +1,145 @@
+/**
+ * @file jacobiBlocked.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Temporally blocked Jacobi iteration for the pressure (prsStep.fs) and diffusion (difStep.fs) loops
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "jacobiBlocked.h"
+
+#include <algorithm>
+
+/**
+ * @brief Construct a new BlockedJacobi object
+ *
+ * @param rx X resolution of the fields
+ * @param ry Y resolution of the fields
+ * @param depth Iterations applied to a band while it is cache resident; 1 is plain iteration
+ * @param pool Executor bands are split over; NULL runs single threaded
+ * @param arena Arena with a sub-arena per pool thread that the scratch buffers come from; NULL makes one for the solver
+ * @param l2Bytes Cache budget of one thread's two scratch buffers, which sets the band height
+ */
+BlockedJacobi::BlockedJacobi(int rx, int ry, int depth, Executor* pool, FrameArena* arena, size_t l2Bytes) : rx(rx), ry(ry),
+    depth(depth < 1 ? 1 : depth), pool(pool), arena(arena), ownArena(arena == NULL) {
+    size_t rowBytes = fieldStride(rx, 1, sizeof(float)) * sizeof(float);
+
+    // scratch rows per buffer, of which 2 * depth are overlap; keep the overlap at most about a quarter of a band
+    int rows = (int)(l2Bytes / 2 / rowBytes);
+    bandRows = std::max(rows - 2 * this->depth, 8 * this->depth);
+    bandRows = std::min(bandRows, ry);
+
+    int threads = pool != NULL ? pool->size() : 1;
+    scratch.resize(2 * threads);
+    marks.resize(threads);
+    if (ownArena)
+        this->arena = new FrameArena(threads, scratchBytes(), pool);
+}
+
+BlockedJacobi::~BlockedJacobi() {
+    if (ownArena)
+        delete arena;
+}
+
+size_t BlockedJacobi::scratchBytes() {
+    return depth > 1 ? 2 * FrameArena::rounded(Field<float>::bytes(rx, bandRows + 2 * depth)) : 0;
+}
+
+void BlockedJacobi::solve(const StencilKernels& k, Field<float>& x, Field<float>& tmp, const Field<float>* b, const Grid& g, int iters, float alpha, float rbeta,
+    Border border) {
+    // the scratch buffers' ghost cells are always 0, so only Border::Zero can be blocked
+    int depth = border == Border::Zero ? this->depth : 1;
+
+    // every thread's buffers, taken here from its sub-arena so that tiles need not allocate
+    if (depth > 1) {
+        for (int t = 0; t < (int)marks.size(); t ++)
+            marks[t] = arena->mark(t);
+        takeScratch();
+    }
+
+    for (int done = 0; done < iters; ) {
+        int d = std::min(depth, iters - done);
+        x.fillHalo(border);
+
+        auto body = [&](int y0, int y1) {
+            band(k, x, tmp, b, g, y0, y1, d, alpha, rbeta);
+        };
+        if (pool != NULL)
+            pool->parallelFor(ry, bandRows, body);
+        else
+            for (int y = 0; y < ry; y += bandRows)
+                body(y, std::min(y + bandRows, ry));
+
+        x.swap(tmp);
+        done += d;
+    }
+
+    if (depth > 1)
+        for (int t = 0; t < (int)marks.size(); t ++)
+            arena->rewind(t, marks[t]);
+}
+
+void BlockedJacobi::bindScratch() {
+    if (depth > 1)
+        takeScratch();
+}
+
+/**
+ * @brief Two buffers per thread from its sub-arena, ghost cells 0
+ */
+void BlockedJacobi::takeScratch() {
+    for (int t = 0; t < (int)marks.size(); t ++) {
+        for (int i = 0; i < 2; i ++) {
+            scratch[2 * t + i] = arena->field<float>(t, rx, bandRows + 2 * depth);
+            scratch[2 * t + i].fillHalo(Border::Zero);
+        }
+    }
+}
+
+/**
+ * @brief Advances rows [y0, y1) of x by d iterations into out
+ */
+void BlockedJacobi::band(const StencilKernels& k, const Field<float>& x, Field<float>& out, const Field<float>* b, const Grid& g, int y0, int y1, int d, float alpha, float rbeta) {
+    // rows of x this band depends on, and a grid local to them. Local rows 0 and n - 1 only have their outer neighbors read where they
+    // are the real border, elsewhere they are never computed (each level shrinks by a row on both sides)
+    int Y0 = std::max(0, y0 - d);
+    int Y1 = std::min(ry, y1 + d);
+    Grid lg = g;
+    lg.ry = Y1 - Y0;
+
+    int t = pool != NULL ? Executor::currentThread() : 0;
+    float* buf[2] = { NULL, NULL };
+    if (d > 1) {
+        buf[0] = scratch[2 * t].data();
+        buf[1] = scratch[2 * t + 1].data();
+
+        // below the grid the levels read the buffers' ghost row; above it they read local row n, which is a real row of the buffer
+        // (possibly left over from another band) and has to act as the top ghost row
+        if (Y1 == ry) {
+            for (int i = 0; i < 2; i ++) {
+                Field<float>& f = scratch[2 * t + i];
+                std::fill(f.row(lg.ry) - f.halo, f.row(lg.ry) + rx + f.halo, 0.0f);
+            }
+        }
+    }
+
+    const float* src = x.row(Y0);
+    for (int s = 1; s <= d; s ++) {
+        int lo = std::max(Y0, y0 - d + s) - Y0;
+        int hi = std::min(Y1, y1 + d - s) - Y0;
+        float* dst = (s == d) ? out.row(Y0) : buf[s & 1];
+        const float* bc = (b != NULL) ? b->row(Y0) : src;
+
+        k.jacobi(dst, src, bc, lg, lo, hi, alpha, rbeta);
+        src = dst;
+    }
+}
+
+double BlockedJacobi::trafficRatio(bool hasB) {
+    // plain: every iteration reads x (and b) and writes the result. blocked: per depth iterations, x (and b) are read for the band
+    // plus the overlap recomputed by its neighbors (none at depth 1) and the result is written once
+    double overlap = (double)(bandRows + 2 * (depth - 1)) / bandRows;
+    double planes = hasB ? 3.0 : 2.0;
+    double blocked = ((hasB ? 2.0 : 1.0) * overlap + 1.0) / depth;
+    return blocked / planes;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file jacobiBlocked.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Temporally blocked Jacobi iteration for the pressure (prsStep.fs) and diffusion (difStep.fs) loops
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_JACOBI_BLOCKED_H
+#define CPU_JACOBI_BLOCKED_H
+
+#include <vector>
+
+#include "../../util/executor.h"
+#include "field.h"
+#include "frameArena.h"
+#include "stencil.h"
+
+/*
+Plain iteration streams the whole field through memory once per iteration. Here the rows are cut into bands, and each band runs
+depth iterations back to back in two cache resident scratch buffers before moving on (trapezoidal / overlapped tiling in y):
+
+    level 0 (x)     rows [y0 - depth, y1 + depth)
+    level 1         rows [y0 - depth + 1, y1 + depth - 1)
+    ...
+    level depth     rows [y0, y1)           -> written to the output field
+
+Each level needs one row of the level below on either side, so the band's rows shrink by one per level; neighboring bands
+recompute the overlap instead of exchanging it. At the grid's edges a level reads the ghost cells of x or of the scratch buffers, which
+hold 0; other border policies would need the ghost cells of every level refreshed, so they run unblocked. Every cell is computed with exactly the same inputs and operations as in plain
+iteration, so the result is bit identical, while x is read and the result written once per depth iterations instead of every iteration.
+*/
+
+class BlockedJacobi {
+    public:
+        // l2Bytes is the cache budget of the two scratch buffers of one thread, which come from arena (or one of the solver's own if NULL)
+        BlockedJacobi(int rx, int ry, int depth, Executor* pool = NULL, FrameArena* arena = NULL, size_t l2Bytes = 512 * 1024);
+        ~BlockedJacobi();
+
+        BlockedJacobi(const BlockedJacobi&) = delete;
+        BlockedJacobi& operator=(const BlockedJacobi&) = delete;
+
+        /**
+         * @brief Runs iters Jacobi iterations xNew = (xL + xR + xB + xT + alpha * bC) * rbeta, leaving the result in x
+         *
+         * @param b Right hand side; NULL uses the current iterate like difStep.fs does
+         * @param tmp Ping-pong partner of x, same size
+         * @param border Policy of x's ghost cells, refreshed before every pass over x
+         */
+        void solve(const StencilKernels& k, Field<float>& x, Field<float>& tmp, const Field<float>* b, const Grid& g, int iters, float alpha, float rbeta,
+            Border border = Border::Zero);
+
+        // estimated main memory traffic of a solve relative to plain iteration (about 1 / depth plus the band overlap)
+        double trafficRatio(bool hasB);
+
+        int getDepth() { return depth; }
+        int getBandRows() { return bandRows; }
+
+        // arena bytes a solve takes from each thread's sub-arena
+        size_t scratchBytes();
+
+        /**
+         * @brief Advances rows [y0, y1) of x by d <= getDepth() iterations into out, one band of a solve. For callers that schedule the
+         * bands themselves (e.g. as TaskGraph tiles of bandRows rows); x's ghost cells must hold 0, and d > 1 needs bindScratch() first
+         */
+        void band(const StencilKernels& k, const Field<float>& x, Field<float>& out, const Field<float>* b, const Grid& g, int y0, int y1, int d, float alpha, float rbeta);
+
+        // takes every thread's scratch buffers from the arena for band() calls outside solve(); they last until the arena's next reset
+        void bindScratch();
+
+    private:
+        void takeScratch();
+
+        int rx, ry, depth, bandRows;
+        Executor* pool;
+        FrameArena* arena;
+        bool ownArena;
+
+        // two scratch buffers per pool thread, views into their threads' sub-arenas during a solve, and where those sub-arenas stood before it
+        std::vector<Field<float>> scratch;
+        std::vector<size_t> marks;
+};
+
+#endif
@@ -0,0 +1,280 @@
+/**
+ * @file layout.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Alternative memory layouts for CPU fields (row major, square tiles, Morton / Z-order) behind one accessor interface
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_LAYOUT_H
+#define CPU_LAYOUT_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "field.h"
+
+/*
+Field keeps rows contiguous, so the xB and xT taps of a stencil are a whole row apart and a backtraced advection tap can land on any
+page. The layouts here keep 2D neighborhoods together instead:
+
+    RowLayout       texel (x, y) at y * stride + x; the same order as Field
+    TileLayout<T>   T x T tiles stored one after another, row major inside a tile; a tile of floats is 4 KB (T = 32) or 16 KB (T = 64)
+    MortonLayout    Z-order over a power of two square; every aligned 2^k x 2^k block is contiguous at every k
+
+Each layout provides
+    index(x, y)                 offset of texel (x, y) in storage; x and y must be in the grid
+    size()                      storage length in elements
+    forEachBlock(f)             calls f(x0, y0, x1, y1) for blocks covering the grid, in storage order, so that passes walk memory
+                                sequentially and the neighbors of a block are mostly in cache
+
+LayoutField<T, L> holds a plane in layout L; get(x, y) reads 0 outside the grid (GL_CLAMP_TO_BORDER with a black border, like the
+kernels in stencil.h) and at(x, y) reads without checks. The passes at the bottom are jacobi(), divergence(), gradient() and advect()
+written against these accessors only, so one template serves every layout; forEachTexel() tells them which texels are far enough
+from the border to use the unchecked reads. --bench-layouts compares the layouts (bench.h).
+*/
+
+enum class Layout { Row, Tile32, Tile64, Morton };
+
+inline const char* layoutName(Layout l) {
+    switch (l) {
+        case Layout::Tile32: return "tile 32";
+        case Layout::Tile64: return "tile 64";
+        case Layout::Morton: return "morton";
+        default: return "row";
+    }
+}
+
+struct RowLayout {
+    RowLayout(int rx, int ry) : rx(rx), ry(ry), stride(fieldStride(rx, 0, sizeof(float))) {}
+
+    size_t index(int x, int y) const { return (size_t)y * stride + x; }
+    size_t size() const { return (size_t)stride * ry; }
+
+    // bands of rows, about 16 KB each
+    template<class F>
+    void forEachBlock(F f) const {
+        int rows = (int)(16 * 1024 / (stride * sizeof(float)));
+        rows = rows < 1 ? 1 : rows;
+        for (int y = 0; y < ry; y += rows)
+            f(0, y, rx, y + rows < ry ? y + rows : ry);
+    }
+
+    int rx, ry;
+    ptrdiff_t stride;
+};
+
+template<int T>
+struct TileLayout {
+    TileLayout(int rx, int ry) : rx(rx), ry(ry), tilesX((rx + T - 1) / T), tilesY((ry + T - 1) / T) {}
+
+    // unsigned, so that the divisions by the constant T reduce to shifts and masks
+    size_t index(int x, int y) const {
+        unsigned ux = (unsigned)x, uy = (unsigned)y;
+        return ((size_t)(uy / T) * tilesX + (ux / T)) * (T * T) + (uy % T) * T + (ux % T);
+    }
+    size_t size() const { return (size_t)tilesX * tilesY * T * T; }
+
+    template<class F>
+    void forEachBlock(F f) const {
+        for (int ty = 0; ty < tilesY; ty ++) {
+            for (int tx = 0; tx < tilesX; tx ++) {
+                int x1 = (tx + 1) * T, y1 = (ty + 1) * T;
+                f(tx * T, ty * T, x1 < rx ? x1 : rx, y1 < ry ? y1 : ry);
+            }
+        }
+    }
+
+    int rx, ry, tilesX, tilesY;
+};
+
+struct MortonLayout {
+    // the grid is embedded in the smallest power of two square holding it
+    MortonLayout(int rx, int ry) : rx(rx), ry(ry), side(1) {
+        while (side < rx || side < ry)
+            side <<= 1;
+        for (int x = 0; x < rx; x ++)
+            dilatedX.push_back((size_t)spread((uint32_t)x));
+        for (int y = 0; y < ry; y ++)
+            dilatedY.push_back((size_t)spread((uint32_t)y) << 1);
+    }
+
+    // the interleaving is looked up per column and row rather than computed per tap
+    size_t index(int x, int y) const { return dilatedX[x] | dilatedY[y]; }
+    size_t size() const { return (size_t)side * side; }
+
+    // 16 x 16 blocks (1 KB of floats) in Z-order; blocks entirely outside the grid are skipped
+    template<class F>
+    void forEachBlock(F f) const {
+        const int B = side < 16 ? side : 16;
+        const int n = side / B;
+        for (uint64_t m = 0; m < (uint64_t)n * n; m ++) {
+            int bx = (int)compact(m) * B, by = (int)compact(m >> 1) * B;
+            if (bx >= rx || by >= ry)
+                continue;
+            f(bx, by, bx + B < rx ? bx + B : rx, by + B < ry ? by + B : ry);
+        }
+    }
+
+    // bit i of v moved to bit 2i
+    static uint64_t spread(uint32_t v) {
+        uint64_t x = v;
+        x = (x | (x << 16)) & 0x0000ffff0000ffffull;
+        x = (x | (x << 8)) & 0x00ff00ff00ff00ffull;
+        x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0full;
+        x = (x | (x << 2)) & 0x3333333333333333ull;
+        x = (x | (x << 1)) & 0x5555555555555555ull;
+        return x;
+    }
+
+    // the even bits of m packed together; inverse of spread
+    static uint32_t compact(uint64_t m) {
+        m &= 0x5555555555555555ull;
+        m = (m | (m >> 1)) & 0x3333333333333333ull;
+        m = (m | (m >> 2)) & 0x0f0f0f0f0f0f0f0full;
+        m = (m | (m >> 4)) & 0x00ff00ff00ff00ffull;
+        m = (m | (m >> 8)) & 0x0000ffff0000ffffull;
+        m = (m | (m >> 16)) & 0x00000000ffffffffull;
+        return (uint32_t)m;
+    }
+
+    int rx, ry, side;
+    std::vector<size_t> dilatedX, dilatedY;
+};
+
+/**
+ * @brief One channel plane of T stored in layout L. Storage is FIELD_ALIGN aligned, and texels of the layout outside the grid hold 0
+ */
+template<typename T, class L>
+class LayoutField {
+    public:
+        LayoutField(int rx, int ry) : rx(rx), ry(ry), layout(rx, ry) {
+            mem = (T*)alignedAlloc(sizeof(T) * layout.size());
+            for (size_t i = 0; i < layout.size(); i ++)
+                mem[i] = T(0);
+        }
+
+        ~LayoutField() {
+            alignedFree(mem);
+        }
+
+        LayoutField(const LayoutField&) = delete;
+        LayoutField& operator=(const LayoutField&) = delete;
+
+        // texel (x, y), 0 outside the grid
+        T get(int x, int y) const {
+            if (x < 0 || y < 0 || x >= rx || y >= ry)
+                return T(0);
+            return mem[layout.index(x, y)];
+        }
+        // texel (x, y), which must be in the grid
+        T at(int x, int y) const { return mem[layout.index(x, y)]; }
+        // get() if Checked, at() otherwise
+        template<bool Checked>
+        T tap(int x, int y) const {
+            if constexpr (Checked)
+                return get(x, y);
+            else
+                return at(x, y);
+        }
+        void set(int x, int y, T v) { mem[layout.index(x, y)] = v; }
+
+        // conversion from and to the row major Field the engine uses
+        void load(const Field<T>& f) {
+            for (int y = 0; y < ry; y ++)
+                for (int x = 0; x < rx; x ++)
+                    set(x, y, f.at(x, y));
+        }
+        void store(Field<T>& f) const {
+            for (int y = 0; y < ry; y ++)
+                for (int x = 0; x < rx; x ++)
+                    f.at(x, y) = get(x, y);
+        }
+
+        int rx, ry;
+        L layout;
+
+    private:
+        T* mem;
+};
+
+/**
+ * @brief Calls f(x, y, checked) for every texel of the grid, block by block in storage order. checked is std::true_type on the outermost
+ * ring of texels, whose neighbors may be outside the grid, and std::false_type everywhere else, so f can pick its accessors at compile time
+ */
+template<class L, class F>
+void forEachTexel(const L& layout, F f) {
+    const int rx = layout.rx, ry = layout.ry;
+    layout.forEachBlock([&](int x0, int y0, int x1, int y1) {
+        for (int y = y0; y < y1; y ++) {
+            if (y == 0 || y == ry - 1) {
+                for (int i = x0; i < x1; i ++)
+                    f(i, y, std::true_type());
+                continue;
+            }
+            int i = x0;
+            if (i == 0)
+                f(i ++, y, std::true_type());
+            int e = x1 == rx ? rx - 1 : x1;
+            for (; i < e; i ++)
+                f(i, y, std::false_type());
+            if (e < x1)
+                f(e, y, std::true_type());
+        }
+    });
+}
+
+/*
+Passes over any layout, visiting texels block by block in storage order. The formulas and their order of operations are those of
+stencilImpl.h, so every layout gives the same bits as the row major kernels.
+*/
+
+template<class L>
+void layoutJacobi(LayoutField<float, L>& out, const LayoutField<float, L>& x, const LayoutField<float, L>& b, float alpha, float rbeta) {
+    forEachTexel(out.layout, [&](int i, int y, auto checked) {
+        constexpr bool c = decltype(checked)::value;
+        float s = x.template tap<c>(i - 1, y) + x.template tap<c>(i + 1, y) + x.template tap<c>(i, y - 1) + x.template tap<c>(i, y + 1);
+        out.set(i, y, (s + alpha * b.at(i, y)) * rbeta);
+    });
+}
+
+template<class L>
+void layoutDivergence(LayoutField<float, L>& out, const LayoutField<float, L>& u, const LayoutField<float, L>& v, float scale) {
+    forEachTexel(out.layout, [&](int i, int y, auto checked) {
+        constexpr bool c = decltype(checked)::value;
+        out.set(i, y, scale * ((u.template tap<c>(i + 1, y) - u.template tap<c>(i - 1, y)) + (v.template tap<c>(i, y + 1) - v.template tap<c>(i, y - 1))));
+    });
+}
+
+template<class L>
+void layoutGradient(LayoutField<float, L>& outU, LayoutField<float, L>& outV, const LayoutField<float, L>& u, const LayoutField<float, L>& v,
+    const LayoutField<float, L>& p, float scale) {
+    forEachTexel(outU.layout, [&](int i, int y, auto checked) {
+        constexpr bool c = decltype(checked)::value;
+        outU.set(i, y, u.at(i, y) - scale * (p.template tap<c>(i + 1, y) - p.template tap<c>(i - 1, y)));
+        outV.set(i, y, v.at(i, y) - scale * (p.template tap<c>(i, y + 1) - p.template tap<c>(i, y - 1)));
+    });
+}
+
+// advect() with the four nearest neighbor taps around the backtraced texel, as in advectPoint; the taps are data dependent, so always checked
+template<class L>
+void layoutAdvect(LayoutField<float, L>& out, const LayoutField<float, L>& q, const LayoutField<float, L>& u, const LayoutField<float, L>& v,
+    float kx, float ky) {
+    // the range check comes first so the int conversion is defined (and nan reads 0), as in advectTap
+    auto tap = [&](float tx, float ty) {
+        if (!(tx >= 0.0f && tx < (float)q.rx && ty >= 0.0f && ty < (float)q.ry))
+            return 0.0f;
+        return q.at((int)tx, (int)ty);
+    };
+
+    forEachTexel(out.layout, [&](int i, int y, auto) {
+        float fx = std::floor((i + 0.5f) - kx * u.at(i, y));
+        float fy = std::floor((y + 0.5f) - ky * v.at(i, y));
+        out.set(i, y, ((tap(fx - 1.0f, fy) + tap(fx + 1.0f, fy)) + (tap(fx, fy - 1.0f) + tap(fx, fy + 1.0f))) * 0.25f);
+    });
+}
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @file lbmFluid.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief CPU lattice Boltzmann (D2Q9) engine, an alternative to CpuFluid's projection method with the same fields and dye passes
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "lbmFluid.h"
+
+#include <cmath>
+#include <iostream>
+
+/**
+ * @brief Construct a new LbmFluid object at rest (every population at its weight, density 1), selecting and validating the kernels
+ *
+ * @param rx X resolution of the fields
+ * @param ry Y resolution of the fields
+ * @param pool Executor the passes are split over (executor.h); NULL runs single threaded
+ */
+LbmFluid::LbmFluid(int rx, int ry, Executor* pool) : rx(rx), ry(ry), pool(pool) {
+    aspect = (float)rx / (float)ry;
+    kx = ky = 0.0f;
+    in = FluidInput();
+    present = NULL;
+
+    velU = Field<float>(rx, ry);
+    velV = Field<float>(rx, ry);
+    for (int c = 0; c < 3; c ++) {
+        qnt[c] = Field<float>(rx, ry);
+        nxtQnt[c] = Field<float>(rx, ry);
+    }
+    for (int i = 0; i < 9; i ++) {
+        f[i] = Field<float>(rx, ry);
+        nxtF[i] = Field<float>(rx, ry);
+        f[i].fill(LBM_W[i]);
+        nxtF[i].fill(LBM_W[i]);
+    }
+
+    grid.rx = rx;
+    grid.ry = ry;
+    grid.stride = velU.stride;
+
+    // tiles of rows whose eighteen population rows fit in a slice of L2
+    tileRows = (int)(64 * 1024 / (grid.stride * sizeof(float) * 18));
+    if (tileRows < 2)
+        tileRows = 2;
+
+    kernels = &selectKernels(rx, velU.stride);
+    std::cout << "CPU stencils: max deviation from scalar reference " << validateKernels(*kernels) << "\n";
+    lattice = &selectLatticeKernels();
+    std::cout << "CPU lattice stencils: max deviation from scalar reference " << validateLatticeKernels(*lattice) << "\n";
+}
+
+void LbmFluid::forRows(FnRef<void(int, int)> f) {
+    if (pool != NULL)
+        pool->parallelFor(ry, tileRows, f);
+    else
+        f(0, ry);
+}
+
+/**
+ * @brief The dye passes of the GPU path, the force, then substeps collide and stream sweeps; only the last writes the velocity
+ */
+void LbmFluid::step(const FluidInput& in) {
+    this->in = in;
+    kx = in.dt * aspect * rx;
+    ky = in.dt * aspect * ry;
+
+    advectionStep();
+    forceStep();
+
+    // substeps lattice steps move the dye kx * u texels, so u = substeps * (lattice velocity) / kx; nothing moves while dt is 0
+    float sx = kx > 0.0f ? substeps / kx : 0.0f;
+    float sy = ky > 0.0f ? substeps / ky : 0.0f;
+    float omega = 1.0f / tau;
+    for (int s = 0; s < substeps; s ++) {
+        bounceBack();
+        const float* src[9];
+        float* dst[9];
+        for (int i = 0; i < 9; i ++) {
+            src[i] = f[i].data();
+            dst[i] = nxtF[i].data();
+        }
+        bool last = s == substeps - 1;
+        forRows([&](int y0, int y1) {
+            lattice->collideStream(dst, src, last ? velU.data() : NULL, last ? velV.data() : NULL, grid, y0, y1, omega, sx, sy);
+        });
+        for (int i = 0; i < 9; i ++)
+            f[i].swap(nxtF[i]);
+    }
+}
+
+/**
+ * @brief advStep.fs, as CpuFluid::advectionStep
+ */
+void LbmFluid::advectionStep() {
+    const float* q[3] = { qnt[0].data(), qnt[1].data(), qnt[2].data() };
+    float* out[3] = { nxtQnt[0].data(), nxtQnt[1].data(), nxtQnt[2].data() };
+
+    forRows([&](int y0, int y1) {
+        kernels->advect(out, q, 3, velU.data(), velV.data(), grid, y0, y1, 0, rx, kx, ky);
+        for (int y = y0; y < y1; y ++) {
+            float* r[3] = { nxtQnt[0].row(y), nxtQnt[1].row(y), nxtQnt[2].row(y) };
+            splatTexels(in, rx, ry, r, y, 0, rx);
+        }
+    });
+
+    for (int c = 0; c < 3; c ++)
+        qnt[c].swap(nxtQnt[c]);
+}
+
+/**
+ * @brief frcStep.fs on the lattice: the force in uv units per second, (relx, rely) / res * FORCEMULT / dist, is kx / substeps texels per
+ * lattice step per uv unit per second, like the velocity
+ */
+void LbmFluid::forceStep() {
+    if (!in.mDown || substeps <= 0)
+        return;
+    float fx = in.relx / rx * CPU_FORCEMULT * (kx / substeps);
+    float fy = in.rely / ry * CPU_FORCEMULT * (ky / substeps);
+    float* p[9];
+    for (int i = 0; i < 9; i ++)
+        p[i] = f[i].data();
+
+    forRows([&](int y0, int y1) {
+        lattice->kick(p, grid, y0, y1, fx, fy, in.mx / rx, in.my / ry, maxSpeed);
+    });
+}
+
+/**
+ * @brief Fills the ghost cells the next step pulls from with what the walls send back: the population that would stream in from
+ * outside is the opposite one leaving the texel, so ghost g of f[i] gets f[opp(i)] at g + c_i. The ring is small, so this runs serially
+ */
+void LbmFluid::bounceBack() {
+    auto reflect = [&](int x, int y) {
+        for (int i = 1; i < 9; i ++) {
+            int sx = x + LBM_CX[i], sy = y + LBM_CY[i];
+            if (sx >= 0 && sx < rx && sy >= 0 && sy < ry)
+                f[i].at(x, y) = f[LBM_OPP[i]].at(sx, sy);
+        }
+    };
+    for (int x = -1; x <= rx; x ++) {
+        reflect(x, -1);
+        reflect(x, ry);
+    }
+    for (int y = 0; y < ry; y ++) {
+        reflect(-1, y);
+        reflect(rx, y);
+    }
+}
+
+double LbmFluid::latticeSpeed() const {
+    double top = 0.0;
+    for (int y = 0; y < ry; y ++) {
+        for (int x = 0; x < rx; x ++) {
+            float rho = 0.0f, mx = 0.0f, my = 0.0f;
+            for (int i = 0; i < 9; i ++) {
+                float p = f[i].at(x, y);
+                rho += p;
+                mx += LBM_CX[i] * p;
+                my += LBM_CY[i] * p;
+            }
+            top = std::fmax(top, std::sqrt((double)mx * mx + (double)my * my) / rho);
+        }
+    }
+    return top;
+}
+
+void LbmFluid::writeQuantity(float* rgba) const {
+    for (int y = 0; y < ry; y ++) {
+        const float* r = qnt[0].row(y);
+        const float* g = qnt[1].row(y);
+        const float* b = qnt[2].row(y);
+        float* o = rgba + (size_t)y * rx * 4;
+        for (int x = 0; x < rx; x ++) {
+            o[4 * x + 0] = r[x];
+            o[4 * x + 1] = g[x];
+            o[4 * x + 2] = b[x];
+            o[4 * x + 3] = 1.0f;
+        }
+    }
+}
+
+void LbmFluid::presentQuantity(uint32_t* pixels, int pitch) {
+    if (present == NULL) {
+        present = &selectPresentKernels();
+        std::cout << "CPU presentation: max deviation from scalar reference " << validatePresentKernels(*present) << "\n";
+    }
+
+    forRows([&](int y0, int y1) {
+        for (int y = y0; y < y1; y ++) {
+            const float* q[3] = { qnt[0].row(y), qnt[1].row(y), qnt[2].row(y) };
+            present->present((uint32_t*)((char*)pixels + (size_t)(ry - 1 - y) * pitch), q, rx);
+        }
+    });
+}
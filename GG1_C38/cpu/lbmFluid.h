@@ -0,0 +1,89 @@
+/**
+ * @file lbmFluid.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief CPU lattice Boltzmann (D2Q9) engine, an alternative to CpuFluid's projection method with the same fields and dye passes
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_LBM_FLUID_H
+#define CPU_LBM_FLUID_H
+
+#include "../../util/executor.h"
+#include "cpuFluid.h"
+#include "field.h"
+#include "stencil.h"
+
+// mirror math/lattice.fs
+const float CPU_LBM_TAU = 0.6f;
+const int CPU_LBM_SUBSTEPS = 4;
+const float CPU_LBM_MAXSPEED = 0.2f;
+
+/*
+The projection method spends most of a frame in its Poisson solves, 60 Jacobi sweeps that each need the whole grid of the sweep before.
+A lattice Boltzmann step only reads the nine neighbors of a texel once: every texel streams in its nine populations and relaxes them
+towards equilibrium (LatticeFn, stencil.h), so a step is one sweep whose memory traffic is fixed at nine planes in and nine out.
+
+The lattice runs substeps steps per frame, whatever dt, and writes its velocity into velU / velV in the units advect() reads, so that
+the dye advection and splat of advStep.fs run on it unchanged and the dye moves substeps lattice steps' worth of cells per frame.
+The mouse force is frcStep.fs, turned into lattice units and applied once per frame by moving each texel's populations to the
+equilibrium of the kicked velocity (the exact difference method), with the kicked speed capped at maxSpeed lattice units to keep the
+flow well below the lattice's speed of sound. The walls are no slip, by half way bounce back, where the projection method reads 0.
+*/
+
+class LbmFluid {
+    public:
+        // pool splits the rows, NULL runs single threaded
+        LbmFluid(int rx, int ry, Executor* pool = NULL);
+
+        LbmFluid(const LbmFluid&) = delete;
+        LbmFluid& operator=(const LbmFluid&) = delete;
+
+        // advances one frame: the dye advection and splat, the force, and substeps lattice steps
+        void step(const FluidInput& in);
+
+        // writes the dye as rx * ry RGBA texels (e.g. into a StreamBuffer slot)
+        void writeQuantity(float* rgba) const;
+
+        // writes the dye as rx * ry RGBA8 pixels, as CpuFluid::presentQuantity
+        void presentQuantity(uint32_t* pixels, int pitch);
+
+        int getRX() { return rx; }
+        int getRY() { return ry; }
+
+        // the largest lattice speed, in cells per step; stays below maxSpeed while the flow is stable
+        double latticeSpeed() const;
+
+        // the relaxation time, which sets the lattice viscosity (tau - 0.5) / 3; above 0.5
+        float tau = CPU_LBM_TAU;
+        int substeps = CPU_LBM_SUBSTEPS;
+        float maxSpeed = CPU_LBM_MAXSPEED;
+
+        // the engine's fields, as CpuFluid's; the velocity is the last lattice step's
+        Field<float> velU, velV, qnt[3];
+
+    private:
+        void advectionStep();
+        void forceStep();
+        void bounceBack();
+
+        // runs f over row tiles on the pool (or serially without one)
+        void forRows(FnRef<void(int, int)> f);
+
+        int rx, ry;
+        Executor* pool;
+        int tileRows;
+        float aspect, kx, ky;
+        FluidInput in;
+
+        const StencilKernels* kernels;
+        const LatticeKernels* lattice;
+        const PresentKernels* present; // selected on the first presentQuantity
+        Grid grid;
+
+        // the populations and their ping-pong partners, f[i] moving along (LBM_CX[i], LBM_CY[i])
+        Field<float> f[9], nxtF[9];
+        Field<float> nxtQnt[3];
+};
+
+#endif
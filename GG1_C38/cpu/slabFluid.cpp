@@ -0,0 +1,232 @@
+/**
+ * @file slabFluid.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief One rank of the CPU engine decomposed into slabs of rows over several processes, exchanging halo rows after every stencil pass
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "slabFluid.h"
+
+#include <algorithm>
+#include <iostream>
+
+void slabRows(int ry, int ranks, int rank, int* y0, int* y1) {
+    *y0 = (int)((long long)ry * rank / ranks);
+    *y1 = (int)((long long)ry * (rank + 1) / ranks);
+}
+
+/**
+ * @brief Construct a new SlabFluid object for link's rank
+ */
+SlabFluid::SlabFluid(int rx, int ry, HaloTransport* link, Executor* pool, int advHalo) : rx(rx), ry(ry), advHalo(advHalo < 1 ? 1 : advHalo),
+    link(link), pool(pool) {
+    int y1;
+    slabRows(ry, link->ranks(), link->rank(), &y0, &y1);
+    rows = y1 - y0;
+    below = link->rank() > 0 ? link->rank() - 1 : -1;
+    above = link->rank() + 1 < link->ranks() ? link->rank() + 1 : -1;
+
+    delx = 1.0f / rx;
+    aspect = (float)rx / (float)ry;
+    in = FluidInput();
+
+    // every plane has the advection's halo, so that all planes of a kernel call share one stride
+    int h = this->advHalo;
+    velU = Field<float>(rx, rows, h); velV = Field<float>(rx, rows, h);
+    nxtU = Field<float>(rx, rows, h); nxtV = Field<float>(rx, rows, h);
+    prs = Field<float>(rx, rows, h); nxtPrs = Field<float>(rx, rows, h);
+    div = Field<float>(rx, rows, h);
+    for (int c = 0; c < 3; c ++) {
+        qnt[c] = Field<float>(rx, rows, h);
+        nxtQnt[c] = Field<float>(rx, rows, h);
+    }
+
+    grid.rx = rx;
+    grid.ry = rows;
+    grid.stride = velU.stride;
+    tileRows = (int)(64 * 1024 / (grid.stride * sizeof(float) * 4));
+    if (tileRows < 2)
+        tileRows = 2;
+
+    // the planes' stride is that of a halo h field, so this is the generic table unless h is 1
+    kernels = &selectKernels(rx, grid.stride);
+    if (rows < 2)
+        std::cout << "slab of rank " << link->rank() << " has " << rows << " rows; slabs need at least 2\n";
+}
+
+void SlabFluid::forRows(int r0, int r1, FnRef<void(int, int)> f) {
+    if (r1 <= r0)
+        return;
+    if (pool != NULL)
+        pool->parallelFor(r1 - r0, tileRows, [&](int a, int b) { f(r0 + a, r0 + b); });
+    else
+        f(r0, r1);
+}
+
+void SlabFluid::postHalo(Field<float>* const* f, int n) {
+    size_t bytes = rx * sizeof(float);
+    for (int i = 0; i < n; i ++) {
+        if (below >= 0)
+            link->send(below, f[i]->row(0), bytes);
+        if (above >= 0)
+            link->send(above, f[i]->row(rows - 1), bytes);
+    }
+}
+
+void SlabFluid::waitHalo(Field<float>* const* f, int n) {
+    size_t bytes = rx * sizeof(float);
+    for (int i = 0; i < n; i ++) {
+        if (below >= 0)
+            link->recv(below, f[i]->row(-1), bytes);
+        if (above >= 0)
+            link->recv(above, f[i]->row(rows), bytes);
+    }
+}
+
+void SlabFluid::exchangeRows(Field<float>* const* f, int n, int depth) {
+    size_t bytes = rx * sizeof(float);
+    depth = std::min(depth, rows);
+    for (int i = 0; i < n; i ++) {
+        for (int k = 0; k < depth; k ++) {
+            if (below >= 0)
+                link->send(below, f[i]->row(k), bytes);
+            if (above >= 0)
+                link->send(above, f[i]->row(rows - 1 - k), bytes);
+            if (below >= 0)
+                link->recv(below, f[i]->row(-1 - k), bytes);
+            if (above >= 0)
+                link->recv(above, f[i]->row(rows + k), bytes);
+        }
+    }
+}
+
+void SlabFluid::exchangeAround(Field<float>* const* f, int n, FnRef<void(int, int)> body) {
+    postHalo(f, n);
+    if (!overlap) {
+        waitHalo(f, n);
+        forRows(0, rows, body);
+        return;
+    }
+    forRows(1, rows - 1, body);
+    waitHalo(f, n);
+    body(0, 1);
+    body(rows - 1, rows);
+}
+
+void SlabFluid::step(const FluidInput& input) {
+    in = input;
+    advectionStep();
+    forceStep();
+    diffusionStep();
+    divergenceStep();
+    pressureStep();
+    gradientStep();
+}
+
+/**
+ * @brief advStep.fs. The kernel sees the slab and its ghost rows as one grid of rows + 2 * advHalo rows, placed at their rows of the whole
+ * grid (Grid::oy) so the backtraces round like CpuFluid's; taps into the ghost rows read the neighbors' dye and taps beyond them read 0
+ */
+void SlabFluid::advectionStep() {
+    Field<float>* q3[3] = { &qnt[0], &qnt[1], &qnt[2] };
+    exchangeRows(q3, 3, advHalo);
+
+    float kx = in.dt * aspect * rx;
+    float ky = in.dt * aspect * ry;
+    int h = advHalo;
+    Grid g = grid;
+    g.ry = rows + 2 * h;
+    g.oy = y0 - h;
+    const float* q[3] = { qnt[0].row(-h), qnt[1].row(-h), qnt[2].row(-h) };
+    float* out[3] = { nxtQnt[0].row(-h), nxtQnt[1].row(-h), nxtQnt[2].row(-h) };
+
+    forRows(0, rows, [&](int r0, int r1) {
+        kernels->advect(out, q, 3, velU.row(-h), velV.row(-h), g, r0 + h, r1 + h, 0, rx, kx, ky);
+        for (int y = r0; y < r1; y ++) {
+            float* r[3] = { nxtQnt[0].row(y), nxtQnt[1].row(y), nxtQnt[2].row(y) };
+            splatTexels(in, rx, ry, r, y0 + y, 0, rx);
+        }
+    });
+
+    for (int c = 0; c < 3; c ++)
+        qnt[c].swap(nxtQnt[c]);
+}
+
+/**
+ * @brief frcStep.fs
+ */
+void SlabFluid::forceStep() {
+    if (!in.mDown)
+        return;
+    forRows(0, rows, [&](int r0, int r1) {
+        for (int y = r0; y < r1; y ++)
+            forceTexels(in, rx, ry, velU.row(y), velV.row(y), y0 + y, 0, rx);
+    });
+}
+
+/**
+ * @brief difStep.fs iterated difIters times, u and v side by side so that each iteration exchanges both in one round
+ */
+void SlabFluid::diffusionStep() {
+    float alpha = delx * delx / (CPU_VISCOSITY * in.dt);
+    float rbeta = 1 / (4 + alpha);
+    for (int i = 0; i < difIters; i ++) {
+        Field<float>* f[2] = { &velU, &velV };
+        exchangeAround(f, 2, [&](int r0, int r1) {
+            kernels->jacobi(nxtU.data(), velU.data(), velU.data(), grid, r0, r1, alpha, rbeta);
+            kernels->jacobi(nxtV.data(), velV.data(), velV.data(), grid, r0, r1, alpha, rbeta);
+        });
+        velU.swap(nxtU);
+        velV.swap(nxtV);
+    }
+}
+
+/**
+ * @brief divStep.fs; u is only read along rows, so only v is exchanged
+ */
+void SlabFluid::divergenceStep() {
+    Field<float>* f[1] = { &velV };
+    exchangeAround(f, 1, [&](int r0, int r1) {
+        kernels->divergence(div.data(), velU.data(), velV.data(), grid, r0, r1, aspect * 0.5f);
+    });
+}
+
+/**
+ * @brief prsStep.fs iterated prsIters times, warm started from the previous frame's pressure
+ */
+void SlabFluid::pressureStep() {
+    float alpha = -(delx * delx);
+    float rbeta = 0.25f;
+    for (int i = 0; i < prsIters; i ++) {
+        Field<float>* f[1] = { &prs };
+        exchangeAround(f, 1, [&](int r0, int r1) {
+            kernels->jacobi(nxtPrs.data(), prs.data(), div.data(), grid, r0, r1, alpha, rbeta);
+        });
+        prs.swap(nxtPrs);
+    }
+}
+
+/**
+ * @brief grdStep.fs
+ */
+void SlabFluid::gradientStep() {
+    Field<float>* f[1] = { &prs };
+    exchangeAround(f, 1, [&](int r0, int r1) {
+        kernels->gradient(nxtU.data(), nxtV.data(), velU.data(), velV.data(), prs.data(), grid, r0, r1, aspect * 0.5f);
+    });
+    velU.swap(nxtU);
+    velV.swap(nxtV);
+}
+
+void SlabFluid::writeQuantity(float* rgba) const {
+    for (int y = 0; y < rows; y ++) {
+        float* o = rgba + ((size_t)(y0 + y) * rx) * 4;
+        for (int x = 0; x < rx; x ++) {
+            o[4 * x + 0] = qnt[0].at(x, y);
+            o[4 * x + 1] = qnt[1].at(x, y);
+            o[4 * x + 2] = qnt[2].at(x, y);
+            o[4 * x + 3] = 1.0f;
+        }
+    }
+}
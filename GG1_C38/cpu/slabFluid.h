@@ -0,0 +1,112 @@
+/**
+ * @file slabFluid.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief One rank of the CPU engine decomposed into slabs of rows over several processes, exchanging halo rows after every stencil pass
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_SLAB_FLUID_H
+#define CPU_SLAB_FLUID_H
+
+#include "../../util/executor.h"
+#include "../../util/haloTransport.h"
+#include "cpuFluid.h"
+#include "field.h"
+#include "stencil.h"
+
+/*
+The rx by ry grid is cut into ranks() slabs of whole rows, rank r owning rows [y0, y0 + rows) (slabRows). Each rank keeps its rows in
+Fields whose ghost rows hold copies of its neighbors' edge rows, and runs the same six passes as CpuFluid over them, with Border::Zero:
+
+    advection      the three dye planes' advHalo rows next to each edge are exchanged first; a backtrace that reaches further than
+                   advHalo rows into a neighbor reads 0 there instead of the neighbor's dye (so keep dt * |v| * ry under advHalo)
+    force          local
+    diffusion      every iteration exchanges the edge row of u and v
+    divergence     exchanges the edge row of v
+    pressure       every iteration exchanges the edge row of the pressure
+    gradient       exchanges the edge row of the pressure
+
+The ghost rows at the top and bottom of the grid are never written, so they read 0 like CpuFluid's. Every exchange is overlapped with
+computation: a rank sends its edge rows, computes its interior rows, which do not read the ghost rows, and only then waits for its
+neighbors' rows and computes its two edge rows. Every pass does the same operations on the same inputs as CpuFluid's, so the slabs
+match the single process engine bit for bit as long as no backtrace leaves the advection's halo.
+*/
+
+/**
+ * @brief Rows [y0, y1) of an ry row grid that rank of ranks owns
+ */
+void slabRows(int ry, int ranks, int rank, int* y0, int* y1);
+
+class SlabFluid {
+    public:
+        /**
+         * @param rx X resolution of the whole grid
+         * @param ry Y resolution of the whole grid; every slab needs at least 2 rows
+         * @param link This rank's transport; its rank and ranks pick the slab
+         * @param pool Executor the passes over the slab are split over; NULL runs single threaded
+         * @param advHalo Rows of dye exchanged for the advection
+         */
+        SlabFluid(int rx, int ry, HaloTransport* link, Executor* pool = NULL, int advHalo = 16);
+
+        SlabFluid(const SlabFluid&) = delete;
+        SlabFluid& operator=(const SlabFluid&) = delete;
+
+        // advances one frame; every rank has to step with the same input
+        void step(const FluidInput& in);
+
+        // writes the slab's dye as RGBA texels into rows [y0, y0 + rows) of an rx * ry RGBA image
+        void writeQuantity(float* rgba) const;
+
+        int getY0() { return y0; }
+        int getRows() { return rows; }
+
+        int difIters = 20;
+        int prsIters = 40;
+
+        // whether each exchange overlaps the interior rows; false waits for the ghost rows before computing any (for comparison)
+        bool overlap = true;
+
+        // the slab; row y is row y0 + y of the grid
+        Field<float> velU, velV, prs, div, qnt[3];
+
+    private:
+        void advectionStep();
+        void forceStep();
+        void diffusionStep();
+        void divergenceStep();
+        void pressureStep();
+        void gradientStep();
+
+        // sends the edge rows of the n planes f to the neighbors, and receives theirs into f's ghost rows
+        void postHalo(Field<float>* const* f, int n);
+        void waitHalo(Field<float>* const* f, int n);
+
+        // the depth rows next to each edge, a row at a time in both directions so that the rings never hold more than one row per plane
+        void exchangeRows(Field<float>* const* f, int n, int depth);
+
+        /**
+         * @brief Exchanges the edge row of the n planes f around body: body(y0, y1) is run over the interior rows while the rows are in
+         * flight, then over the two edge rows once they have arrived (all rows after the exchange if overlap is off)
+         */
+        void exchangeAround(Field<float>* const* f, int n, FnRef<void(int, int)> body);
+
+        // runs f over row tiles of rows [r0, r1) on the pool (or serially without one)
+        void forRows(int r0, int r1, FnRef<void(int, int)> f);
+
+        int rx, ry, y0, rows, advHalo;
+        HaloTransport* link;
+        Executor* pool;
+        int below, above; // neighbor ranks, -1 at the edges of the grid
+        int tileRows;
+        float delx, aspect;
+        FluidInput in;
+
+        const StencilKernels* kernels;
+        Grid grid;
+
+        // ping-pong partners
+        Field<float> nxtU, nxtV, nxtPrs, nxtQnt[3];
+};
+
+#endif
@@ -0,0 +1,616 @@
+/**
+ * @file stencil.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Instruction set detection, kernel selection and validation against the scalar reference
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "stencil.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "field.h"
+
+#ifdef STENCIL_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// reads an environment variable, empty if unset (getenv is flagged as unsafe by msvc's sdl checks)
+static std::string envVar(const char* name) {
+#ifdef _MSC_VER
+    char* buf = NULL;
+    size_t len = 0;
+    if (_dupenv_s(&buf, &len, name) != 0 || buf == NULL)
+        return "";
+    std::string s = buf;
+    free(buf);
+    return s;
+#else
+    const char* s = std::getenv(name);
+    return s == NULL ? "" : s;
+#endif
+}
+
+#ifdef STENCIL_X86
+static void cpuid(int leaf, int sub, unsigned int r[4]) {
+#ifdef _MSC_VER
+    int out[4];
+    __cpuidex(out, leaf, sub);
+    for (int i = 0; i < 4; i ++)
+        r[i] = (unsigned int)out[i];
+#else
+    __cpuid_count(leaf, sub, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+// register state enabled by the operating system
+static unsigned long long xgetbv0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+#endif
+
+/**
+ * @brief Detects the widest supported instruction set. AVX2 and AVX-512 also require the operating system to save the wider registers,
+ * and AVX2 requires F16C (every AVX2 cpu has it), which its half storage kernels use
+ */
+Isa detectIsa() {
+#ifdef STENCIL_X86
+    unsigned int r[4];
+    cpuid(0, 0, r);
+    unsigned int maxLeaf = r[0];
+
+    cpuid(1, 0, r);
+    bool sse42 = (r[2] >> 20) & 1;
+    bool osxsave = (r[2] >> 27) & 1;
+    bool avx = (r[2] >> 28) & 1;
+    bool f16c = (r[2] >> 29) & 1;
+    if (!sse42)
+        return Isa::Scalar;
+
+    unsigned long long xcr0 = osxsave ? xgetbv0() : 0;
+    bool ymm = avx && (xcr0 & 0x6) == 0x6;
+    bool zmm = ymm && (xcr0 & 0xe0) == 0xe0;
+    if (!ymm || maxLeaf < 7)
+        return Isa::SSE42;
+
+    cpuid(7, 0, r);
+    bool avx2 = (r[1] >> 5) & 1;
+    bool avx512f = (r[1] >> 16) & 1;
+    if (avx512f && zmm)
+        return Isa::AVX512;
+    if (avx2 && f16c)
+        return Isa::AVX2;
+    return Isa::SSE42;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::SSE42: return "SSE4.2";
+        case Isa::AVX2: return "AVX2";
+        case Isa::AVX512: return "AVX-512";
+        default: return "scalar";
+    }
+}
+
+/**
+ * @brief Gets the kernels of an instruction set, falling back to the best supported one below it
+ *
+ * @param rx Width of the planes the kernels will run on; with stride, picks a table compiled for that width if there is one
+ * @param stride Row stride of the planes; specialized tables require that of a halo 1 Field of width rx
+ */
+const StencilKernels& getKernels(Isa isa, int rx, ptrdiff_t stride) {
+    static const Isa best = detectIsa();
+    if ((int)isa > (int)best)
+        isa = best;
+    if (stride != fieldStride(rx, 1, sizeof(float)))
+        rx = 0;
+
+    switch (isa) {
+#ifdef STENCIL_X86
+        case Isa::AVX512: return avx512Kernels(rx);
+        case Isa::AVX2: return avx2Kernels(rx);
+        case Isa::SSE42: return sse42Kernels(rx);
+#endif
+        default: return exprKernels();
+    }
+}
+
+/**
+ * @brief Gets the half storage kernels of an instruction set, falling back to the best supported one below it
+ */
+const HalfKernels& getHalfKernels(Isa isa) {
+    static const Isa best = detectIsa();
+    if ((int)isa > (int)best)
+        isa = best;
+
+    switch (isa) {
+#ifdef STENCIL_X86
+        case Isa::AVX512: return avx512HalfKernels();
+        case Isa::AVX2: return avx2HalfKernels();
+        case Isa::SSE42: return sse42HalfKernels();
+#endif
+        default: return scalarHalfKernels();
+    }
+}
+
+/**
+ * @brief Gets the ensemble kernels of an instruction set, falling back to the best supported one below it
+ */
+const EnsembleKernels& getEnsembleKernels(Isa isa) {
+    static const Isa best = detectIsa();
+    if ((int)isa > (int)best)
+        isa = best;
+
+    switch (isa) {
+#ifdef STENCIL_X86
+        case Isa::AVX512: return avx512EnsembleKernels();
+        case Isa::AVX2: return avx2EnsembleKernels();
+        case Isa::SSE42: return sse42EnsembleKernels();
+#endif
+        default: return scalarEnsembleKernels();
+    }
+}
+
+/**
+ * @brief Gets the lattice Boltzmann step of an instruction set, falling back to the best supported one below it
+ */
+const LatticeKernels& getLatticeKernels(Isa isa) {
+    static const Isa best = detectIsa();
+    if ((int)isa > (int)best)
+        isa = best;
+
+    switch (isa) {
+#ifdef STENCIL_X86
+        case Isa::AVX512: return avx512LatticeKernels();
+        case Isa::AVX2: return avx2LatticeKernels();
+        case Isa::SSE42: return sse42LatticeKernels();
+#endif
+        default: return scalarLatticeKernels();
+    }
+}
+
+/**
+ * @brief Gets the presentation form of an instruction set, falling back to the best supported one below it
+ */
+const PresentKernels& getPresentKernels(Isa isa) {
+    static const Isa best = detectIsa();
+    if ((int)isa > (int)best)
+        isa = best;
+
+    switch (isa) {
+#ifdef STENCIL_X86
+        case Isa::AVX512: return avx512PresentKernels();
+        case Isa::AVX2: return avx2PresentKernels();
+        case Isa::SSE42: return sse42PresentKernels();
+#endif
+        default: return scalarPresentKernels();
+    }
+}
+
+// the instruction set cap from GG1_ISA; AVX-512 (no cap) if unset
+static Isa requestedIsa() {
+    Isa isa = Isa::AVX512;
+
+    std::string name = envVar("GG1_ISA");
+    if (!name.empty()) {
+        if (name == "scalar") isa = Isa::Scalar;
+        else if (name == "sse42") isa = Isa::SSE42;
+        else if (name == "avx2") isa = Isa::AVX2;
+        else if (name != "avx512")
+            std::cout << "GG1_ISA=" << name << " not recognized (scalar, sse42, avx2, avx512)\n";
+    }
+    return isa;
+}
+
+/**
+ * @brief Selects the kernels for this run (best detected, capped by GG1_ISA) and prints which instruction set was picked
+ */
+const StencilKernels& selectKernels(int rx, ptrdiff_t stride) {
+    const StencilKernels& k = getKernels(requestedIsa(), rx, stride);
+    std::cout << "CPU stencils: " << isaName(k.isa) << " (detected " << isaName(detectIsa()) << ")";
+    if (k.width != 0)
+        std::cout << ", specialized for width " << k.width;
+    std::cout << "\n";
+    return k;
+}
+
+/**
+ * @brief Selects the half storage kernels for this run, like selectKernels
+ */
+const HalfKernels& selectHalfKernels() {
+    const HalfKernels& k = getHalfKernels(requestedIsa());
+    std::cout << "CPU half stencils: " << isaName(k.isa) << " (detected " << isaName(detectIsa()) << ")\n";
+    return k;
+}
+
+/**
+ * @brief Selects the ensemble kernels for this run, like selectKernels
+ */
+const EnsembleKernels& selectEnsembleKernels() {
+    const EnsembleKernels& k = getEnsembleKernels(requestedIsa());
+    std::cout << "CPU ensemble stencils: " << isaName(k.isa) << ", " << k.width << " lanes per register (detected " << isaName(detectIsa()) << ")\n";
+    return k;
+}
+
+/**
+ * @brief Selects the lattice Boltzmann step for this run, like selectKernels
+ */
+const LatticeKernels& selectLatticeKernels() {
+    const LatticeKernels& k = getLatticeKernels(requestedIsa());
+    std::cout << "CPU lattice stencils: " << isaName(k.isa) << " (detected " << isaName(detectIsa()) << ")\n";
+    return k;
+}
+
+/**
+ * @brief Selects the presentation form for this run, like selectKernels
+ */
+const PresentKernels& selectPresentKernels() {
+    const PresentKernels& k = getPresentKernels(requestedIsa());
+    std::cout << "CPU presentation: " << isaName(k.isa) << " (detected " << isaName(detectIsa()) << ")\n";
+    return k;
+}
+
+/**
+ * @brief Runs every kernel of k and of the scalar reference on the same inputs and returns the largest absolute difference.
+ * Velocities are large enough to backtrace advection taps out of the grid, so the border handling is covered too, and the constants
+ * are not powers of two, so a product rounds differently when it is fused into an fma
+ *
+ * @param k Kernels to validate
+ * @param rx Width of the test planes; odd by default so vector loops have scalar tails and read the right ghost column. Ignored for specialized kernels, which run at their width
+ * @param ry Height of the test planes
+ */
+float validateKernels(const StencilKernels& k, int rx, int ry) {
+    const StencilKernels& ref = scalarKernels();
+
+    if (k.width != 0)
+        rx = k.width;
+
+    // halo 1 planes with zero ghost cells, which the reference's bounds checks read as 0 too
+    Field<float> u(rx, ry), v(rx, ry), p(rx, ry), b(rx, ry), q0(rx, ry), q1(rx, ry);
+    Field<float> a0(rx, ry), a1(rx, ry), r0(rx, ry), r1(rx, ry);
+    Grid g = { rx, ry, u.stride };
+
+    // fixed linear congruential sequence so every run validates the same data
+    unsigned int seed = 12345;
+    auto rnd = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+    };
+
+    for (int y = 0; y < ry; y ++) {
+        for (int x = 0; x < rx; x ++) {
+            u.at(x, y) = rnd(); v.at(x, y) = rnd(); p.at(x, y) = rnd(); b.at(x, y) = rnd(); q0.at(x, y) = rnd(); q1.at(x, y) = rnd();
+        }
+    }
+
+    float maxDiff = 0.0f;
+    auto compare = [&]() {
+        for (int y = 0; y < ry; y ++) {
+            for (int x = 0; x < rx; x ++) {
+                maxDiff = std::fmax(maxDiff, std::fabs(a0.at(x, y) - r0.at(x, y)));
+                maxDiff = std::fmax(maxDiff, std::fabs(a1.at(x, y) - r1.at(x, y)));
+            }
+        }
+    };
+
+    k.jacobi(a0.data(), p.data(), b.data(), g, 0, ry, -0.3f, 0.21f);
+    ref.jacobi(r0.data(), p.data(), b.data(), g, 0, ry, -0.3f, 0.21f);
+    compare();
+
+    k.divergence(a0.data(), u.data(), v.data(), g, 0, ry, 0.7f);
+    ref.divergence(r0.data(), u.data(), v.data(), g, 0, ry, 0.7f);
+    compare();
+
+    k.gradient(a0.data(), a1.data(), u.data(), v.data(), p.data(), g, 0, ry, 0.7f);
+    ref.gradient(r0.data(), r1.data(), u.data(), v.data(), p.data(), g, 0, ry, 0.7f);
+    compare();
+
+    for (int y = 0; y < ry; y ++) {
+        k.jacobiRow(a0.row(y), p.row(y), p.row(y - 1), p.row(y + 1), b.row(y), rx, -0.3f, 0.21f);
+        ref.jacobi(r0.data(), p.data(), b.data(), g, y, y + 1, -0.3f, 0.21f);
+
+        k.divergenceRow(a1.row(y), u.row(y), v.row(y - 1), v.row(y + 1), rx, 0.7f);
+        ref.divergence(r1.data(), u.data(), v.data(), g, y, y + 1, 0.7f);
+    }
+    compare();
+
+    const float* q[2] = { q0.data(), q1.data() };
+    float* a[2] = { a0.data(), a1.data() };
+    float* r[2] = { r0.data(), r1.data() };
+    k.advect(a, q, 2, u.data(), v.data(), g, 0, ry, 0, rx, 0.3f * rx, 0.3f * ry);
+    ref.advect(r, q, 2, u.data(), v.data(), g, 0, ry, 0, rx, 0.3f * rx, 0.3f * ry);
+    compare();
+
+    return maxDiff;
+}
+
+/**
+ * @brief validateKernels for the half storage kernels; also converts values around every rounding boundary of the format (ties,
+ * overflow, denormals, infinities) with toHalf and back, and returns infinity if the bits differ from the reference conversions
+ */
+float validateHalfKernels(const HalfKernels& k, int rx, int ry) {
+    const HalfKernels& ref = scalarHalfKernels();
+
+    Field<Half> u(rx, ry), v(rx, ry), p(rx, ry), b(rx, ry), q0(rx, ry), q1(rx, ry);
+    Field<Half> a0(rx, ry), a1(rx, ry), r0(rx, ry), r1(rx, ry);
+    Grid g = { rx, ry, u.stride };
+
+    unsigned int seed = 12345;
+    auto rnd = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+    };
+
+    for (int y = 0; y < ry; y ++) {
+        for (int x = 0; x < rx; x ++) {
+            u.at(x, y) = floatToHalf(rnd()); v.at(x, y) = floatToHalf(rnd()); p.at(x, y) = floatToHalf(rnd());
+            b.at(x, y) = floatToHalf(rnd()); q0.at(x, y) = floatToHalf(rnd()); q1.at(x, y) = floatToHalf(rnd());
+        }
+    }
+
+    float maxDiff = 0.0f;
+    auto compare = [&]() {
+        for (int y = 0; y < ry; y ++) {
+            for (int x = 0; x < rx; x ++) {
+                maxDiff = std::fmax(maxDiff, std::fabs(halfToFloat(a0.at(x, y)) - halfToFloat(r0.at(x, y))));
+                maxDiff = std::fmax(maxDiff, std::fabs(halfToFloat(a1.at(x, y)) - halfToFloat(r1.at(x, y))));
+            }
+        }
+    };
+
+    k.jacobi(a0.data(), p.data(), b.data(), g, 0, ry, -0.3f, 0.21f);
+    ref.jacobi(r0.data(), p.data(), b.data(), g, 0, ry, -0.3f, 0.21f);
+    compare();
+
+    k.divergence(a0.data(), u.data(), v.data(), g, 0, ry, 0.7f);
+    ref.divergence(r0.data(), u.data(), v.data(), g, 0, ry, 0.7f);
+    compare();
+
+    k.gradient(a0.data(), a1.data(), u.data(), v.data(), p.data(), g, 0, ry, 0.7f);
+    ref.gradient(r0.data(), r1.data(), u.data(), v.data(), p.data(), g, 0, ry, 0.7f);
+    compare();
+
+    const Half* q[2] = { q0.data(), q1.data() };
+    Half* a[2] = { a0.data(), a1.data() };
+    Half* r[2] = { r0.data(), r1.data() };
+    k.advect(a, q, 2, u.data(), v.data(), g, 0, ry, 0, rx, 0.3f * rx, 0.3f * ry);
+    ref.advect(r, q, 2, u.data(), v.data(), g, 0, ry, 0, rx, 0.3f * rx, 0.3f * ry);
+    compare();
+
+    // the largest half, halfway to 65536 and past it, the smallest normal and denormal and the ties and halfway points around them
+    std::vector<float> vals = { 0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 65519.0f, 65520.0f, 1e6f, 6.1035156e-5f, 6.0e-5f, 5.9604645e-8f,
+        2.9802322e-8f, 2.98023259e-8f, 8.940697e-8f, 1.0009766f, 1.0004883f, 1.0014648f, INFINITY, -INFINITY, 0.1f, 3.14159f, -1e-7f };
+    while (vals.size() % 64 != 3)
+        vals.push_back(rnd() * 100.0f);
+    std::vector<Half> h(vals.size()), hr(vals.size());
+    std::vector<float> back(vals.size());
+    k.toHalf(h.data(), vals.data(), (int)vals.size());
+    ref.toHalf(hr.data(), vals.data(), (int)vals.size());
+    k.fromHalf(back.data(), h.data(), (int)vals.size());
+    for (size_t i = 0; i < vals.size(); i ++) {
+        float e = halfToFloat(hr[i]);
+        if (h[i] != hr[i] || memcmp(&back[i], &e, sizeof(float)) != 0)
+            maxDiff = INFINITY;
+    }
+
+    return maxDiff;
+}
+
+/**
+ * @brief validateKernels for the ensemble kernels, on planes of lanes interleaved instances with different coefficients per lane. The
+ * default lane count is no multiple of any register width, so every table runs its scalar tail as well
+ */
+float validateEnsembleKernels(const EnsembleKernels& k, int rx, int ry, int lanes) {
+    const EnsembleKernels& ref = scalarEnsembleKernels();
+
+    int K = lanes;
+    Field<float> u(rx * K, ry, K), v(rx * K, ry, K), p(rx * K, ry, K), b(rx * K, ry, K), q0(rx * K, ry, K), q1(rx * K, ry, K);
+    Field<float> a0(rx * K, ry, K), a1(rx * K, ry, K), r0(rx * K, ry, K), r1(rx * K, ry, K);
+    Grid g = { rx, ry, u.stride };
+
+    unsigned int seed = 12345;
+    auto rnd = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+    };
+
+    for (int y = 0; y < ry; y ++) {
+        for (int x = 0; x < rx * K; x ++) {
+            u.at(x, y) = rnd(); v.at(x, y) = rnd(); p.at(x, y) = rnd(); b.at(x, y) = rnd(); q0.at(x, y) = rnd(); q1.at(x, y) = rnd();
+        }
+    }
+    std::vector<float> alpha(K), rbeta(K), kx(K), ky(K);
+    for (int i = 0; i < K; i ++) {
+        alpha[i] = -0.3f + 0.05f * i;
+        rbeta[i] = 1 / (4 + alpha[i]);
+        kx[i] = (0.1f + 0.03f * i) * rx;
+        ky[i] = (0.1f + 0.03f * i) * ry;
+    }
+
+    float maxDiff = 0.0f;
+    auto compare = [&]() {
+        for (int y = 0; y < ry; y ++) {
+            for (int x = 0; x < rx * K; x ++) {
+                maxDiff = std::fmax(maxDiff, std::fabs(a0.at(x, y) - r0.at(x, y)));
+                maxDiff = std::fmax(maxDiff, std::fabs(a1.at(x, y) - r1.at(x, y)));
+            }
+        }
+    };
+
+    k.jacobi(a0.data(), p.data(), b.data(), g, K, 0, ry, alpha.data(), rbeta.data());
+    ref.jacobi(r0.data(), p.data(), b.data(), g, K, 0, ry, alpha.data(), rbeta.data());
+    compare();
+
+    k.divergence(a0.data(), u.data(), v.data(), g, K, 0, ry, 0.7f);
+    ref.divergence(r0.data(), u.data(), v.data(), g, K, 0, ry, 0.7f);
+    compare();
+
+    k.gradient(a0.data(), a1.data(), u.data(), v.data(), p.data(), g, K, 0, ry, 0.7f);
+    ref.gradient(r0.data(), r1.data(), u.data(), v.data(), p.data(), g, K, 0, ry, 0.7f);
+    compare();
+
+    const float* q[2] = { q0.data(), q1.data() };
+    float* a[2] = { a0.data(), a1.data() };
+    float* r[2] = { r0.data(), r1.data() };
+    k.advect(a, q, 2, u.data(), v.data(), g, K, 0, ry, kx.data(), ky.data());
+    ref.advect(r, q, 2, u.data(), v.data(), g, K, 0, ry, kx.data(), ky.data());
+    compare();
+
+    // the force on copies of the velocity, over a run of lanes that starts and ends mid register, with the mouse close to some texels
+    std::vector<float> ox(K), oy(K);
+    for (int i = 0; i < K; i ++) {
+        ox[i] = (i % 5 + 0.25f) / rx;
+        oy[i] = 0.3f * i / K;
+    }
+    for (int y = 0; y < ry; y ++) {
+        for (int x = 0; x < rx * K; x ++) {
+            a0.at(x, y) = r0.at(x, y) = u.at(x, y);
+            a1.at(x, y) = r1.at(x, y) = v.at(x, y);
+        }
+    }
+    for (int y = 0; y < ry; y ++) {
+        k.force(a0.data(), a1.data(), g, K, y, 1, K - 1, kx.data(), ky.data(), ox.data(), oy.data());
+        ref.force(r0.data(), r1.data(), g, K, y, 1, K - 1, kx.data(), ky.data(), ox.data(), oy.data());
+    }
+    compare();
+
+    return maxDiff;
+}
+
+/**
+ * @brief validateKernels for the lattice Boltzmann step, on populations spread around their rest weights so that every texel moves
+ * and the density is not 1, with pseudo random ghost cells; once with the velocity written and once without, then the kick
+ */
+float validateLatticeKernels(const LatticeKernels& k, int rx, int ry) {
+    const LatticeKernels& ref = scalarLatticeKernels();
+
+    Field<float> f[9], a[9], r[9];
+    for (int i = 0; i < 9; i ++) {
+        f[i] = Field<float>(rx, ry);
+        a[i] = Field<float>(rx, ry);
+        r[i] = Field<float>(rx, ry);
+    }
+    Field<float> au(rx, ry), av(rx, ry), ru(rx, ry), rv(rx, ry);
+    Grid g = { rx, ry, f[0].stride };
+
+    unsigned int seed = 12345;
+    auto rnd = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1 << 24) * 2.0f - 1.0f;
+    };
+
+    for (int i = 0; i < 9; i ++)
+        for (int y = -1; y <= ry; y ++)
+            for (int x = -1; x <= rx; x ++)
+                f[i].at(x, y) = LBM_W[i] * (1.0f + 0.3f * rnd());
+
+    const float* fp[9];
+    float* ap[9];
+    float* rp[9];
+    for (int i = 0; i < 9; i ++) {
+        fp[i] = f[i].data();
+        ap[i] = a[i].data();
+        rp[i] = r[i].data();
+    }
+
+    float maxDiff = 0.0f;
+    auto compare = [&](const Field<float>& x, const Field<float>& y) {
+        for (int j = 0; j < ry; j ++)
+            for (int i = 0; i < rx; i ++)
+                maxDiff = std::fmax(maxDiff, std::fabs(x.at(i, j) - y.at(i, j)));
+    };
+
+    k.collideStream(ap, fp, au.data(), av.data(), g, 0, ry, 1.0f / 0.61f, 0.7f, 1.3f);
+    ref.collideStream(rp, fp, ru.data(), rv.data(), g, 0, ry, 1.0f / 0.61f, 0.7f, 1.3f);
+    for (int i = 0; i < 9; i ++)
+        compare(a[i], r[i]);
+    compare(au, ru);
+    compare(av, rv);
+
+    k.collideStream(ap, fp, NULL, NULL, g, 0, ry, 1.7f, 0.0f, 0.0f);
+    ref.collideStream(rp, fp, NULL, NULL, g, 0, ry, 1.7f, 0.0f, 0.0f);
+    for (int i = 0; i < 9; i ++)
+        compare(a[i], r[i]);
+
+    // the kick on the results, with the mouse between texels and a force that reaches the speed cap near it but not far off
+    k.kick(ap, g, 0, ry, 0.003f, -0.002f, 10.25f / rx, 20.25f / ry, 0.2f);
+    ref.kick(rp, g, 0, ry, 0.003f, -0.002f, 10.25f / rx, 20.25f / ry, 0.2f);
+    for (int i = 0; i < 9; i ++)
+        compare(a[i], r[i]);
+
+    return maxDiff;
+}
+
+/**
+ * @brief validateKernels for the presentation form, on channels around and outside [0, 1] (infinities and nans included) and on every
+ * exact 8 bit value and the point half way above it, from float and from half planes; the largest difference of any channel, in 8 bit steps
+ */
+float validatePresentKernels(const PresentKernels& k, int n) {
+    const PresentKernels& ref = scalarPresentKernels();
+
+    unsigned int seed = 12345;
+    auto rnd = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1 << 24) * 2.0f - 0.5f;
+    };
+
+    float maxDiff = 0.0f;
+    std::vector<float> q[3];
+    std::vector<Half> h[3];
+    std::vector<uint32_t> a(n), r(n);
+    auto compare = [&]() {
+        for (int x = 0; x < n; x ++)
+            for (int c = 0; c < 32; c += 8)
+                maxDiff = std::fmax(maxDiff, (float)std::abs((int)((a[x] >> c) & 0xff) - (int)((r[x] >> c) & 0xff)));
+    };
+
+    for (int pass = 0; pass < 8; pass ++) {
+        for (int c = 0; c < 3; c ++) {
+            q[c].resize(n);
+            h[c].resize(n);
+            for (int x = 0; x < n; x ++) {
+                int i = (pass * n + x) * 3 + c;
+                if (pass < 2)
+                    q[c][x] = rnd();
+                else if (i % 256 == 0)
+                    q[c][x] = (i & 512) ? INFINITY : -INFINITY;
+                else if (i % 256 == 1)
+                    q[c][x] = NAN;
+                else
+                    q[c][x] = (i % 256 + (c == 1 ? 0.5f : 0.0f)) / 255.0f;
+                h[c][x] = floatToHalf(q[c][x]);
+            }
+        }
+        const float* fp[3] = { q[0].data(), q[1].data(), q[2].data() };
+        const Half* hp[3] = { h[0].data(), h[1].data(), h[2].data() };
+
+        k.present(a.data(), fp, n);
+        ref.present(r.data(), fp, n);
+        compare();
+
+        k.presentHalf(a.data(), hp, n);
+        ref.presentHalf(r.data(), hp, n);
+        compare();
+    }
+
+    return maxDiff;
+}
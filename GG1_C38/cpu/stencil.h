@@ -0,0 +1,252 @@
+/**
+ * @file stencil.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief CPU versions of jacobi(), divergence(), gradient() and advect() (stencilSpec.h, math/stencils.fs), with runtime ISA dispatch
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_STENCIL_H
+#define CPU_STENCIL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "half.h"
+
+/*
+All kernels work on one channel planes of floats in texel units, and only write rows [y0, y1) (columns [0, rx)) so that callers can
+split a pass into row tiles. The fixed stencils can run on a window of columns by offsetting the plane pointers and narrowing rx, since
+they read the real texels next to the window; advection, whose taps are bounds checked against the grid, takes its columns
+[x0, x1) as arguments instead.
+
+Planes are Fields with at least one ghost cell on every side (field.h), and the fixed stencils (jacobi, divergence, gradient) read
+their taps outside the grid from the ghost cells without any checks; whatever the ghost cells hold is the border. With
+Border::Zero this matches GL_CLAMP_TO_BORDER with the black border used by TexturePair. Advection taps land anywhere, so they
+stay bounds checked and read 0 outside the grid.
+
+Texel (x, y) of a plane is at row y (bottom up) and column x, the fragment at uv = ((x + 0.5) / rx, (y + 0.5) / ry).
+*/
+
+/**
+ * @brief Shape of the planes passed to a kernel; every plane of a call has this width, height and row stride, and a halo of at least 1
+ */
+struct Grid {
+    int rx, ry;
+    ptrdiff_t stride;
+    int oy = 0; // row of a larger grid that row 0 of the planes is (a slab's, see slabFluid.h); advection backtraces from that row's position
+};
+
+// xNew = (xL + xR + xB + xT + alpha * bC) * rbeta
+typedef void (*JacobiFn)(float* out, const float* x, const float* b, const Grid& g, int y0, int y1, float alpha, float rbeta);
+
+// div = scale * ((uR - uL) + (vT - vB)), scale = (res.x / res.y) * 0.5
+typedef void (*DivergenceFn)(float* out, const float* u, const float* v, const Grid& g, int y0, int y1, float scale);
+
+// (u, v) -= scale * (pR - pL, pT - pB), scale = (res.x / res.y) * 0.5
+typedef void (*GradientFn)(float* outU, float* outV, const float* u, const float* v, const float* p, const Grid& g, int y0, int y1, float scale);
+
+// backtraces every texel of columns [x0, x1) by (kx * u, ky * v) texels, and averages the four nearest neighbor taps of each of the nq
+// quantity planes around it
+typedef void (*AdvectFn)(float* const* out, const float* const* q, int nq, const float* u, const float* v, const Grid& g, int y0, int y1, int x0, int x1,
+    float kx, float ky);
+
+/*
+Single row forms of jacobi and divergence, taking the neighboring rows by pointer so that a caller can feed them from a small ring of
+rows instead of whole planes (see CpuFluid's fused passes). Every row needs its ghost columns, and rows outside the grid are passed
+as the plane's ghost rows.
+*/
+
+// one row of JacobiFn; xc, xb, xt are rows y, y - 1, y + 1 of x and bc row y of b
+typedef void (*JacobiRowFn)(float* out, const float* xc, const float* xb, const float* xt, const float* bc, int rx, float alpha, float rbeta);
+
+// one row of DivergenceFn; uc is row y of u, vb and vt rows y - 1 and y + 1 of v
+typedef void (*DivergenceRowFn)(float* out, const float* uc, const float* vb, const float* vt, int rx, float scale);
+
+/*
+Half storage forms (CpuOptions::half): the same kernels on planes of Halfs, loading through F16C (AVX2) or AVX-512 conversions where
+available. Arithmetic stays in float and in the same order, so a half kernel gives exactly the float result rounded to half.
+Grid::stride is in elements, that of Field<Half>.
+*/
+
+typedef void (*JacobiHalfFn)(Half* out, const Half* x, const Half* b, const Grid& g, int y0, int y1, float alpha, float rbeta);
+typedef void (*DivergenceHalfFn)(Half* out, const Half* u, const Half* v, const Grid& g, int y0, int y1, float scale);
+typedef void (*GradientHalfFn)(Half* outU, Half* outV, const Half* u, const Half* v, const Half* p, const Grid& g, int y0, int y1, float scale);
+typedef void (*AdvectHalfFn)(Half* const* out, const Half* const* q, int nq, const Half* u, const Half* v, const Grid& g, int y0, int y1, int x0, int x1,
+    float kx, float ky);
+
+// n texels between float and half
+typedef void (*ToHalfFn)(Half* out, const float* in, int n);
+typedef void (*FromHalfFn)(float* out, const Half* in, int n);
+
+/*
+Ensemble forms (ensembleFluid.h): planes holding K instances of a simulation interleaved per texel, lane k of texel (x, y) at
+y * stride + x * K + k, so that W consecutive floats are W instances of one texel and every vector lane runs the same stencil on its own
+instance. Grid::rx is the width in texels and Grid::stride is in floats, that of a Field of width rx * K with a halo of K (whose ghost
+cells are the K lanes of a ghost texel). Coefficients that may differ between instances are arrays of K, one per lane.
+*/
+
+typedef void (*JacobiLanesFn)(float* out, const float* x, const float* b, const Grid& g, int lanes, int y0, int y1, const float* alpha, const float* rbeta);
+typedef void (*DivergenceLanesFn)(float* out, const float* u, const float* v, const Grid& g, int lanes, int y0, int y1, float scale);
+typedef void (*GradientLanesFn)(float* outU, float* outV, const float* u, const float* v, const float* p, const Grid& g, int lanes, int y0, int y1, float scale);
+typedef void (*AdvectLanesFn)(float* const* out, const float* const* q, int nq, const float* u, const float* v, const Grid& g, int lanes, int y0, int y1,
+    const float* kx, const float* ky);
+
+// frcStep.fs on row y of lanes [k0, k1): (u, v) += (fx, fy) / |texel uv - (ox, oy)|, with the force's scale and the mouse's uv per lane
+typedef void (*ForceLanesFn)(float* u, float* v, const Grid& g, int lanes, int y, int k0, int k1, const float* fx, const float* fy, const float* ox,
+    const float* oy);
+
+/*
+Lattice Boltzmann form (lbmFluid.h): one fused collide and stream step of a D2Q9 lattice, on nine planes of populations, f[i] the
+population moving along (LBM_CX[i], LBM_CY[i]). Each texel pulls f[i] from its neighbor at -c_i (the ghost cells hold what the walls
+send back, see LbmFluid::bounceBack), relaxes the nine towards their equilibrium with omega = 1 / tau, and writes them to out; u and v
+get the lattice velocity times (sx, sy), or are skipped if NULL.
+*/
+
+const int LBM_CX[9] = { 0, 1, 0, -1, 0, 1, -1, -1, 1 };
+const int LBM_CY[9] = { 0, 0, 1, 0, -1, 1, 1, -1, -1 };
+const int LBM_OPP[9] = { 0, 3, 4, 1, 2, 7, 8, 5, 6 };
+const float LBM_W[9] = { 4.0f / 9, 1.0f / 9, 1.0f / 9, 1.0f / 9, 1.0f / 9, 1.0f / 36, 1.0f / 36, 1.0f / 36, 1.0f / 36 };
+
+typedef void (*LatticeFn)(float* const* out, const float* const* f, float* u, float* v, const Grid& g, int y0, int y1, float omega, float sx, float sy);
+
+// frcStep.fs on the populations f, in place: each texel's velocity kicked by (fx, fy) / |texel uv - (ox, oy)| lattice units and capped at
+// maxSpeed, its populations moved from the equilibrium of the old velocity to that of the new one
+typedef void (*LatticeKickFn)(float* const* f, const Grid& g, int y0, int y1, float fx, float fy, float ox, float oy, float maxSpeed);
+
+/*
+Presentation form (the software path, see Kernel): one row of the dye as fluid.fs draws it into the RGBA8 default framebuffer, each of
+the three planes q (r, g and b) clamped to [0, 1] and rounded to 8 bits, packed into n pixels r | g << 8 | b << 16 | 255 << 24
+(SDL_PIXELFORMAT_ABGR8888) and written straight into a locked texture's row.
+*/
+
+typedef void (*PresentFn)(uint32_t* out, const float* const* q, int n);
+typedef void (*PresentHalfFn)(uint32_t* out, const Half* const* q, int n);
+
+// production grid widths the vector kernels are also compiled for, with constant loop bounds and strides (makeSizedKernels in stencilImpl.h).
+// The strides are those of Fields of these widths with a halo of 1
+#define STENCIL_SIZES 512, 1024, 2048
+
+enum class Isa { Scalar = 0, SSE42 = 1, AVX2 = 2, AVX512 = 3 };
+
+/**
+ * @brief Set of kernels implemented for one instruction set
+ */
+struct StencilKernels {
+    Isa isa;
+    int width; // 0 for any grid; otherwise compiled for planes of exactly this width and row stride
+    JacobiFn jacobi;
+    DivergenceFn divergence;
+    GradientFn gradient;
+    AdvectFn advect;
+    JacobiRowFn jacobiRow;
+    DivergenceRowFn divergenceRow;
+};
+
+/**
+ * @brief Set of half storage kernels implemented for one instruction set
+ */
+struct HalfKernels {
+    Isa isa;
+    JacobiHalfFn jacobi;
+    DivergenceHalfFn divergence;
+    GradientHalfFn gradient;
+    AdvectHalfFn advect;
+    ToHalfFn toHalf;
+    FromHalfFn fromHalf;
+};
+
+/**
+ * @brief Set of ensemble kernels implemented for one instruction set; lanes is best a multiple of width, the rest run scalar
+ */
+struct EnsembleKernels {
+    Isa isa;
+    int width; // floats per register
+    JacobiLanesFn jacobi;
+    DivergenceLanesFn divergence;
+    GradientLanesFn gradient;
+    AdvectLanesFn advect;
+    ForceLanesFn force;
+};
+
+/**
+ * @brief The lattice Boltzmann step implemented for one instruction set
+ */
+struct LatticeKernels {
+    Isa isa;
+    LatticeFn collideStream;
+    LatticeKickFn kick;
+};
+
+/**
+ * @brief The presentation form implemented for one instruction set, from float and half planes
+ */
+struct PresentKernels {
+    Isa isa;
+    PresentFn present;
+    PresentHalfFn presentHalf;
+};
+
+// the best instruction set supported by both the cpu (cpuid) and operating system (xgetbv)
+Isa detectIsa();
+const char* isaName(Isa isa);
+
+// kernels for an instruction set, or for the best detected one if isa is not supported. The GG1_ISA environment variable
+// (scalar, sse42, avx2, avx512) caps the selection, which is useful for comparing and validating
+// Given the planes' width and row stride, a table compiled for that width is picked when there is one (STENCIL_SIZES, halo 1 stride)
+const StencilKernels& selectKernels(int rx = 0, ptrdiff_t stride = 0);
+const StencilKernels& getKernels(Isa isa, int rx = 0, ptrdiff_t stride = 0);
+
+// the same for the half storage kernels (there are no size specialized ones)
+const HalfKernels& selectHalfKernels();
+const HalfKernels& getHalfKernels(Isa isa);
+
+// the same for the ensemble kernels
+const EnsembleKernels& selectEnsembleKernels();
+const EnsembleKernels& getEnsembleKernels(Isa isa);
+
+// the same for the lattice Boltzmann step
+const LatticeKernels& selectLatticeKernels();
+const LatticeKernels& getLatticeKernels(Isa isa);
+
+// the same for the presentation form
+const PresentKernels& selectPresentKernels();
+const PresentKernels& getPresentKernels(Isa isa);
+
+// runs every kernel of k and of the scalar reference on the same pseudo random planes, and returns the largest absolute difference
+float validateKernels(const StencilKernels& k, int rx = 67, int ry = 45);
+float validateHalfKernels(const HalfKernels& k, int rx = 67, int ry = 45);
+float validateEnsembleKernels(const EnsembleKernels& k, int rx = 13, int ry = 11, int lanes = 19);
+float validateLatticeKernels(const LatticeKernels& k, int rx = 67, int ry = 45);
+float validatePresentKernels(const PresentKernels& k, int n = 67);
+
+// per instruction set tables, defined in stencilExpr.cpp, stencilSSE42.cpp, stencilAVX2.cpp, stencilAVX512.cpp. The Scalar entry
+// of the dispatch is exprKernels (Field expressions, vectorized by the compiler for the build's baseline target); scalarKernels
+// (stencilScalar.cpp) is the tap by tap reference every table is validated against
+const StencilKernels& scalarKernels();
+const StencilKernels& exprKernels();
+const HalfKernels& scalarHalfKernels();
+const EnsembleKernels& scalarEnsembleKernels();
+const LatticeKernels& scalarLatticeKernels();
+const PresentKernels& scalarPresentKernels();
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define STENCIL_X86
+// rx selects a specialized table (0 or any other width gives the generic one)
+const StencilKernels& sse42Kernels(int rx = 0);
+const StencilKernels& avx2Kernels(int rx = 0);
+const StencilKernels& avx512Kernels(int rx = 0);
+const HalfKernels& sse42HalfKernels();
+const HalfKernels& avx2HalfKernels();
+const HalfKernels& avx512HalfKernels();
+const EnsembleKernels& sse42EnsembleKernels();
+const EnsembleKernels& avx2EnsembleKernels();
+const EnsembleKernels& avx512EnsembleKernels();
+const LatticeKernels& sse42LatticeKernels();
+const LatticeKernels& avx2LatticeKernels();
+const LatticeKernels& avx512LatticeKernels();
+const PresentKernels& sse42PresentKernels();
+const PresentKernels& avx2PresentKernels();
+const PresentKernels& avx512PresentKernels();
+#endif
+
+#endif
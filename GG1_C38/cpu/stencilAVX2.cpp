@@ -0,0 +1,118 @@
+/**
+ * @file stencilAVX2.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief AVX2 kernels (8 lanes, hardware gather for advection, F16C conversions for half storage)
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cmath>
+#include <ostream>
+#include <string>
+
+#include "field.h"
+#include "half.h"
+#include "stencil.h"
+
+#ifdef STENCIL_X86
+
+// gcc and clang only emit AVX2 (and F16C) instructions in functions compiled for it; msvc allows the intrinsics everywhere.
+// detectIsa only reports AVX2 with F16C
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,f16c"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx2,f16c")
+#endif
+
+#include <immintrin.h>
+
+#define STENCIL_VECTOR
+#include "stencilImpl.h"
+
+namespace {
+
+struct V {
+    static const int W = 8;
+    typedef __m256 f;
+
+    struct Tap {
+        __m256i idx;
+        __m256 mask;
+    };
+
+    static f load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, f a) { _mm256_storeu_ps(p, a); }
+    static f load(const Half* p) { return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p)); }
+    static void store(Half* p, f a) { _mm_storeu_si128((__m128i*)p, _mm256_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT)); }
+    static f set1(float a) { return _mm256_set1_ps(a); }
+    static f iota(int i) { return _mm256_add_ps(_mm256_set1_ps((float)i), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)); }
+    static f add(f a, f b) { return _mm256_add_ps(a, b); }
+    static f sub(f a, f b) { return _mm256_sub_ps(a, b); }
+    static f mul(f a, f b) { return _mm256_mul_ps(a, b); }
+    static f floor(f a) { return _mm256_floor_ps(a); }
+    static f div(f a, f b) { return _mm256_div_ps(a, b); }
+    static f sqrt(f a) { return _mm256_sqrt_ps(a); }
+    static f min(f a, f b) { return _mm256_min_ps(a, b); }
+    static f max(f a, f b) { return _mm256_max_ps(a, b); }
+    static void storeRGBA8(uint32_t* p, f r, f g, f b) {
+        __m256i c = _mm256_or_si256(_mm256_cvttps_epi32(r), _mm256_slli_epi32(_mm256_cvttps_epi32(g), 8));
+        c = _mm256_or_si256(_mm256_or_si256(c, _mm256_slli_epi32(_mm256_cvttps_epi32(b), 16)), _mm256_set1_epi32((int)0xff000000));
+        _mm256_storeu_si256((__m256i*)p, c);
+    }
+
+    static Tap tap(f fx, f fy, const Grid& g) {
+        const f zero = _mm256_setzero_ps();
+        f inX = _mm256_and_ps(_mm256_cmp_ps(fx, zero, _CMP_GE_OQ), _mm256_cmp_ps(fx, _mm256_set1_ps((float)g.rx), _CMP_LT_OQ));
+        f inY = _mm256_and_ps(_mm256_cmp_ps(fy, zero, _CMP_GE_OQ), _mm256_cmp_ps(fy, _mm256_set1_ps((float)g.ry), _CMP_LT_OQ));
+
+        Tap t;
+        t.mask = _mm256_and_ps(inX, inY);
+        t.idx = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_cvttps_epi32(fy), _mm256_set1_epi32((int)g.stride)), _mm256_cvttps_epi32(fx));
+        return t;
+    }
+
+    // masked off lanes are never dereferenced, so out of range indices are harmless
+    static f gather(const float* q, const Tap& t) {
+        return _mm256_mask_i32gather_ps(_mm256_setzero_ps(), q, t.idx, t.mask, 4);
+    }
+
+    // there is no 16 bit gather; 32 bit lanes are gathered at a 2 byte scale and their upper halves (the next texel, or a ghost cell
+    // after the last one) dropped
+    static f gather(const Half* q, const Tap& t) {
+        __m256i w = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int*)q, t.idx, _mm256_castps_si256(t.mask), 2);
+        w = _mm256_and_si256(w, _mm256_set1_epi32(0xffff));
+        return _mm256_cvtph_ps(_mm_packus_epi32(_mm256_castsi256_si128(w), _mm256_extracti128_si256(w, 1)));
+    }
+};
+
+}
+
+const StencilKernels& avx2Kernels(int rx) {
+    return makeSizedKernels<V>(Isa::AVX2, rx);
+}
+
+const HalfKernels& avx2HalfKernels() {
+    static const HalfKernels k = makeHalfKernels<V>(Isa::AVX2);
+    return k;
+}
+
+const EnsembleKernels& avx2EnsembleKernels() {
+    static const EnsembleKernels k = makeEnsembleKernels<V>(Isa::AVX2);
+    return k;
+}
+
+const LatticeKernels& avx2LatticeKernels() {
+    static const LatticeKernels k = makeLatticeKernels<V>(Isa::AVX2);
+    return k;
+}
+
+const PresentKernels& avx2PresentKernels() {
+    static const PresentKernels k = makePresentKernels<V>(Isa::AVX2);
+    return k;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * @file stencilAVX512.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief AVX-512 kernels (16 lanes, masked gather for advection)
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cmath>
+#include <ostream>
+#include <string>
+
+#include "field.h"
+#include "half.h"
+#include "stencil.h"
+
+#ifdef STENCIL_X86
+
+// gcc and clang only emit AVX-512 instructions in functions compiled for it; msvc allows the intrinsics everywhere
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("avx512f")
+#endif
+
+#include <immintrin.h>
+
+#define STENCIL_VECTOR
+#include "stencilImpl.h"
+
+namespace {
+
+struct V {
+    static const int W = 16;
+    typedef __m512 f;
+
+    struct Tap {
+        __m512i idx;
+        __mmask16 mask;
+    };
+
+    static f load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, f a) { _mm512_storeu_ps(p, a); }
+    static f load(const Half* p) { return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)p)); }
+    static void store(Half* p, f a) { _mm256_storeu_si256((__m256i*)p, _mm512_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT)); }
+    static f set1(float a) { return _mm512_set1_ps(a); }
+    static f iota(int i) { return _mm512_add_ps(_mm512_set1_ps((float)i), _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)); }
+    static f add(f a, f b) { return _mm512_add_ps(a, b); }
+    static f sub(f a, f b) { return _mm512_sub_ps(a, b); }
+    static f mul(f a, f b) { return _mm512_mul_ps(a, b); }
+    static f floor(f a) { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+    static f div(f a, f b) { return _mm512_div_ps(a, b); }
+    static f sqrt(f a) { return _mm512_sqrt_ps(a); }
+    static f min(f a, f b) { return _mm512_min_ps(a, b); }
+    static f max(f a, f b) { return _mm512_max_ps(a, b); }
+    static void storeRGBA8(uint32_t* p, f r, f g, f b) {
+        __m512i c = _mm512_or_si512(_mm512_cvttps_epi32(r), _mm512_slli_epi32(_mm512_cvttps_epi32(g), 8));
+        c = _mm512_or_si512(_mm512_or_si512(c, _mm512_slli_epi32(_mm512_cvttps_epi32(b), 16)), _mm512_set1_epi32((int)0xff000000));
+        _mm512_storeu_si512(p, c);
+    }
+
+    static Tap tap(f fx, f fy, const Grid& g) {
+        const f zero = _mm512_setzero_ps();
+        Tap t;
+        t.mask = _mm512_cmp_ps_mask(fx, zero, _CMP_GE_OQ) & _mm512_cmp_ps_mask(fx, _mm512_set1_ps((float)g.rx), _CMP_LT_OQ)
+               & _mm512_cmp_ps_mask(fy, zero, _CMP_GE_OQ) & _mm512_cmp_ps_mask(fy, _mm512_set1_ps((float)g.ry), _CMP_LT_OQ);
+        t.idx = _mm512_add_epi32(_mm512_mullo_epi32(_mm512_cvttps_epi32(fy), _mm512_set1_epi32((int)g.stride)), _mm512_cvttps_epi32(fx));
+        return t;
+    }
+
+    static f gather(const float* q, const Tap& t) {
+        return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), t.mask, t.idx, q, 4);
+    }
+
+    // 32 bit lanes gathered at a 2 byte scale, narrowed to their low 16 bits
+    static f gather(const Half* q, const Tap& t) {
+        __m512i w = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), t.mask, t.idx, q, 2);
+        return _mm512_cvtph_ps(_mm512_cvtepi32_epi16(w));
+    }
+};
+
+}
+
+const StencilKernels& avx512Kernels(int rx) {
+    return makeSizedKernels<V>(Isa::AVX512, rx);
+}
+
+const HalfKernels& avx512HalfKernels() {
+    static const HalfKernels k = makeHalfKernels<V>(Isa::AVX512);
+    return k;
+}
+
+const EnsembleKernels& avx512EnsembleKernels() {
+    static const EnsembleKernels k = makeEnsembleKernels<V>(Isa::AVX512);
+    return k;
+}
+
+const LatticeKernels& avx512LatticeKernels() {
+    static const LatticeKernels k = makeLatticeKernels<V>(Isa::AVX512);
+    return k;
+}
+
+const PresentKernels& avx512PresentKernels() {
+    static const PresentKernels k = makePresentKernels<V>(Isa::AVX512);
+    return k;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/**
+ * @file stencilExpr.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Portable kernels: the specs of stencilSpec.h as Field expressions (fieldExpr.h), auto vectorized; the Scalar entry of the dispatch
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "fieldExpr.h"
+#include "stencilImpl.h"
+
+namespace {
+
+// kernel planes have at least one ghost cell, so none of the expressions below needs a checked border
+inline Plane<float> plane(const float* p, const Grid& g) {
+    return Plane<float>(p, g.rx, g.ry, g.stride, 1);
+}
+
+/*
+A spec of stencilSpec.h as a Field expression: taps become shifts of the input planes, arguments and constants Scalars. in[k][dy + 1] is
+the plane of input k that taps dy rows off read; for whole planes it is the same plane for every dy and the tap shifts it, for the
+single row forms (Rows) it is the neighboring row, shifted only along x.
+*/
+struct ExprInputs {
+    const Plane<float>* in[3][3];
+    const float* arg;
+};
+
+template<bool Rows, int K, int DX, int DY>
+Shift<Plane<float>, DX, Rows ? 0 : DY> toExpr(SpTap<K, DX, DY>, const ExprInputs& e) {
+    return Shift<Plane<float>, DX, Rows ? 0 : DY>(*e.in[K][DY + 1]);
+}
+template<bool Rows, int K>
+Scalar<float> toExpr(SpArg<K>, const ExprInputs& e) { return Scalar<float>(e.arg[K]); }
+template<bool Rows, int NUM, int DEN>
+Scalar<float> toExpr(SpConst<NUM, DEN>, const ExprInputs&) { return Scalar<float>((float)NUM / (float)DEN); }
+template<bool Rows, class A, class B>
+auto toExpr(SpAdd<A, B>, const ExprInputs& e) { return toExpr<Rows>(A(), e) + toExpr<Rows>(B(), e); }
+template<bool Rows, class A, class B>
+auto toExpr(SpSub<A, B>, const ExprInputs& e) { return toExpr<Rows>(A(), e) - toExpr<Rows>(B(), e); }
+template<bool Rows, class A, class B>
+auto toExpr(SpMul<A, B>, const ExprInputs& e) { return toExpr<Rows>(A(), e) * toExpr<Rows>(B(), e); }
+
+void jacobi(float* out, const float* x, const float* b, const Grid& g, int y0, int y1, float alpha, float rbeta) {
+    Plane<float> X = plane(x, g), B = plane(b, g);
+    const float a[2] = { alpha, rbeta };
+    ExprInputs e = { { { &X, &X, &X }, { &B, &B, &B } }, a };
+    assign(out, g.rx, g.ry, g.stride, toExpr<false>(JacobiSpec::out(), e), y0, y1);
+}
+
+void divergence(float* out, const float* u, const float* v, const Grid& g, int y0, int y1, float scale) {
+    Plane<float> U = plane(u, g), V = plane(v, g);
+    ExprInputs e = { { { &U, &U, &U }, { &V, &V, &V } }, &scale };
+    assign(out, g.rx, g.ry, g.stride, toExpr<false>(DivergenceSpec::out(), e), y0, y1);
+}
+
+void gradient(float* outU, float* outV, const float* u, const float* v, const float* p, const Grid& g, int y0, int y1, float scale) {
+    Plane<float> U = plane(u, g), V = plane(v, g), P = plane(p, g);
+    ExprInputs e = { { { &U, &U, &U }, { &V, &V, &V }, { &P, &P, &P } }, &scale };
+    assign(outU, g.rx, g.ry, g.stride, toExpr<false>(GradientSpec::outU(), e), y0, y1);
+    assign(outV, g.rx, g.ry, g.stride, toExpr<false>(GradientSpec::outV(), e), y0, y1);
+}
+
+// the advection taps are data dependent gathers rather than fixed shifts, so the spec is evaluated texel by texel through advectPoint
+void advect(float* const* out, const float* const* q, int nq, const float* u, const float* v, const Grid& g, int y0, int y1, int x0, int x1,
+    float kx, float ky) {
+    for (int y = y0; y < y1; y ++)
+        for (int i = x0; i < x1; i ++)
+            advectPoint(out, q, nq, u, v, g, i, y, kx, ky);
+}
+
+// single row forms; the neighboring rows come from the caller, so the rows are viewed as one row planes (with their ghost columns)
+void jacobiRow(float* out, const float* xc, const float* xb, const float* xt, const float* bc, int rx, float alpha, float rbeta) {
+    Plane<float> C(xc, rx, 1, 0, 1), Bl(xb, rx, 1, 0, 1), T(xt, rx, 1, 0, 1), B(bc, rx, 1, 0, 1);
+    const float a[2] = { alpha, rbeta };
+    ExprInputs e = { { { &Bl, &C, &T }, { NULL, &B, NULL } }, a };
+    assign(out, rx, 1, 0, toExpr<true>(JacobiSpec::out(), e), 0, 1);
+}
+
+void divergenceRow(float* out, const float* uc, const float* vb, const float* vt, int rx, float scale) {
+    Plane<float> U(uc, rx, 1, 0, 1), Vb(vb, rx, 1, 0, 1), Vt(vt, rx, 1, 0, 1);
+    ExprInputs e = { { { NULL, &U, NULL }, { &Vb, NULL, &Vt } }, &scale };
+    assign(out, rx, 1, 0, toExpr<true>(DivergenceSpec::out(), e), 0, 1);
+}
+
+}
+
+const StencilKernels& exprKernels() {
+    static const StencilKernels k = { Isa::Scalar, 0, jacobi, divergence, gradient, advect, jacobiRow, divergenceRow };
+    return k;
+}
@@ -0,0 +1,108 @@
+/**
+ * @file stencilGLSL.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Generates the GLSL pass bodies of the stencils in stencilSpec.h
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "stencilSpec.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// one statement "    assign;", the expression of E put in place of the % in assign (e.g. "div = vec4(%)"), without its outer parentheses
+template<class E>
+void statement(std::ostream& o, const SpGlsl& n, const std::string& assign) {
+    std::ostringstream e;
+    E::glsl(e, n);
+    std::string s = e.str();
+
+    int depth = 0;
+    size_t close = 0;
+    for (size_t i = 0; i < s.size() && close == 0; i ++) {
+        if (s[i] == '(')
+            depth ++;
+        else if (s[i] == ')' && -- depth == 0)
+            close = i;
+    }
+    if (s[0] == '(' && close == s.size() - 1)
+        s = s.substr(1, s.size() - 2);
+
+    size_t p = assign.find('%');
+    o << "    " << assign.substr(0, p) << s << assign.substr(p + 1) << ";\n";
+}
+
+}
+
+void writeStencilGLSL(std::ostream& o) {
+    o << "/**\n"
+        " * @file stencils.fs\n"
+        " * @author Eron Ristich (eron@ristich.com)\n"
+        " * @brief Jacobi, divergence, gradient and advection; generated from cpu/stencilSpec.h by writeStencilGLSL, do not edit\n"
+        " * @version 0.1\n"
+        " * @date 2026-10-18\n"
+        " */\n";
+
+    // the pass bodies read delx and dely, and advect() the globals velTex, qntTex, dt and res, of the step shaders
+    o << "\n"
+        "// Jacobi iteration\n"
+        "// Poisson-pressure equation; x -> p, b -> del dot w, alpha -> -(delta x)^2, beta -> 4\n"
+        "// Viscous x,b -> u (velocity field), alpha = (delta x)^2/v delta t, beta -> 4 + alpha\n"
+        "void jacobi(vec2 coords, out vec4 xNew, float alpha, float rbeta, sampler2D x, sampler2D b) {\n";
+    SpGlsl jacobi = { "coords", { "x", "b" }, { "", "" }, { "alpha", "rbeta" } };
+    statement<JacobiSpec::out>(o, jacobi, "xNew = %");
+    o << "}\n";
+
+    o << "\n"
+        "// Divergence\n"
+        "void divergence(vec2 coords, out vec4 div, sampler2D x) {\n";
+    SpGlsl divergence = { "coords", { "x", "x" }, { ".x", ".y" }, { "((res.x / res.y) * 0.5)" } };
+    statement<DivergenceSpec::out>(o, divergence, "div = vec4(%)");
+    o << "}\n";
+
+    o << "\n"
+        "// Gradient\n"
+        "void gradient(vec2 coords, out vec4 uNew, sampler2D p, sampler2D w) {\n"
+        "    uNew = texture(w, coords);\n";
+    SpGlsl gradient = { "coords", { "w", "w", "p" }, { ".x", ".y", ".x" }, { "((res.x / res.y) * 0.5)" } };
+    statement<GradientSpec::outU>(o, gradient, "uNew.x = %");
+    statement<GradientSpec::outV>(o, gradient, "uNew.y = %");
+    o << "}\n";
+
+    o << "\n"
+        "// Advection; q(x, t + del t) = q(x - u(x, t) del t, t), averaged over the four neighbors of the backtraced position\n"
+        "void advect(vec2 coords, out vec4 xNew) {\n"
+        "    vec2 pos = coords - dt * (res.x / res.y) * texture(velTex, coords).xy;\n";
+    SpGlsl advect = { "pos", { "qntTex" }, { "" }, {} };
+    statement<AdvectSpec::out>(o, advect, "xNew = %");
+    o << "}\n";
+}
+
+bool stencilGLSLCurrent(const std::string& path) {
+    std::ostringstream s;
+    writeStencilGLSL(s);
+
+    std::ifstream in(path);
+    if (!in.is_open())
+        return false;
+    std::ostringstream cur;
+    cur << in.rdbuf();
+    return cur.str() == s.str();
+}
+
+void writeStencilGLSL(const std::string& path) {
+    // leave the file alone if it is current, so that an unchanged spec does not touch the source tree
+    if (stencilGLSLCurrent(path))
+        return;
+
+    std::ostringstream s;
+    writeStencilGLSL(s);
+    std::ofstream out(path);
+    if (!out.is_open())
+        throw std::runtime_error("Stencil source " + path + " unable to be written");
+    out << s.str();
+}
@@ -0,0 +1,720 @@
+/**
+ * @file stencilImpl.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Kernel bodies shared by the per instruction set translation units. Only include from stencil*.cpp
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_STENCIL_IMPL_H
+#define CPU_STENCIL_IMPL_H
+
+#include <cmath>
+#include <type_traits>
+
+#include "field.h"
+#include "half.h"
+#include "stencil.h"
+
+/*
+Everything here has internal linkage on purpose. Each stencil*.cpp is compiled for a different instruction set, and a shared
+inline function could otherwise be merged by the linker into its AVX-512 copy and then called on a machine without it. For the
+same reason the vector translation units include field.h, and the standard headers of stencilSpec.h, before switching the target.
+
+The vector bodies are templates over a small traits struct V that each instruction set provides:
+    V::W                    lanes per register
+    V::f                    register type
+    load/store              unaligned load and store of W floats, and of W Halfs converted from and to float
+    set1, iota(i)           broadcast, and {i, i + 1, ..., i + W - 1}
+    add, sub, mul, floor
+    div, sqrt, min          (the ensemble's force and the lattice's)
+    max, storeRGBA8         (the presentation form) maxps, and W pixels packed from r, g, b in [0, 256), truncated
+    V::Tap, tap(fx, fy, g)  index and in bounds mask of W texel taps at integer valued coordinates
+    gather(q, t)            W taps of plane q (float or Half), 0 where out of bounds
+The fixed stencils and the advection average are not written out here but evaluated from their specs (stencilSpec.h), with V on W
+columns at a time and with ScalarOps on single ones, so the vector, tail and scalar reference forms are bit identical by construction.
+Bodies are also templates over the storage type S of the planes, float or Half; texel() and put() convert single texels.
+*/
+
+// the point formulas have to round exactly like the scalar reference, so a * b + c must not be fused into an fma where the target
+// has one (AVX-512F does); msvc only contracts with /fp:contract
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+// after the pragmas, so that the specs' bodies are compiled with the same options as the kernels they inline into
+#include "stencilSpec.h"
+
+namespace {
+
+inline float texel(float a) { return a; }
+inline float texel(Half a) { return halfToFloat(a); }
+inline void put(float* p, float a) { *p = a; }
+inline void put(Half* p, float a) { *p = floatToHalf(a); }
+
+// nearest neighbor tap at integer valued (fx, fy), lane k of K, reading 0 outside the grid (and for nan coordinates)
+template<typename S>
+inline float advectTap(const S* q, const Grid& g, float fx, float fy, int K = 1, int k = 0) {
+    if (!(fx >= 0.0f && fx < (float)g.rx && fy >= 0.0f && fy < (float)g.ry))
+        return 0.0f;
+    return texel(q[(ptrdiff_t)fy * g.stride + (ptrdiff_t)fx * K + k]);
+}
+
+// frcStep.fs at texel (x, y) of lane k; px and py are the texel's uv, fx, fy the force's scale and ox, oy the mouse's uv
+inline void forceLanePoint(float* u, float* v, ptrdiff_t i, float px, float py, float fx, float fy, float ox, float oy) {
+    float dx = px - ox, dy = py - oy;
+    float dist = std::sqrt(dx * dx + dy * dy);
+    u[i] += fx / dist;
+    v[i] += fy / dist;
+}
+
+// the operations of V on single floats, for the scalar forms of the specs, the lattice and the presentation; min and max are those of
+// minps and maxps, the second operand unless a < b (a > b)
+struct ScalarOps {
+    typedef float f;
+    template<typename S> static f load(const S* p) { return texel(*p); }
+    static f set1(float a) { return a; }
+    static f add(f a, f b) { return a + b; }
+    static f sub(f a, f b) { return a - b; }
+    static f mul(f a, f b) { return a * b; }
+    static f div(f a, f b) { return a / b; }
+    static f sqrt(f a) { return std::sqrt(a); }
+    static f min(f a, f b) { return a < b ? a : b; }
+    static f max(f a, f b) { return a > b ? a : b; }
+};
+
+// a channel of the presentation form, clamped to [0, 1] and scaled so that truncating it rounds to 8 bits; a nan channel clamps to 0
+template<class O>
+inline typename O::f unorm8(typename O::f c) {
+    return O::add(O::mul(O::min(O::max(c, O::set1(0.0f)), O::set1(1.0f)), O::set1(255.0f)), O::set1(0.5f));
+}
+
+inline uint32_t presentPoint(float r, float g, float b) {
+    return (uint32_t)unorm8<ScalarOps>(r) | (uint32_t)unorm8<ScalarOps>(g) << 8 | (uint32_t)unorm8<ScalarOps>(b) << 16 | 0xff000000u;
+}
+
+/*
+Contexts the specs read their taps through. SpanTaps holds, for every input and tap, the address of that tap of column 0, so a tap of
+column i is a load at a fixed offset from i; step is the distance between neighboring texels, 1 or an ensemble's K lanes. Its
+arguments are broadcast, LaneArgs' loaded per lane. TracedTaps reads the taps around a backtraced texel instead (advection).
+*/
+
+template<typename S, int NIN, int NARG>
+struct SpanTaps {
+    const S* p[NIN][3][3];
+    float a[NARG > 0 ? NARG : 1];
+
+    // row dy (-1, 0, 1) of input k is r; the spec must not read the rows that are not set
+    void set(int k, int dy, const S* r, ptrdiff_t step = 1) {
+        for (int dx = -1; dx <= 1; dx ++)
+            p[k][dy + 1][dx + 1] = r + dx * step;
+    }
+    // input k around row c of a plane
+    void plane(int k, const S* c, ptrdiff_t stride, ptrdiff_t step = 1) {
+        set(k, -1, c - stride, step);
+        set(k, 0, c, step);
+        set(k, 1, c + stride, step);
+    }
+
+    template<class O, int K, int DX, int DY>
+    typename O::f read(ptrdiff_t i) const { return O::load(p[K][DY + 1][DX + 1] + i); }
+    template<class O, int K>
+    typename O::f arg() const { return O::set1(a[K]); }
+};
+
+// arguments that differ per lane; argument j of the lanes at column i is lane[j][k], k the column's first lane
+template<typename S, int NIN, int NARG>
+struct LaneArgs : SpanTaps<S, NIN, 0> {
+    const float* lane[NARG];
+    int k;
+
+    template<class O, int K>
+    typename O::f arg() const { return O::load(lane[K] + k); }
+};
+
+// the taps around the backtraced texel (fx, fy), nearest neighbor as advectTap, of lane k of K
+template<typename S>
+struct TracedTaps {
+    const S* q;
+    const Grid* g;
+    float fx, fy;
+    int K, k;
+
+    template<class O, int, int DX, int DY>
+    float read(ptrdiff_t) const { return advectTap(q, *g, fx + (float)DX, fy + (float)DY, K, k); }
+};
+
+template<typename S>
+inline void advectPoint(S* const* out, const S* const* q, int nq, const S* u, const S* v, const Grid& g, int x, int y, float kx, float ky) {
+    ptrdiff_t i = y * g.stride + x;
+    TracedTaps<S> t = { NULL, &g, 0.0f, 0.0f, 1, 0 };
+    t.fx = std::floor((x + 0.5f) - kx * texel(u[i]));
+    t.fy = std::floor(((y + g.oy) + 0.5f) - ky * texel(v[i])) - g.oy;
+    for (int c = 0; c < nq; c ++) {
+        t.q = q[c];
+        put(out[c] + i, AdvectSpec::out::eval<ScalarOps>(t, 0));
+    }
+}
+
+// advectPoint on lane k of an ensemble plane of K lanes (stencil.h)
+inline void advectLanePoint(float* const* out, const float* const* q, int nq, const float* u, const float* v, const Grid& g, int K, int x, int y, int k,
+    float kx, float ky) {
+    ptrdiff_t i = y * g.stride + (ptrdiff_t)x * K + k;
+    TracedTaps<float> t = { NULL, &g, 0.0f, 0.0f, K, k };
+    t.fx = std::floor((x + 0.5f) - kx * u[i]);
+    t.fy = std::floor(((y + g.oy) + 0.5f) - ky * v[i]) - g.oy;
+    for (int c = 0; c < nq; c ++) {
+        t.q = q[c];
+        out[c][i] = AdvectSpec::out::eval<ScalarOps>(t, 0);
+    }
+}
+
+/*
+The lattice formulas are templates over O, V or ScalarOps, so that the vector and scalar forms are the same code and round the same
+way. p holds a texel's nine populations.
+*/
+
+// density and lattice velocity of p
+template<class O>
+inline void latticeMoments(const typename O::f* p, typename O::f* rho, typename O::f* ux, typename O::f* uy) {
+    typedef typename O::f f;
+    f r = O::add(O::add(O::add(p[0], O::add(p[1], p[3])), O::add(p[2], p[4])), O::add(O::add(p[5], p[7]), O::add(p[6], p[8])));
+    f diag = O::sub(p[5], p[7]);
+    f anti = O::sub(p[6], p[8]);
+    f mx = O::add(O::sub(p[1], p[3]), O::sub(diag, anti));
+    f my = O::add(O::sub(p[2], p[4]), O::add(diag, anti));
+    f inv = O::div(O::set1(1.0f), r);
+    *rho = r;
+    *ux = O::mul(mx, inv);
+    *uy = O::mul(my, inv);
+}
+
+// feq_i = w_i * rho * (1 + 3 c_i.u + 4.5 (c_i.u)^2 - 1.5 |u|^2), with cu = 3 c_i.u
+template<class O>
+inline void latticeEquilibrium(typename O::f rho, typename O::f u, typename O::f v, typename O::f* eq) {
+    typedef typename O::f f;
+    const f zero = O::set1(0.0f), half = O::set1(0.5f), three = O::set1(3.0f);
+    f base = O::sub(O::set1(1.0f), O::mul(O::set1(1.5f), O::add(O::mul(u, u), O::mul(v, v))));
+    f cu[9];
+    cu[0] = zero;
+    cu[1] = O::mul(three, u);
+    cu[2] = O::mul(three, v);
+    cu[3] = O::sub(zero, cu[1]);
+    cu[4] = O::sub(zero, cu[2]);
+    cu[5] = O::mul(three, O::add(u, v));
+    cu[6] = O::mul(three, O::sub(v, u));
+    cu[7] = O::sub(zero, cu[5]);
+    cu[8] = O::sub(zero, cu[6]);
+    for (int i = 0; i < 9; i ++)
+        eq[i] = O::mul(O::mul(O::set1(LBM_W[i]), rho), O::add(base, O::add(cu[i], O::mul(half, O::mul(cu[i], cu[i])))));
+}
+
+// the BGK collision of p, in place, and its lattice velocity (ux, uy)
+template<class O>
+inline void latticeCollide(typename O::f* p, typename O::f omega, typename O::f* ux, typename O::f* uy) {
+    typename O::f rho, eq[9];
+    latticeMoments<O>(p, &rho, ux, uy);
+    latticeEquilibrium<O>(rho, *ux, *uy, eq);
+    for (int i = 0; i < 9; i ++)
+        p[i] = O::add(p[i], O::mul(omega, O::sub(eq[i], p[i])));
+}
+
+// frcStep.fs on p at uv (px, py): the velocity kicked by (fx, fy) / |uv - (ox, oy)| and capped at maxSpeed, p moved from the equilibrium
+// of the old velocity to that of the new one
+template<class O>
+inline void latticeKick(typename O::f* p, typename O::f px, typename O::f py, float fx, float fy, float ox, float oy, float maxSpeed) {
+    typedef typename O::f f;
+    f dx = O::sub(px, O::set1(ox)), dy = O::sub(py, O::set1(oy));
+    f dist = O::sqrt(O::add(O::mul(dx, dx), O::mul(dy, dy)));
+
+    f rho, ux, uy;
+    latticeMoments<O>(p, &rho, &ux, &uy);
+    f tx = O::add(ux, O::div(O::set1(fx), dist));
+    f ty = O::add(uy, O::div(O::set1(fy), dist));
+    f speed = O::sqrt(O::add(O::mul(tx, tx), O::mul(ty, ty)));
+    f cap = O::min(O::set1(1.0f), O::div(O::set1(maxSpeed), speed));
+    tx = O::mul(tx, cap);
+    ty = O::mul(ty, cap);
+
+    f from[9], to[9];
+    latticeEquilibrium<O>(rho, ux, uy, from);
+    latticeEquilibrium<O>(rho, tx, ty, to);
+    for (int i = 0; i < 9; i ++)
+        p[i] = O::add(p[i], O::sub(to[i], from[i]));
+}
+
+// one texel of LatticeFn
+inline void latticePoint(float* const* out, const float* const* f, float* u, float* v, const Grid& g, int x, int y, float omega, float sx, float sy) {
+    ptrdiff_t c = y * g.stride + x;
+    float p[9], ux, uy;
+    for (int i = 0; i < 9; i ++)
+        p[i] = f[i][c - LBM_CY[i] * g.stride - LBM_CX[i]];
+    latticeCollide<ScalarOps>(p, omega, &ux, &uy);
+    for (int i = 0; i < 9; i ++)
+        out[i][c] = p[i];
+    if (u != NULL) {
+        u[c] = ux * sx;
+        v[c] = uy * sy;
+    }
+}
+
+// one texel of LatticeKickFn
+inline void latticeKickPoint(float* const* f, const Grid& g, int x, int y, float fx, float fy, float ox, float oy, float maxSpeed) {
+    ptrdiff_t c = y * g.stride + x;
+    float p[9];
+    for (int i = 0; i < 9; i ++)
+        p[i] = f[i][c];
+    latticeKick<ScalarOps>(p, (x + 0.5f) / g.rx, (y + 0.5f) / g.ry, fx, fy, ox, oy, maxSpeed);
+    for (int i = 0; i < 9; i ++)
+        f[i][c] = p[i];
+}
+
+#ifdef STENCIL_VECTOR
+
+/*
+The vector bodies take the width N as a template argument as well: 0 reads the width and row stride from the arguments, any other
+value is a compile time width whose planes are halo 1 Fields of that width (see makeSizedKernels). With N known, the loop bounds and
+row offsets are constants, the vector loop has no scalar tail when N is a multiple of W, and the compiler can unroll it.
+
+Taps at x - 1, x + 1 and rows y - 1, y + 1 come from the ghost cells at the border, so every column goes through the same loop.
+*/
+
+// E over columns [x0, x1) of a row, W at a time and the rest one by one
+template<class E, class V, typename S, class C>
+inline void spanT(S* o, const C& c, int x0, int x1) {
+    int i = x0;
+    for (; i + V::W <= x1; i += V::W)
+        V::store(o + i, E::template eval<V>(c, i));
+    for (; i < x1; i ++)
+        put(o + i, E::template eval<ScalarOps>(c, i));
+}
+
+// E and F in one sweep, for the two outputs of a spec that share their taps
+template<class E, class F, class V, typename S, class C>
+inline void span2T(S* o, S* p, const C& c, int x0, int x1) {
+    int i = x0;
+    for (; i + V::W <= x1; i += V::W) {
+        V::store(o + i, E::template eval<V>(c, i));
+        V::store(p + i, F::template eval<V>(c, i));
+    }
+    for (; i < x1; i ++) {
+        put(o + i, E::template eval<ScalarOps>(c, i));
+        put(p + i, F::template eval<ScalarOps>(c, i));
+    }
+}
+
+// a + d, for the tap offsets of a traced position
+template<class V>
+inline typename V::f shifted(typename V::f a, int d) {
+    return d == 0 ? a : V::add(a, V::set1((float)d));
+}
+
+// the gathered taps of a backtraced position; tap(dx, dy) fills only those E reads
+template<class V, typename S>
+struct GatherTaps {
+    const S* q;
+    typename V::Tap t[3][3];
+
+    template<class O, int, int DX, int DY>
+    typename V::f read(ptrdiff_t) const { return V::gather(q, t[DY + 1][DX + 1]); }
+};
+
+template<class E, int I = 0, class C, class F>
+inline void traceTaps(C& c, const F& tap) {
+    if constexpr (I < 9) {
+        constexpr int dx = I % 3 - 1, dy = I / 3 - 1;
+        if constexpr (E::uses(0, dx, dy))
+            c.t[dy + 1][dx + 1] = tap(dx, dy);
+        traceTaps<E, I + 1>(c, tap);
+    }
+}
+
+// width and row stride; constants for specialized instantiations
+#define STENCIL_RX(rx) (N != 0 ? N : (rx))
+#define STENCIL_STRIDE(g) (N != 0 ? std::integral_constant<ptrdiff_t, fieldStride(N, 1, sizeof(S))>::value : (g).stride)
+
+template<class V, int N, typename S = float>
+void jacobiRowT(S* o, const S* xc, const S* xb, const S* xt, const S* bc, int width, float alpha, float rbeta) {
+    SpanTaps<S, JacobiSpec::inputs, JacobiSpec::args> c;
+    c.set(0, -1, xb);
+    c.set(0, 0, xc);
+    c.set(0, 1, xt);
+    c.set(1, 0, bc);
+    c.a[0] = alpha;
+    c.a[1] = rbeta;
+    spanT<JacobiSpec::out, V>(o, c, 0, STENCIL_RX(width));
+}
+
+template<class V, int N, typename S = float>
+void jacobiT(S* out, const S* x, const S* b, const Grid& g, int y0, int y1, float alpha, float rbeta) {
+    const ptrdiff_t s = STENCIL_STRIDE(g);
+    for (int y = y0; y < y1; y ++) {
+        const S* xc = x + y * s;
+        jacobiRowT<V, N, S>(out + y * s, xc, xc - s, xc + s, b + y * s, g.rx, alpha, rbeta);
+    }
+}
+
+template<class V, int N, typename S = float>
+void divergenceRowT(S* o, const S* uc, const S* vb, const S* vt, int width, float scale) {
+    SpanTaps<S, DivergenceSpec::inputs, DivergenceSpec::args> c;
+    c.set(0, 0, uc);
+    c.set(1, -1, vb);
+    c.set(1, 1, vt);
+    c.a[0] = scale;
+    spanT<DivergenceSpec::out, V>(o, c, 0, STENCIL_RX(width));
+}
+
+template<class V, int N, typename S = float>
+void divergenceT(S* out, const S* u, const S* v, const Grid& g, int y0, int y1, float scale) {
+    const ptrdiff_t s = STENCIL_STRIDE(g);
+    for (int y = y0; y < y1; y ++) {
+        const S* vc = v + y * s;
+        divergenceRowT<V, N, S>(out + y * s, u + y * s, vc - s, vc + s, g.rx, scale);
+    }
+}
+
+template<class V, int N, typename S = float>
+void gradientT(S* outU, S* outV, const S* u, const S* v, const S* p, const Grid& g, int y0, int y1, float scale) {
+    const ptrdiff_t s = STENCIL_STRIDE(g);
+    SpanTaps<S, GradientSpec::inputs, GradientSpec::args> c;
+    c.a[0] = scale;
+
+    for (int y = y0; y < y1; y ++) {
+        ptrdiff_t r = y * s;
+        c.set(0, 0, u + r);
+        c.set(1, 0, v + r);
+        c.plane(2, p + r, s);
+        span2T<GradientSpec::outU, GradientSpec::outV, V>(outU + r, outV + r, c, 0, STENCIL_RX(g.rx));
+    }
+}
+
+template<class V, int N, typename S = float>
+void advectT(S* const* out, const S* const* q, int nq, const S* u, const S* v, const Grid& g, int y0, int y1, int x0, int x1, float kx, float ky) {
+    typedef typename V::f f;
+    const f vkx = V::set1(kx), vky = V::set1(ky);
+    const f center = V::set1(0.5f);
+
+    for (int y = y0; y < y1; y ++) {
+        ptrdiff_t r = y * STENCIL_STRIDE(g);
+        const f yc = V::set1((y + g.oy) + 0.5f), oy = V::set1((float)g.oy);
+
+        int i = x0;
+        for (; i + V::W <= x1; i += V::W) {
+            f fx = V::floor(V::sub(V::add(V::iota(i), center), V::mul(vkx, V::load(u + r + i))));
+            f fy = V::sub(V::floor(V::sub(yc, V::mul(vky, V::load(v + r + i)))), oy);
+
+            GatherTaps<V, S> t;
+            traceTaps<AdvectSpec::out>(t, [&](int dx, int dy) { return V::tap(shifted<V>(fx, dx), shifted<V>(fy, dy), g); });
+            for (int c = 0; c < nq; c ++) {
+                t.q = q[c];
+                V::store(out[c] + r + i, AdvectSpec::out::eval<V>(t, 0));
+            }
+        }
+        for (; i < x1; i ++)
+            advectPoint(out, q, nq, u, v, g, i, y, kx, ky);
+    }
+}
+
+#undef STENCIL_RX
+#undef STENCIL_STRIDE
+
+/*
+Ensemble bodies. A texel's K lanes are contiguous, so its left and right neighbors are K floats away and the rows above and below a
+stride away; the loop runs over texels, and over each texel's lanes W at a time with the per lane coefficients loaded alongside. An
+advection tap of lane k is at column fx * K + k of a grid K times as wide, which is in bounds exactly when fx is, so V::tap on that
+column does the bounds check and the indexing at once.
+*/
+
+template<class V>
+void jacobiLanesT(float* out, const float* x, const float* b, const Grid& g, int K, int y0, int y1, const float* alpha, const float* rbeta) {
+    typedef JacobiSpec::out E;
+    const ptrdiff_t s = g.stride;
+    LaneArgs<float, JacobiSpec::inputs, JacobiSpec::args> c;
+    c.lane[0] = alpha;
+    c.lane[1] = rbeta;
+
+    for (int y = y0; y < y1; y ++) {
+        c.plane(0, x + y * s, s, K);
+        c.set(1, 0, b + y * s, K);
+        float* o = out + y * s;
+
+        // with whole registers per texel the row is one run of floats, the coefficients cycling through the lanes
+        if (K % V::W == 0) {
+            c.k = 0;
+            for (ptrdiff_t i = 0; i < (ptrdiff_t)g.rx * K; i += V::W) {
+                V::store(o + i, E::eval<V>(c, i));
+                c.k += V::W;
+                if (c.k == K)
+                    c.k = 0;
+            }
+            continue;
+        }
+        for (ptrdiff_t i = 0; i < (ptrdiff_t)g.rx * K; i += K) {
+            for (c.k = 0; c.k + V::W <= K; c.k += V::W)
+                V::store(o + i + c.k, E::eval<V>(c, i + c.k));
+            for (; c.k < K; c.k ++)
+                o[i + c.k] = E::eval<ScalarOps>(c, i + c.k);
+        }
+    }
+}
+
+template<class V>
+void divergenceLanesT(float* out, const float* u, const float* v, const Grid& g, int K, int y0, int y1, float scale) {
+    const ptrdiff_t s = g.stride;
+    SpanTaps<float, DivergenceSpec::inputs, DivergenceSpec::args> c;
+    c.a[0] = scale;
+
+    // lanes do not interact here, so the row is one run of floats whatever K is
+    for (int y = y0; y < y1; y ++) {
+        c.set(0, 0, u + y * s, K);
+        c.set(1, -1, v + (y - 1) * s, K);
+        c.set(1, 1, v + (y + 1) * s, K);
+        spanT<DivergenceSpec::out, V>(out + y * s, c, 0, g.rx * K);
+    }
+}
+
+template<class V>
+void gradientLanesT(float* outU, float* outV, const float* u, const float* v, const float* p, const Grid& g, int K, int y0, int y1, float scale) {
+    const ptrdiff_t s = g.stride;
+    SpanTaps<float, GradientSpec::inputs, GradientSpec::args> c;
+    c.a[0] = scale;
+
+    for (int y = y0; y < y1; y ++) {
+        ptrdiff_t r = y * s;
+        c.set(0, 0, u + r, K);
+        c.set(1, 0, v + r, K);
+        c.plane(2, p + r, s, K);
+        span2T<GradientSpec::outU, GradientSpec::outV, V>(outU + r, outV + r, c, 0, g.rx * K);
+    }
+}
+
+template<class V>
+void advectLanesT(float* const* out, const float* const* q, int nq, const float* u, const float* v, const Grid& g, int K, int y0, int y1,
+    const float* kx, const float* ky) {
+    typedef typename V::f f;
+    const f vk = V::set1((float)K);
+    Grid wide = g;
+    wide.rx = g.rx * K;
+
+    for (int y = y0; y < y1; y ++) {
+        ptrdiff_t r = y * g.stride;
+        const f yc = V::set1((y + g.oy) + 0.5f), oy = V::set1((float)g.oy);
+
+        for (int x = 0; x < g.rx; x ++) {
+            const f xc = V::set1(x + 0.5f);
+            ptrdiff_t i = r + (ptrdiff_t)x * K;
+
+            int k = 0;
+            for (; k + V::W <= K; k += V::W) {
+                f fx = V::floor(V::sub(xc, V::mul(V::load(kx + k), V::load(u + i + k))));
+                f fy = V::sub(V::floor(V::sub(yc, V::mul(V::load(ky + k), V::load(v + i + k)))), oy);
+
+                // the lanes' columns in the K times wider grid
+                f lane = V::iota(k);
+                GatherTaps<V, float> t;
+                traceTaps<AdvectSpec::out>(t, [&](int dx, int dy) {
+                    return V::tap(V::add(V::mul(shifted<V>(fx, dx), vk), lane), shifted<V>(fy, dy), wide);
+                });
+                for (int c = 0; c < nq; c ++) {
+                    t.q = q[c];
+                    V::store(out[c] + i + k, AdvectSpec::out::eval<V>(t, 0));
+                }
+            }
+            for (; k < K; k ++)
+                advectLanePoint(out, q, nq, u, v, g, K, x, y, k, kx[k], ky[k]);
+        }
+    }
+}
+
+template<class V>
+void forceLanesT(float* u, float* v, const Grid& g, int K, int y, int k0, int k1, const float* fx, const float* fy, const float* ox, const float* oy) {
+    typedef typename V::f f;
+    ptrdiff_t r = y * g.stride;
+    float py = (y + 0.5f) / g.ry;
+    const f vpy = V::set1(py);
+
+    for (int x = 0; x < g.rx; x ++) {
+        float px = (x + 0.5f) / g.rx;
+        const f vpx = V::set1(px);
+        ptrdiff_t i = r + (ptrdiff_t)x * K;
+
+        int k = k0;
+        for (; k + V::W <= k1; k += V::W) {
+            f dx = V::sub(vpx, V::load(ox + k)), dy = V::sub(vpy, V::load(oy + k));
+            f dist = V::sqrt(V::add(V::mul(dx, dx), V::mul(dy, dy)));
+            V::store(u + i + k, V::add(V::load(u + i + k), V::div(V::load(fx + k), dist)));
+            V::store(v + i + k, V::add(V::load(v + i + k), V::div(V::load(fy + k), dist)));
+        }
+        for (; k < k1; k ++)
+            forceLanePoint(u, v, i + k, px, py, fx[k], fy[k], ox[k], oy[k]);
+    }
+}
+
+template<class V>
+EnsembleKernels makeEnsembleKernels(Isa isa) {
+    EnsembleKernels k;
+    k.isa = isa;
+    k.width = V::W;
+    k.jacobi = jacobiLanesT<V>;
+    k.divergence = divergenceLanesT<V>;
+    k.gradient = gradientLanesT<V>;
+    k.advect = advectLanesT<V>;
+    k.force = forceLanesT<V>;
+    return k;
+}
+
+/*
+Lattice Boltzmann body. Each of the nine populations is pulled from its own neighbor, which is a shifted run of the same row of that
+plane, so the loads are unaligned but contiguous and a register holds W texels of one population; the collision is texel by texel
+arithmetic on the nine registers.
+*/
+
+template<class V>
+void collideStreamT(float* const* out, const float* const* f, float* u, float* v, const Grid& g, int y0, int y1, float omega, float sx, float sy) {
+    typedef typename V::f vf;
+    const vf vo = V::set1(omega), vsx = V::set1(sx), vsy = V::set1(sy);
+    for (int y = y0; y < y1; y ++) {
+        const float* src[9];
+        float* dst[9];
+        for (int i = 0; i < 9; i ++) {
+            src[i] = f[i] + (y - LBM_CY[i]) * g.stride - LBM_CX[i];
+            dst[i] = out[i] + y * g.stride;
+        }
+
+        int x = 0;
+        for (; x + V::W <= g.rx; x += V::W) {
+            vf p[9], ux, uy;
+            for (int i = 0; i < 9; i ++)
+                p[i] = V::load(src[i] + x);
+            latticeCollide<V>(p, vo, &ux, &uy);
+            for (int i = 0; i < 9; i ++)
+                V::store(dst[i] + x, p[i]);
+            if (u != NULL) {
+                V::store(u + y * g.stride + x, V::mul(ux, vsx));
+                V::store(v + y * g.stride + x, V::mul(uy, vsy));
+            }
+        }
+        for (; x < g.rx; x ++)
+            latticePoint(out, f, u, v, g, x, y, omega, sx, sy);
+    }
+}
+
+template<class V>
+void kickT(float* const* f, const Grid& g, int y0, int y1, float fx, float fy, float ox, float oy, float maxSpeed) {
+    typedef typename V::f vf;
+    const vf half = V::set1(0.5f), vrx = V::set1((float)g.rx);
+    for (int y = y0; y < y1; y ++) {
+        const vf py = V::set1((y + 0.5f) / g.ry);
+        ptrdiff_t r = y * g.stride;
+
+        int x = 0;
+        for (; x + V::W <= g.rx; x += V::W) {
+            vf p[9];
+            for (int i = 0; i < 9; i ++)
+                p[i] = V::load(f[i] + r + x);
+            latticeKick<V>(p, V::div(V::add(V::iota(x), half), vrx), py, fx, fy, ox, oy, maxSpeed);
+            for (int i = 0; i < 9; i ++)
+                V::store(f[i] + r + x, p[i]);
+        }
+        for (; x < g.rx; x ++)
+            latticeKickPoint(f, g, x, y, fx, fy, ox, oy, maxSpeed);
+    }
+}
+
+template<class V>
+LatticeKernels makeLatticeKernels(Isa isa) {
+    LatticeKernels k;
+    k.isa = isa;
+    k.collideStream = collideStreamT<V>;
+    k.kick = kickT<V>;
+    return k;
+}
+
+template<class V, typename S>
+void presentT(uint32_t* out, const S* const* q, int n) {
+    int x = 0;
+    for (; x + V::W <= n; x += V::W)
+        V::storeRGBA8(out + x, unorm8<V>(V::load(q[0] + x)), unorm8<V>(V::load(q[1] + x)), unorm8<V>(V::load(q[2] + x)));
+    for (; x < n; x ++)
+        out[x] = presentPoint(texel(q[0][x]), texel(q[1][x]), texel(q[2][x]));
+}
+
+template<class V>
+PresentKernels makePresentKernels(Isa isa) {
+    PresentKernels k;
+    k.isa = isa;
+    k.present = presentT<V, float>;
+    k.presentHalf = presentT<V, Half>;
+    return k;
+}
+
+// n texels from float to half and back
+template<class V>
+void toHalfT(Half* out, const float* in, int n) {
+    int i = 0;
+    for (; i + V::W <= n; i += V::W)
+        V::store(out + i, V::load(in + i));
+    for (; i < n; i ++)
+        out[i] = floatToHalf(in[i]);
+}
+
+template<class V>
+void fromHalfT(float* out, const Half* in, int n) {
+    int i = 0;
+    for (; i + V::W <= n; i += V::W)
+        V::store(out + i, V::load(in + i));
+    for (; i < n; i ++)
+        out[i] = halfToFloat(in[i]);
+}
+
+// builds the kernel table of one instruction set from its traits, generic (N = 0) or for planes of width and stride N
+template<class V, int N = 0>
+StencilKernels makeKernels(Isa isa) {
+    StencilKernels k;
+    k.isa = isa;
+    k.width = N;
+    k.jacobi = jacobiT<V, N>;
+    k.divergence = divergenceT<V, N>;
+    k.gradient = gradientT<V, N>;
+    k.advect = advectT<V, N>;
+    k.jacobiRow = jacobiRowT<V, N>;
+    k.divergenceRow = divergenceRowT<V, N>;
+    return k;
+}
+
+// the generic table, or the one specialized for width rx if it is one of STENCIL_SIZES
+template<class V>
+const StencilKernels& makeSizedKernels(Isa isa, int rx) {
+    static const StencilKernels k = makeKernels<V>(isa);
+    static const StencilKernels k512 = makeKernels<V, 512>(isa);
+    static const StencilKernels k1024 = makeKernels<V, 1024>(isa);
+    static const StencilKernels k2048 = makeKernels<V, 2048>(isa);
+    switch (rx) {
+        case 512: return k512;
+        case 1024: return k1024;
+        case 2048: return k2048;
+        default: return k;
+    }
+}
+
+// the half storage table; generic widths only
+template<class V>
+HalfKernels makeHalfKernels(Isa isa) {
+    HalfKernels k;
+    k.isa = isa;
+    k.jacobi = jacobiT<V, 0, Half>;
+    k.divergence = divergenceT<V, 0, Half>;
+    k.gradient = gradientT<V, 0, Half>;
+    k.advect = advectT<V, 0, Half>;
+    k.toHalf = toHalfT<V>;
+    k.fromHalf = fromHalfT<V>;
+    return k;
+}
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file stencilSSE42.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief SSE4.2 kernels (4 lanes)
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include <cmath>
+#include <ostream>
+#include <string>
+
+#include "field.h"
+#include "half.h"
+#include "stencil.h"
+
+#ifdef STENCIL_X86
+
+// gcc and clang only emit SSE4.2 instructions in functions compiled for it; msvc allows the intrinsics everywhere
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse4.2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC target("sse4.2")
+#endif
+
+#include <immintrin.h>
+
+#define STENCIL_VECTOR
+#include "stencilImpl.h"
+
+namespace {
+
+struct V {
+    static const int W = 4;
+    typedef __m128 f;
+
+    struct Tap {
+        int idx[4];
+        int mask;
+    };
+
+    static f load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, f a) { _mm_storeu_ps(p, a); }
+    // no F16C before AVX; Halfs are converted one by one
+    static f load(const Half* p) { return _mm_setr_ps(halfToFloat(p[0]), halfToFloat(p[1]), halfToFloat(p[2]), halfToFloat(p[3])); }
+    static void store(Half* p, f a) {
+        float t[4];
+        _mm_storeu_ps(t, a);
+        for (int i = 0; i < 4; i ++)
+            p[i] = floatToHalf(t[i]);
+    }
+    static f set1(float a) { return _mm_set1_ps(a); }
+    static f iota(int i) { return _mm_add_ps(_mm_set1_ps((float)i), _mm_setr_ps(0, 1, 2, 3)); }
+    static f add(f a, f b) { return _mm_add_ps(a, b); }
+    static f sub(f a, f b) { return _mm_sub_ps(a, b); }
+    static f mul(f a, f b) { return _mm_mul_ps(a, b); }
+    static f floor(f a) { return _mm_floor_ps(a); }
+    static f div(f a, f b) { return _mm_div_ps(a, b); }
+    static f sqrt(f a) { return _mm_sqrt_ps(a); }
+    static f min(f a, f b) { return _mm_min_ps(a, b); }
+    static f max(f a, f b) { return _mm_max_ps(a, b); }
+    static void storeRGBA8(uint32_t* p, f r, f g, f b) {
+        __m128i c = _mm_or_si128(_mm_cvttps_epi32(r), _mm_slli_epi32(_mm_cvttps_epi32(g), 8));
+        c = _mm_or_si128(_mm_or_si128(c, _mm_slli_epi32(_mm_cvttps_epi32(b), 16)), _mm_set1_epi32((int)0xff000000));
+        _mm_storeu_si128((__m128i*)p, c);
+    }
+
+    static Tap tap(f fx, f fy, const Grid& g) {
+        const f zero = _mm_setzero_ps();
+        f inX = _mm_and_ps(_mm_cmpge_ps(fx, zero), _mm_cmplt_ps(fx, _mm_set1_ps((float)g.rx)));
+        f inY = _mm_and_ps(_mm_cmpge_ps(fy, zero), _mm_cmplt_ps(fy, _mm_set1_ps((float)g.ry)));
+
+        Tap t;
+        t.mask = _mm_movemask_ps(_mm_and_ps(inX, inY));
+        __m128i idx = _mm_add_epi32(_mm_mullo_epi32(_mm_cvttps_epi32(fy), _mm_set1_epi32((int)g.stride)), _mm_cvttps_epi32(fx));
+        _mm_storeu_si128((__m128i*)t.idx, idx);
+        return t;
+    }
+
+    // no gather instruction before AVX2; lanes are loaded one by one
+    static f gather(const float* q, const Tap& t) {
+        return _mm_setr_ps(
+            (t.mask & 1) ? q[t.idx[0]] : 0.0f,
+            (t.mask & 2) ? q[t.idx[1]] : 0.0f,
+            (t.mask & 4) ? q[t.idx[2]] : 0.0f,
+            (t.mask & 8) ? q[t.idx[3]] : 0.0f
+        );
+    }
+    static f gather(const Half* q, const Tap& t) {
+        return _mm_setr_ps(
+            (t.mask & 1) ? halfToFloat(q[t.idx[0]]) : 0.0f,
+            (t.mask & 2) ? halfToFloat(q[t.idx[1]]) : 0.0f,
+            (t.mask & 4) ? halfToFloat(q[t.idx[2]]) : 0.0f,
+            (t.mask & 8) ? halfToFloat(q[t.idx[3]]) : 0.0f
+        );
+    }
+};
+
+}
+
+const StencilKernels& sse42Kernels(int rx) {
+    return makeSizedKernels<V>(Isa::SSE42, rx);
+}
+
+const HalfKernels& sse42HalfKernels() {
+    static const HalfKernels k = makeHalfKernels<V>(Isa::SSE42);
+    return k;
+}
+
+const EnsembleKernels& sse42EnsembleKernels() {
+    static const EnsembleKernels k = makeEnsembleKernels<V>(Isa::SSE42);
+    return k;
+}
+
+const LatticeKernels& sse42LatticeKernels() {
+    static const LatticeKernels k = makeLatticeKernels<V>(Isa::SSE42);
+    return k;
+}
+
+const PresentKernels& sse42PresentKernels() {
+    static const PresentKernels k = makePresentKernels<V>(Isa::SSE42);
+    return k;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#endif
+
+#endif
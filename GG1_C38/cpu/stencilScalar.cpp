@@ -0,0 +1,208 @@
+/**
+ * @file stencilScalar.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Scalar reference kernels. The specs read tap by tap like the shaders; the vector kernels are validated against these
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "stencilImpl.h"
+
+namespace {
+
+/*
+The specs of stencilSpec.h read through texture() with GL_NEAREST and GL_CLAMP_TO_BORDER (black border): TexTaps holds the rows
+y - 1, y, y + 1 of every input, NULL for rows outside the grid, and checks the columns; a tap is lane k of K lanes per texel. The ghost cells
+are never read, so these are the reference for any border the kernels' callers set up.
+*/
+template<typename S, int NIN, int NARG>
+struct TexTaps {
+    const S* p[NIN][3];
+    int rx, K, k;
+    float a[NARG > 0 ? NARG : 1];
+
+    // input i around row y of a plane
+    void plane(int i, const S* q, const Grid& g, int y) {
+        for (int dy = -1; dy <= 1; dy ++)
+            p[i][dy + 1] = (y + dy < 0 || y + dy >= g.ry) ? NULL : q + (y + dy) * g.stride;
+    }
+
+    template<class O, int I, int DX, int DY>
+    float read(ptrdiff_t x) const {
+        const S* r = p[I][DY + 1];
+        if (r == NULL || x + DX < 0 || x + DX >= rx)
+            return 0.0f;
+        return texel(r[(x + DX) * K + k]);
+    }
+    template<class O, int I>
+    float arg() const { return a[I]; }
+};
+
+// the planes hold floats, or Halfs that are widened on load and rounded on store like an RGBA16F render target
+template<typename S>
+void jacobi(S* out, const S* x, const S* b, const Grid& g, int y0, int y1, float alpha, float rbeta) {
+    TexTaps<S, JacobiSpec::inputs, JacobiSpec::args> t = { {}, g.rx, 1, 0, { alpha, rbeta } };
+    for (int y = y0; y < y1; y ++) {
+        t.plane(0, x, g, y);
+        t.plane(1, b, g, y);
+        for (int i = 0; i < g.rx; i ++)
+            put(out + y * g.stride + i, JacobiSpec::out::eval<ScalarOps>(t, i));
+    }
+}
+
+template<typename S>
+void divergence(S* out, const S* u, const S* v, const Grid& g, int y0, int y1, float scale) {
+    TexTaps<S, DivergenceSpec::inputs, DivergenceSpec::args> t = { {}, g.rx, 1, 0, { scale } };
+    for (int y = y0; y < y1; y ++) {
+        t.plane(0, u, g, y);
+        t.plane(1, v, g, y);
+        for (int i = 0; i < g.rx; i ++)
+            put(out + y * g.stride + i, DivergenceSpec::out::eval<ScalarOps>(t, i));
+    }
+}
+
+template<typename S>
+void gradient(S* outU, S* outV, const S* u, const S* v, const S* p, const Grid& g, int y0, int y1, float scale) {
+    TexTaps<S, GradientSpec::inputs, GradientSpec::args> t = { {}, g.rx, 1, 0, { scale } };
+    for (int y = y0; y < y1; y ++) {
+        t.plane(0, u, g, y);
+        t.plane(1, v, g, y);
+        t.plane(2, p, g, y);
+        for (int i = 0; i < g.rx; i ++) {
+            put(outU + y * g.stride + i, GradientSpec::outU::eval<ScalarOps>(t, i));
+            put(outV + y * g.stride + i, GradientSpec::outV::eval<ScalarOps>(t, i));
+        }
+    }
+}
+
+// single row forms; the same taps with the rows above and below given by pointer
+void jacobiRow(float* out, const float* xc, const float* xb, const float* xt, const float* bc, int rx, float alpha, float rbeta) {
+    TexTaps<float, JacobiSpec::inputs, JacobiSpec::args> t = { { { xb, xc, xt }, { NULL, bc, NULL } }, rx, 1, 0, { alpha, rbeta } };
+    for (int i = 0; i < rx; i ++)
+        out[i] = JacobiSpec::out::eval<ScalarOps>(t, i);
+}
+
+void divergenceRow(float* out, const float* uc, const float* vb, const float* vt, int rx, float scale) {
+    TexTaps<float, DivergenceSpec::inputs, DivergenceSpec::args> t = { { { NULL, uc, NULL }, { vb, NULL, vt } }, rx, 1, 0, { scale } };
+    for (int i = 0; i < rx; i ++)
+        out[i] = DivergenceSpec::out::eval<ScalarOps>(t, i);
+}
+
+template<typename S>
+void advect(S* const* out, const S* const* q, int nq, const S* u, const S* v, const Grid& g, int y0, int y1, int x0, int x1, float kx, float ky) {
+    for (int y = y0; y < y1; y ++)
+        for (int i = x0; i < x1; i ++)
+            advectPoint(out, q, nq, u, v, g, i, y, kx, ky);
+}
+
+// ensemble forms; the same taps on lane k of every texel, with the lane's own coefficients
+void jacobiLanes(float* out, const float* x, const float* b, const Grid& g, int K, int y0, int y1, const float* alpha, const float* rbeta) {
+    TexTaps<float, JacobiSpec::inputs, JacobiSpec::args> t = { {}, g.rx, K, 0, {} };
+    for (int y = y0; y < y1; y ++) {
+        t.plane(0, x, g, y);
+        t.plane(1, b, g, y);
+        for (int i = 0; i < g.rx; i ++) {
+            for (t.k = 0; t.k < K; t.k ++) {
+                t.a[0] = alpha[t.k];
+                t.a[1] = rbeta[t.k];
+                out[y * g.stride + (ptrdiff_t)i * K + t.k] = JacobiSpec::out::eval<ScalarOps>(t, i);
+            }
+        }
+    }
+}
+
+void divergenceLanes(float* out, const float* u, const float* v, const Grid& g, int K, int y0, int y1, float scale) {
+    TexTaps<float, DivergenceSpec::inputs, DivergenceSpec::args> t = { {}, g.rx, K, 0, { scale } };
+    for (int y = y0; y < y1; y ++) {
+        t.plane(0, u, g, y);
+        t.plane(1, v, g, y);
+        for (int i = 0; i < g.rx; i ++)
+            for (t.k = 0; t.k < K; t.k ++)
+                out[y * g.stride + (ptrdiff_t)i * K + t.k] = DivergenceSpec::out::eval<ScalarOps>(t, i);
+    }
+}
+
+void gradientLanes(float* outU, float* outV, const float* u, const float* v, const float* p, const Grid& g, int K, int y0, int y1, float scale) {
+    TexTaps<float, GradientSpec::inputs, GradientSpec::args> t = { {}, g.rx, K, 0, { scale } };
+    for (int y = y0; y < y1; y ++) {
+        t.plane(0, u, g, y);
+        t.plane(1, v, g, y);
+        t.plane(2, p, g, y);
+        for (int i = 0; i < g.rx; i ++) {
+            for (t.k = 0; t.k < K; t.k ++) {
+                ptrdiff_t c = y * g.stride + (ptrdiff_t)i * K + t.k;
+                outU[c] = GradientSpec::outU::eval<ScalarOps>(t, i);
+                outV[c] = GradientSpec::outV::eval<ScalarOps>(t, i);
+            }
+        }
+    }
+}
+
+void advectLanes(float* const* out, const float* const* q, int nq, const float* u, const float* v, const Grid& g, int K, int y0, int y1,
+    const float* kx, const float* ky) {
+    for (int y = y0; y < y1; y ++)
+        for (int i = 0; i < g.rx; i ++)
+            for (int k = 0; k < K; k ++)
+                advectLanePoint(out, q, nq, u, v, g, K, i, y, k, kx[k], ky[k]);
+}
+
+void forceLanes(float* u, float* v, const Grid& g, int K, int y, int k0, int k1, const float* fx, const float* fy, const float* ox, const float* oy) {
+    for (int x = 0; x < g.rx; x ++)
+        for (int k = k0; k < k1; k ++)
+            forceLanePoint(u, v, y * g.stride + (ptrdiff_t)x * K + k, (x + 0.5f) / g.rx, (y + 0.5f) / g.ry, fx[k], fy[k], ox[k], oy[k]);
+}
+
+void collideStream(float* const* out, const float* const* f, float* u, float* v, const Grid& g, int y0, int y1, float omega, float sx, float sy) {
+    for (int y = y0; y < y1; y ++)
+        for (int x = 0; x < g.rx; x ++)
+            latticePoint(out, f, u, v, g, x, y, omega, sx, sy);
+}
+
+void kick(float* const* f, const Grid& g, int y0, int y1, float fx, float fy, float ox, float oy, float maxSpeed) {
+    for (int y = y0; y < y1; y ++)
+        for (int x = 0; x < g.rx; x ++)
+            latticeKickPoint(f, g, x, y, fx, fy, ox, oy, maxSpeed);
+}
+
+template<typename S>
+void present(uint32_t* out, const S* const* q, int n) {
+    for (int x = 0; x < n; x ++)
+        out[x] = presentPoint(texel(q[0][x]), texel(q[1][x]), texel(q[2][x]));
+}
+
+void toHalf(Half* out, const float* in, int n) {
+    for (int i = 0; i < n; i ++)
+        out[i] = floatToHalf(in[i]);
+}
+
+void fromHalf(float* out, const Half* in, int n) {
+    for (int i = 0; i < n; i ++)
+        out[i] = halfToFloat(in[i]);
+}
+
+}
+
+const StencilKernels& scalarKernels() {
+    static const StencilKernels k = { Isa::Scalar, 0, jacobi<float>, divergence<float>, gradient<float>, advect<float>, jacobiRow, divergenceRow };
+    return k;
+}
+
+const HalfKernels& scalarHalfKernels() {
+    static const HalfKernels k = { Isa::Scalar, jacobi<Half>, divergence<Half>, gradient<Half>, advect<Half>, toHalf, fromHalf };
+    return k;
+}
+
+const EnsembleKernels& scalarEnsembleKernels() {
+    static const EnsembleKernels k = { Isa::Scalar, 1, jacobiLanes, divergenceLanes, gradientLanes, advectLanes, forceLanes };
+    return k;
+}
+
+const LatticeKernels& scalarLatticeKernels() {
+    static const LatticeKernels k = { Isa::Scalar, collideStream, kick };
+    return k;
+}
+
+const PresentKernels& scalarPresentKernels() {
+    static const PresentKernels k = { Isa::Scalar, present<float>, present<Half> };
+    return k;
+}
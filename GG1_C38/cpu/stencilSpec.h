@@ -0,0 +1,178 @@
+/**
+ * @file stencilSpec.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Single definitions of the jacobi, divergence, gradient and advection stencils, from which both the GLSL pass bodies and the CPU kernels are generated
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_STENCIL_SPEC_H
+#define CPU_STENCIL_SPEC_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+/*
+A stencil is written once here, as a type: a tree of taps, arguments and constants joined by +, - and *,
+
+    SpTap<k, dx, dy>    input k read dx texels to the right and dy texels up; |dx|, |dy| <= 1, the planes' ghost cells
+    SpArg<k>            argument k of the pass (a uniform, or a kernel parameter)
+    SpConst<n, d>       the constant n / d
+    SpAdd<A, B>, SpSub<A, B>, SpMul<A, B>
+
+and every backend walks the same tree:
+    eval<O>(c, i)       evaluates it at column i with the operations of O (a vector traits struct V, or ScalarOps; see stencilImpl.h), reading
+                        the taps through a context c that knows where the planes are (c.read<O, k, dx, dy>(i), c.arg<O, k>())
+    glsl(o, n)          prints it as a GLSL expression, the taps as texture() reads around n.at (writeStencilGLSL)
+    uses(k, dx, dy)     whether it reads that tap, so that gathering contexts only compute the taps a stencil needs
+Operations are applied in the order of the tree, which fixes the rounding; every CPU backend evaluates the same order, so they stay bit
+identical to each other, and a change made here (fusing a pass, reordering a sum) reaches the shaders and every kernel table at once.
+
+Like stencilImpl.h, everything is in an anonymous namespace, since the vector translation units instantiate it for their own targets.
+*/
+
+/**
+ * @brief How a stencil's taps and arguments read in a shader
+ */
+struct SpGlsl {
+    const char* at;             // texture coordinates the taps are around
+    const char* tex[4];         // sampler of each input
+    const char* swizzle[4];     // component of each input read, or "" for the whole texel
+    const char* arg[4];         // expression of each argument, in parentheses unless it is a single name
+};
+
+namespace {
+
+// " + vec2(delx, 0)" etc., the offset of a tap in the style of the hand written shaders
+inline void spGlslOffset(std::ostream& o, int dx, int dy) {
+    if (dx == 0 && dy == 0)
+        return;
+    if (dy == 0)
+        o << (dx < 0 ? " - " : " + ") << "vec2(delx, 0)";
+    else if (dx == 0)
+        o << (dy < 0 ? " - " : " + ") << "vec2(0, dely)";
+    else
+        o << " + vec2(" << (dx < 0 ? "-" : "") << "delx, " << (dy < 0 ? "-" : "") << "dely)";
+}
+
+template<int K, int DX, int DY>
+struct SpTap {
+    static_assert(DX >= -1 && DX <= 1 && DY >= -1 && DY <= 1, "taps reach one texel, the planes' ghost cells");
+
+    template<class O, class C>
+    static typename O::f eval(const C& c, ptrdiff_t i) { return c.template read<O, K, DX, DY>(i); }
+    static constexpr bool uses(int k, int dx, int dy) { return k == K && dx == DX && dy == DY; }
+    static void glsl(std::ostream& o, const SpGlsl& n) {
+        o << "texture(" << n.tex[K] << ", " << n.at;
+        spGlslOffset(o, DX, DY);
+        o << ")" << n.swizzle[K];
+    }
+};
+
+template<int K>
+struct SpArg {
+    template<class O, class C>
+    static typename O::f eval(const C& c, ptrdiff_t) { return c.template arg<O, K>(); }
+    static constexpr bool uses(int, int, int) { return false; }
+    static void glsl(std::ostream& o, const SpGlsl& n) { o << n.arg[K]; }
+};
+
+template<int NUM, int DEN>
+struct SpConst {
+    template<class O, class C>
+    static typename O::f eval(const C&, ptrdiff_t) { return O::set1((float)NUM / (float)DEN); }
+    static constexpr bool uses(int, int, int) { return false; }
+    static void glsl(std::ostream& o, const SpGlsl&) { o << (float)NUM / (float)DEN; }
+};
+
+#define STENCIL_SPEC_OPERATOR(Name, op, fn) \
+    template<class A, class B> \
+    struct Name { \
+        template<class O, class C> \
+        static typename O::f eval(const C& c, ptrdiff_t i) { return O::fn(A::template eval<O>(c, i), B::template eval<O>(c, i)); } \
+        static constexpr bool uses(int k, int dx, int dy) { return A::uses(k, dx, dy) || B::uses(k, dx, dy); } \
+        static void glsl(std::ostream& o, const SpGlsl& n) { o << "("; A::glsl(o, n); o << " " #op " "; B::glsl(o, n); o << ")"; } \
+    };
+
+STENCIL_SPEC_OPERATOR(SpAdd, +, add)
+STENCIL_SPEC_OPERATOR(SpSub, -, sub)
+STENCIL_SPEC_OPERATOR(SpMul, *, mul)
+
+#undef STENCIL_SPEC_OPERATOR
+
+/**
+ * @brief jacobi() of math/stencils.fs; inputs x, b, arguments alpha, rbeta
+ *
+ * Poisson-pressure equation; x -> p, b -> del dot w, alpha -> -(delta x)^2, beta -> 4
+ * Viscous x,b -> u (velocity field), alpha = (delta x)^2/v delta t, beta -> 4 + alpha
+ */
+struct JacobiSpec {
+    enum { inputs = 2, args = 2 };
+    typedef SpTap<0, -1, 0> xL;
+    typedef SpTap<0, 1, 0> xR;
+    typedef SpTap<0, 0, -1> xB;
+    typedef SpTap<0, 0, 1> xT;
+    typedef SpTap<1, 0, 0> bC;
+
+    // (xL + xR + xB + xT + alpha * bC) * rbeta
+    typedef SpMul<SpAdd<SpAdd<SpAdd<SpAdd<xL, xR>, xB>, xT>, SpMul<SpArg<0>, bC>>, SpArg<1>> out;
+};
+
+/**
+ * @brief divergence() of math/stencils.fs; inputs u, v, argument scale = (res.x / res.y) * 0.5
+ */
+struct DivergenceSpec {
+    enum { inputs = 2, args = 1 };
+    typedef SpTap<0, -1, 0> uL;
+    typedef SpTap<0, 1, 0> uR;
+    typedef SpTap<1, 0, -1> vB;
+    typedef SpTap<1, 0, 1> vT;
+
+    // scale * ((uR - uL) + (vT - vB))
+    typedef SpMul<SpArg<0>, SpAdd<SpSub<uR, uL>, SpSub<vT, vB>>> out;
+};
+
+/**
+ * @brief gradient() of math/stencils.fs; inputs u, v, p, argument scale = (res.x / res.y) * 0.5
+ */
+struct GradientSpec {
+    enum { inputs = 3, args = 1 };
+    typedef SpTap<2, -1, 0> pL;
+    typedef SpTap<2, 1, 0> pR;
+    typedef SpTap<2, 0, -1> pB;
+    typedef SpTap<2, 0, 1> pT;
+
+    // (u, v) - scale * (pR - pL, pT - pB)
+    typedef SpSub<SpTap<0, 0, 0>, SpMul<SpArg<0>, SpSub<pR, pL>>> outU;
+    typedef SpSub<SpTap<1, 0, 0>, SpMul<SpArg<0>, SpSub<pT, pB>>> outV;
+};
+
+/**
+ * @brief The average of advect() in math/stencils.fs; input q, its taps around the backtraced position rather than the texel. Where that
+ * position is, and how a tap between texels is sampled, is up to the backend (the CPU kernels floor it and read nearest neighbors)
+ */
+struct AdvectSpec {
+    enum { inputs = 1, args = 0 };
+    typedef SpTap<0, -1, 0> xL;
+    typedef SpTap<0, 1, 0> xR;
+    typedef SpTap<0, 0, -1> xB;
+    typedef SpTap<0, 0, 1> xT;
+
+    // ((xL + xR) + (xB + xT)) * 0.25
+    typedef SpMul<SpAdd<SpAdd<xL, xR>, SpAdd<xB, xT>>, SpConst<1, 4>> out;
+};
+
+}
+
+// prints the GLSL functions jacobi(), divergence(), gradient() and advect() generated from the specs above
+void writeStencilGLSL(std::ostream& o);
+
+// writes them to path (math/stencils.fs, included by the step shaders) if it does not already hold them; a tool step (--gen-glsl),
+// whose output is checked in
+void writeStencilGLSL(const std::string& path);
+
+// whether path holds them; the program only checks this at startup, it never rewrites its sources
+bool stencilGLSLCurrent(const std::string& path);
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file tileStore.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief File backed storage for the CPU engine's planes, for grids larger than memory: each plane a mapped file, streamed through in
+ * tiles of rows
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "tileStore.h"
+
+#include <cstdio>
+#include <iostream>
+#include <new>
+
+TileStore::TileStore(const char* dir) : dir(dir) {}
+
+TileStore::~TileStore() {
+    for (Plane& p : planes)
+        unmapFile(&p.file, true);
+}
+
+/**
+ * @brief Creates dir/name.plane at bytes of zeros and maps it; the ghost rows stay 0, which is what Border::Zero reads
+ */
+void* TileStore::place(const char* name, size_t bytes, size_t rowBytes, int halo) {
+    Plane p;
+    p.name = name;
+    p.rowBytes = rowBytes;
+    p.halo = halo;
+    std::string path = dir + "/" + name + ".plane";
+    if (!mapFile(path, bytes, &p.file)) {
+        std::cout << "could not map " << path << "\n";
+        throw std::bad_alloc();
+    }
+    planes.push_back(p);
+    return p.file.base;
+}
+
+void TileStore::prefetch(int y0, int y1) {
+    if (y1 <= y0)
+        return;
+    for (const Plane& p : planes)
+        prefetchFile(p.file, (size_t)(p.halo + y0) * p.rowBytes, (size_t)(y1 - y0) * p.rowBytes);
+}
+
+void TileStore::evict(int y0, int y1) {
+    if (y1 <= y0)
+        return;
+    for (const Plane& p : planes)
+        evictFile(p.file, (size_t)(p.halo + y0) * p.rowBytes, (size_t)(y1 - y0) * p.rowBytes);
+}
+
+size_t TileStore::rowBytes() const {
+    size_t total = 0;
+    for (const Plane& p : planes)
+        total += p.rowBytes;
+    return total;
+}
+
+size_t TileStore::fileBytes() const {
+    size_t total = 0;
+    for (const Plane& p : planes)
+        total += p.file.bytes;
+    return total;
+}
+
+void TileStore::report(std::ostream& out) const {
+    char line[256];
+    snprintf(line, sizeof(line), "CPU fields: %d planes, %.1f MB in files under %s\n", (int)planes.size(), fileBytes() / 1048576.0, dir.c_str());
+    out << line;
+}
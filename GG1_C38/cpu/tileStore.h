@@ -0,0 +1,77 @@
+/**
+ * @file tileStore.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief File backed storage for the CPU engine's planes, for grids larger than memory: each plane a mapped file, streamed through in
+ * tiles of rows
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef CPU_TILE_STORE_H
+#define CPU_TILE_STORE_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../../util/mappedFile.h"
+#include "field.h"
+
+/*
+Planes made here are views over files in a directory (mappedFile.h), one file per plane, laid out like any other Field so the kernels
+run on them unchanged. The tiles the out-of-core engine streams are bands of whole rows rather than squares: a band is one contiguous
+range of every file, so reading a tile ahead and writing one back are each a single sequential transfer per plane, and a stencil tile
+needs nothing from its neighbors but a row above and below.
+
+prefetch() and evict() apply to the same rows of every plane; the owner (CpuFluid's wavefront, see wavefront.h) reads the rows ahead
+of its front in and drops the rows behind its last pass, so only a window of rows of each plane is resident at a time. The files are
+removed with the store.
+*/
+
+class TileStore {
+    public:
+        // planes go in dir, which must exist; the files are named after the planes
+        explicit TileStore(const char* dir);
+        ~TileStore();
+
+        TileStore(const TileStore&) = delete;
+        TileStore& operator=(const TileStore&) = delete;
+
+        // a zeroed rx by ry plane backed by a file the store owns; name labels the file and the plane in report(). Throws std::bad_alloc
+        // if the file cannot be created or mapped
+        template<typename T>
+        Field<T> make(const char* name, int rx, int ry, int halo = 1) {
+            void* p = place(name, Field<T>::bytes(rx, ry, halo), sizeof(T) * fieldStride(rx, halo, sizeof(T)), halo);
+            return Field<T>(rx, ry, halo, p);
+        }
+
+        // reads interior rows [y0, y1) of every plane ahead
+        void prefetch(int y0, int y1);
+
+        // writes interior rows [y0, y1) of every plane back and drops them from memory
+        void evict(int y0, int y1);
+
+        // bytes of one row of every plane together
+        size_t rowBytes() const;
+
+        // bytes of every file together
+        size_t fileBytes() const;
+
+        void report(std::ostream& out) const;
+
+    private:
+        struct Plane {
+            const char* name;
+            MappedFile file;
+            size_t rowBytes;
+            int halo;
+        };
+
+        void* place(const char* name, size_t bytes, size_t rowBytes, int halo);
+
+        std::string dir;
+        std::vector<Plane> planes;
+};
+
+#endif
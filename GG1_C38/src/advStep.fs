@@ -27,7 +27,7 @@ float delx = 1 / res.x;
 float dely = 1 / res.y;
 
 #include math/constants.fs
-#include math/advection.fs
+#include math/stencils.fs
 
 void main() {
     vec4 force = vec4(0);
@@ -27,7 +27,7 @@ float delx = 1 / res.x;
 float dely = 1 / res.y;
 
 #include math/constants.fs
-#include math/math.fs
+#include math/stencils.fs
 
 void main() {
     gradient(uv, fragColor, prsTex, velTex);
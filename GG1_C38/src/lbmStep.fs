@@ -0,0 +1,87 @@
+/**
+ * @file lbmStep.fs
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Lattice Boltzmann (D2Q9) step; collide and stream in one pass, replacing the force, diffusion and projection steps
+ * @version 0.1
+ * @date 2026-10-18
+ */
+#version 430 core
+
+layout (location = 0) out vec4 popA;
+layout (location = 1) out vec4 popB;
+layout (location = 2) out vec4 popC;
+layout (location = 3) out vec4 velOut;
+
+in vec2 uv;
+
+uniform int frame;
+uniform float dt;
+uniform vec2 res; // window resolution
+uniform vec2 mpos; // current mouse position
+uniform vec2 rel; // relative mouse movement (in pixels)
+uniform int mDown; // if 0 mouse is up, else, mouse is down
+
+uniform sampler2D velTex; // velocity texture
+uniform sampler2D tmpTex; // temporary texture
+uniform sampler2D prsTex; // pressure texture
+uniform sampler2D qntTex; // quantity texture
+
+uniform sampler2D popATex; // populations 1 to 4
+uniform sampler2D popBTex; // populations 5 to 8
+uniform sampler2D popCTex; // population 0
+uniform int kick; // if 0 the mouse force was already applied this frame
+
+float delx = 1 / res.x;
+float dely = 1 / res.y;
+
+#include math/constants.fs
+#include math/force.fs
+#include math/lattice.fs
+
+void main() {
+    ivec2 t = ivec2(gl_FragCoord.xy);
+    ivec2 size = ivec2(res);
+
+    // stream; a population that would come from outside the grid is the opposite one leaving this texel, bounced back by the wall
+    float f[9];
+    for (int i = 0; i < 9; i ++) {
+        ivec2 s = t - LBM_C[i];
+        if (any(lessThan(s, ivec2(0))) || any(greaterThanEqual(s, size)))
+            f[i] = population(t, LBM_OPP[i]);
+        else
+            f[i] = population(s, i);
+    }
+
+    float rho = 0;
+    vec2 u = vec2(0);
+    for (int i = 0; i < 9; i ++) {
+        rho += f[i];
+        u += vec2(LBM_C[i]) * f[i];
+    }
+    u /= rho;
+
+    // the force of frcStep.fs in lattice units, once per frame; the populations move to the equilibrium of the kicked velocity
+    vec2 scale = latticeScale();
+    if (kick != 0 && mDown != 0) {
+        vec4 force;
+        applyForce(uv, force, 0.5);
+        vec2 target = u + force.xy * scale;
+        float speed = length(target);
+        if (speed > LBM_MAXSPEED)
+            target *= LBM_MAXSPEED / speed;
+        for (int i = 0; i < 9; i ++)
+            f[i] += equilibrium(i, rho, target) - equilibrium(i, rho, u);
+        u = target;
+    }
+
+    // collide
+    for (int i = 0; i < 9; i ++)
+        f[i] += (equilibrium(i, rho, u) - f[i]) / LBM_TAU;
+
+    popA = vec4(f[1], f[2], f[3], f[4]);
+    popB = vec4(f[5], f[6], f[7], f[8]);
+    popC = vec4(f[0], rho, 0, 1);
+
+    // the velocity advStep.fs reads; LBM_SUBSTEPS steps move the dye dt * (res.x / res.y) * res * vel texels
+    velOut = vec4(scale.x > 0 ? u / scale : vec2(0), 0, 1);
+}
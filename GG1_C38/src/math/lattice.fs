@@ -0,0 +1,47 @@
+/**
+ * @file lattice.fs
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Constants and equilibrium of the D2Q9 lattice Boltzmann step
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+/*
+Nine populations per texel, f_i moving along c_i, packed into three RGBA32F textures: popA = (f1, f2, f3, f4), popB = (f5, f6, f7, f8)
+and popC = (f0, rho, 0, 1). Density and momentum are their sums,
+
+rho = sum f_i, rho u = sum c_i f_i
+
+and a step streams every f_i one texel along c_i, then relaxes it towards
+
+feq_i = w_i rho (1 + 3 c_i.u + 4.5 (c_i.u)^2 - 1.5 |u|^2)
+
+by 1 / TAU. The lattice viscosity is (TAU - 0.5) / 3 texels squared per step.
+*/
+
+#define LBM_TAU 0.6
+#define LBM_SUBSTEPS 4
+#define LBM_MAXSPEED 0.2
+
+const ivec2 LBM_C[9] = ivec2[9](ivec2(0, 0), ivec2(1, 0), ivec2(0, 1), ivec2(-1, 0), ivec2(0, -1), ivec2(1, 1), ivec2(-1, 1), ivec2(-1, -1), ivec2(1, -1));
+const float LBM_W[9] = float[9](4.0 / 9, 1.0 / 9, 1.0 / 9, 1.0 / 9, 1.0 / 9, 1.0 / 36, 1.0 / 36, 1.0 / 36, 1.0 / 36);
+const int LBM_OPP[9] = int[9](0, 3, 4, 1, 2, 7, 8, 5, 6);
+
+// population i of texel t
+float population(ivec2 t, int i) {
+    if (i == 0)
+        return texelFetch(popCTex, t, 0).x;
+    if (i < 5)
+        return texelFetch(popATex, t, 0)[i - 1];
+    return texelFetch(popBTex, t, 0)[i - 5];
+}
+
+float equilibrium(int i, float rho, vec2 u) {
+    float cu = 3 * dot(vec2(LBM_C[i]), u);
+    return LBM_W[i] * rho * (1 - 1.5 * dot(u, u) + cu + 0.5 * cu * cu);
+}
+
+// texels per lattice step that a velocity of 1 (in the uv units advect() reads) moves the dye by
+vec2 latticeScale() {
+    return dt * (res.x / res.y) * res / LBM_SUBSTEPS;
+}
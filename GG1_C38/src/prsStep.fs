@@ -27,7 +27,7 @@ float delx = 1 / res.x;
 float dely = 1 / res.y;
 
 #include math/constants.fs
-#include math/math.fs
+#include math/stencils.fs
 
 void main() {
     // has to be iterated ~40 times on the cpu (texture has to be updated (ping ponged) each time)
@@ -8,20 +8,53 @@
 
 #include "GG1_C38_handler.h"
 
-GG1_C38_Handler::GG1_C38_Handler() {
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "util/threadPool.h"
+#include "GG1_C38/cpu/stencilSpec.h"
+
+GG1_C38_Handler::GG1_C38_Handler(bool cpu, int threads, CpuOptions opts, bool lbm, bool threaded)
+    : cpu(cpu), threads(threads), opts(opts), lbm(lbm), threaded(threaded) {
     wDown = false; aDown = false; sDown = false; dDown = false; spDown = false; shDown = false; enDown = false;
     mouseDown = false;
+    relX = 0; relY = 0; orgX = 0; orgY = 0;
+    inputTaken = false;
+    stepIn = FluidInput();
 
     curPrs = NULL; curVel = NULL; curQnt = NULL;
     nxtPrs = NULL; nxtVel = NULL; nxtQnt = NULL;
+    stream = NULL;
+    pool = NULL;
+    cpuFluid = NULL;
+    lbmFluid = NULL;
+    latStep = NULL;
+    curPop = 0;
+    latFBO = 0;
+    quadVAO = quadVBO = 0;
 }
 
 GG1_C38_Handler::~GG1_C38_Handler() {
-    
+    if (simThread.joinable()) {
+        simRunning = false;
+        simThread.join();
+    }
+
+    // the engine first, then the executor it runs on, whose workers are stopped and joined; the upload ring while the context is current
+    delete cpuFluid;
+    delete lbmFluid;
+    delete pool;
+    delete stream;
 }
 
 void GG1_C38_Handler::objEventHandler() {
-    relX = 0; relY = 0;
+    // motion of frames that ran no step, or whose input the simulation thread had no room for, is kept for the next, so a drag is never
+    // dropped
+    if (inputTaken) {
+        relX = 0; relY = 0;
+    }
     SDL_Event m_event;
 	while(SDL_PollEvent(&m_event)) {
 		switch (m_event.type) {
@@ -90,8 +123,8 @@ void GG1_C38_Handler::objEventHandler() {
                 break;
             
             case SDL_MOUSEMOTION:
-                relX = m_event.motion.xrel; // λ
-                relY = m_event.motion.yrel;
+                relX += m_event.motion.xrel; // λ
+                relY += m_event.motion.yrel;
                 orgX = m_event.motion.x - relX; // ƶ֮ǰ
                 orgY = m_event.motion.y - relY; 
                 break;
@@ -109,17 +142,15 @@ void GG1_C38_Handler::objEventHandler() {
 
 void GG1_C38_Handler::setShader(Shader* shader) {
     glm::vec2 res = glm::vec2(kernel->getRX(), kernel->getRY());
-    glm::vec2 mpos = glm::vec2(orgX, res.y - orgY);
-    glm::vec2 rel = glm::vec2(relX, -relY);
     int mDown = mouseDown;
 
     shader->use();
     
-    shader->setInt("frame", frame);
+    shader->setInt("frame", stepIn.frame);
     shader->setFloat("dt", dt);
     shader->setVec2("res", res);
-    shader->setVec2("mpos", mpos);
-    shader->setVec2("rel", rel);
+    shader->setVec2("mpos", glm::vec2(stepIn.mx, stepIn.my));
+    shader->setVec2("rel", glm::vec2(stepIn.relx, stepIn.rely));
     shader->setInt("mDown", mDown);
 
     shader->setInt("velTex", 0);
@@ -144,12 +175,7 @@ void GG1_C38_Handler::advectionStep() {
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, curQnt->TEX);
 
-    glBegin(GL_POLYGON);
-		glVertex3f(-1, -1, 0);
-		glVertex3f(-1, 1, 0);
-		glVertex3f(1, 1, 0);
-		glVertex3f(1, -1, 0);
-	glEnd();
+    drawQuad();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -175,12 +201,7 @@ void GG1_C38_Handler::forceStep() {
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, curQnt->TEX);
 
-    glBegin(GL_POLYGON);
-		glVertex3f(-1, -1, 0);
-		glVertex3f(-1, 1, 0);
-		glVertex3f(1, 1, 0);
-		glVertex3f(1, -1, 0);
-	glEnd();
+    drawQuad();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -206,12 +227,7 @@ void GG1_C38_Handler::diffusionStep() {
         glActiveTexture(GL_TEXTURE3);
         glBindTexture(GL_TEXTURE_2D, curQnt->TEX);
 
-        glBegin(GL_POLYGON);
-            glVertex3f(-1, -1, 0);
-            glVertex3f(-1, 1, 0);
-            glVertex3f(1, 1, 0);
-            glVertex3f(1, -1, 0);
-        glEnd();
+        drawQuad();
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -237,12 +253,7 @@ void GG1_C38_Handler::divergenceStep() {
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, curQnt->TEX);
 
-    glBegin(GL_POLYGON);
-		glVertex3f(-1, -1, 0);
-		glVertex3f(-1, 1, 0);
-		glVertex3f(1, 1, 0);
-		glVertex3f(1, -1, 0);
-	glEnd();
+    drawQuad();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
@@ -264,12 +275,7 @@ void GG1_C38_Handler::pressureStep() {
         glActiveTexture(GL_TEXTURE3);
         glBindTexture(GL_TEXTURE_2D, curQnt->TEX);
 
-        glBegin(GL_POLYGON);
-            glVertex3f(-1, -1, 0);
-            glVertex3f(-1, 1, 0);
-            glVertex3f(1, 1, 0);
-            glVertex3f(1, -1, 0);
-        glEnd();
+        drawQuad();
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -295,12 +301,7 @@ void GG1_C38_Handler::gradientStep() {
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, curQnt->TEX);
 
-    glBegin(GL_POLYGON);
-		glVertex3f(-1, -1, 0);
-		glVertex3f(-1, 1, 0);
-		glVertex3f(1, 1, 0);
-		glVertex3f(1, -1, 0);
-	glEnd();
+    drawQuad();
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
@@ -309,14 +310,279 @@ void GG1_C38_Handler::gradientStep() {
     curVel = temp;
 }
 
+/**
+ * @brief Lattice Boltzmann steps in place of the force, diffusion and projection steps; each draws the next populations and the
+ * velocity at once, and the first also applies the mouse force
+ */
+void GG1_C38_Handler::latticeStep() {
+    GLenum targets[4] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3 };
+
+    for (int s = 0; s < CPU_LBM_SUBSTEPS; s ++) {
+        setShader(latStep);
+        latStep->setInt("popATex", 4);
+        latStep->setInt("popBTex", 5);
+        latStep->setInt("popCTex", 6);
+        latStep->setInt("kick", s == 0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, latFBO);
+        for (int j = 0; j < 3; j ++)
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + j, GL_TEXTURE_2D, pop[1 - curPop][j]->TEX, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT3, GL_TEXTURE_2D, nxtVel->TEX, 0);
+        glDrawBuffers(4, targets);
+
+        for (int j = 0; j < 3; j ++) {
+            glActiveTexture(GL_TEXTURE4 + j);
+            glBindTexture(GL_TEXTURE_2D, pop[curPop][j]->TEX);
+        }
+
+        drawQuad();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        curPop = 1 - curPop;
+        TexturePair* temp = nxtVel;
+        nxtVel = curVel;
+        curVel = temp;
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+/**
+ * @brief Maps the next slot of the upload ring for a CPU producer to write into
+ */
+float* GG1_C38_Handler::mapUpload() {
+    return stream->map();
+}
+
+/**
+ * @brief Uploads the mapped slot into the current velocity texture
+ */
+void GG1_C38_Handler::commitVelocity() {
+    stream->upload(curVel->TEX);
+}
+
+/**
+ * @brief Uploads the mapped slot into the current quantity (dye) texture
+ */
+void GG1_C38_Handler::commitQuantity() {
+    stream->upload(curQnt->TEX);
+}
+
+/**
+ * @brief The frame's input as the shaders see it: mpos where the frame's drag started, origin at the bottom left, and rel its motion
+ */
+FluidInput GG1_C38_Handler::frameInput() {
+    FluidInput in;
+    in.frame = 0;
+    in.dt = dt;
+    in.mx = (float)orgX;
+    in.my = (float)(kernel->getRY() - orgY);
+    in.relx = (float)relX;
+    in.rely = (float)-relY;
+    in.mDown = mouseDown;
+    return in;
+}
+
+/**
+ * @brief Input of step k of the n a frame with input in runs; the drag is split evenly over them, each moving the cursor on by its share,
+ * so the force and dye a drag puts in do not depend on how many steps the frame took
+ */
+FluidInput GG1_C38_Handler::stepInput(const FluidInput& in, int k, int n) {
+    FluidInput s = in;
+    s.frame = ++ steps;
+    s.dt = dt;
+    s.mx = in.mx + in.relx * k / n;
+    s.my = in.my + in.rely * k / n;
+    s.relx = in.relx / n;
+    s.rely = in.rely / n;
+    return s;
+}
+
+/**
+ * @brief Adds wall seconds to the simulation clock and returns how many fixed steps it has fallen behind, at most maxSubsteps
+ */
+int GG1_C38_Handler::advanceClock(float wall) {
+    accumulator += wall;
+    int n = (int)(accumulator / dt);
+    if (n > maxSubsteps) {
+        n = maxSubsteps;
+        accumulator = 0.0f;
+    } else {
+        accumulator -= n * dt;
+    }
+    return n;
+}
+
+void GG1_C38_Handler::stepEngine(const FluidInput& in) {
+    if (lbmFluid != NULL)
+        lbmFluid->step(in);
+    else
+        cpuFluid->step(in);
+}
+
+// the CPU engine's dye as texels in the order of the quantity texture, or as the pixels of a frame, top row first
+void GG1_C38_Handler::writeDye(float* rgba) {
+    if (lbmFluid != NULL)
+        lbmFluid->writeQuantity(rgba);
+    else
+        cpuFluid->writeQuantity(rgba);
+}
+
+void GG1_C38_Handler::presentDye(uint32_t* pixels, int pitch) {
+    if (lbmFluid != NULL)
+        lbmFluid->presentQuantity(pixels, pitch);
+    else
+        cpuFluid->presentQuantity(pixels, pitch);
+}
+
+/**
+ * @brief Runs this frame's steps of the CPU engine with the same inputs the shaders receive, and streams the dye into the current quantity
+ * texture, or in software mode writes it into the kernel's frame
+ */
+void GG1_C38_Handler::cpuStep() {
+    bool software = kernel->isSoftware();
+    if (threaded) {
+        presentPublished(software);
+        return;
+    }
+
+    FluidInput frameIn = frameInput();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < substeps; s ++)
+        stepEngine(stepInput(frameIn, s, substeps));
+
+    // the texture already holds the dye if no step ran; the software frame is rewritten every time it is locked
+    if (substeps == 0 && !software)
+        return;
+
+    // software mode writes the dye straight into the kernel's frame, otherwise into the upload ring
+    if (software)
+        presentDye(kernel->getPixels(), kernel->getPitch());
+    else
+        writeDye(mapUpload());
+    std::chrono::duration<float, std::milli> d = std::chrono::steady_clock::now() - t0;
+    simMs = d.count();
+    if (!software)
+        commitQuantity();
+}
+
+/**
+ * @brief The simulation thread of --threaded: drains the input the main thread queued, steps the engine on the fixed clock, and
+ * publishes each finished dye frame; it only sleeps until the next step is due, and never waits on the presenting thread
+ */
+void GG1_C38_Handler::simLoop(bool software, int rx) {
+    // the engine's executor, with this thread as its slot 0, and its planes are made here, so pinning and first touch are this thread's
+    createEngine();
+
+    FluidInput frameIn = FluidInput();
+    auto lastT = std::chrono::steady_clock::now();
+
+    while (simRunning) {
+        // the drag still to apply starts where the first motion not yet stepped started, and the button is as last reported
+        FluidInput m;
+        while (inputs.pop(m)) {
+            if (frameIn.relx == 0.0f && frameIn.rely == 0.0f) {
+                frameIn.mx = m.mx;
+                frameIn.my = m.my;
+            }
+            frameIn.relx += m.relx;
+            frameIn.rely += m.rely;
+            frameIn.mDown = m.mDown;
+        }
+
+        auto curT = std::chrono::steady_clock::now();
+        std::chrono::duration<float> diff = curT - lastT;
+        lastT = curT;
+        int n = advanceClock(diff.count());
+        if (n == 0) {
+            std::this_thread::sleep_for(std::chrono::duration<float>(dt - accumulator));
+            continue;
+        }
+
+        for (int s = 0; s < n; s ++)
+            stepEngine(stepInput(frameIn, s, n));
+        frameIn.mx += frameIn.relx;
+        frameIn.my += frameIn.rely;
+        frameIn.relx = frameIn.rely = 0.0f;
+
+        if (software) {
+            presentDye(framePixels.write(), rx * (int)sizeof(uint32_t));
+            framePixels.publish();
+        } else {
+            writeDye(frameTexels.write());
+            frameTexels.publish();
+        }
+        std::chrono::duration<float, std::milli> d = std::chrono::steady_clock::now() - curT;
+        simMs = d.count();
+        stepsDone.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Presents the latest frame the simulation thread published: copied into the kernel's frame (which must be rewritten whenever it
+ * is locked) or, if it is new, streamed into the quantity texture
+ */
+void GG1_C38_Handler::presentPublished(bool software) {
+    int rx = kernel->getRX();
+    int ry = kernel->getRY();
+
+    if (software) {
+        framePixels.acquire();
+        const uint32_t* src = framePixels.read();
+        char* dst = (char*)kernel->getPixels();
+        for (int y = 0; y < ry; y ++)
+            memcpy(dst + (size_t)y * kernel->getPitch(), src + (size_t)y * rx, rx * sizeof(uint32_t));
+        return;
+    }
+
+    if (!frameTexels.acquire())
+        return;
+    memcpy(mapUpload(), frameTexels.read(), (size_t)rx * ry * 4 * sizeof(float));
+    commitQuantity();
+}
+
 void GG1_C38_Handler::objRendererHandler() {
-    advectionStep();
-    forceStep();
-    diffusionStep();
-    divergenceStep();
-    pressureStep();
-    gradientStep();
+    // the CPU engine's dye is the whole frame; there is nothing to draw in GL
+    if (kernel->isSoftware()) {
+        cpuStep();
+        return;
+    }
+
+    if (cpu) {
+        cpuStep();
+    } else {
+        // timed on the GPU through a ring of queries, read back a few frames later so the CPU never waits for the result
+        glBeginQuery(GL_TIME_ELAPSED, simQuery[frame % SIM_QUERIES]);
+        FluidInput frameIn = frameInput();
+        for (int s = 0; s < substeps; s ++) {
+            stepIn = stepInput(frameIn, s, substeps);
+            advectionStep();
+            if (lbm) {
+                latticeStep();
+            } else {
+                forceStep();
+                diffusionStep();
+                divergenceStep();
+                pressureStep();
+                gradientStep();
+            }
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // the oldest query in the ring, if the GPU is done with it; otherwise the last time stands
+        GLuint oldest = simQuery[(frame + 1) % SIM_QUERIES];
+        GLuint available = 0;
+        if (frame >= SIM_QUERIES)
+            glGetQueryObjectuiv(oldest, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(oldest, GL_QUERY_RESULT, &ns);
+            simMs = ns / 1e6f;
+        }
+    }
 
+    // the window's framebuffer, or the kernel's offscreen one
+    glBindFramebuffer(GL_FRAMEBUFFER, kernel->getFramebuffer());
     glClear(GL_COLOR_BUFFER_BIT);
     setShader(fluidShader);
     
@@ -329,12 +595,19 @@ void GG1_C38_Handler::objRendererHandler() {
     glActiveTexture(GL_TEXTURE3);
     glBindTexture(GL_TEXTURE_2D, curQnt->TEX);
     
-    glBegin(GL_POLYGON);
-		glVertex3f(-1, -1, 0);
-		glVertex3f(-1, 1, 0);
-		glVertex3f(1, 1, 0);
-		glVertex3f(1, -1, 0);
-	glEnd();
+    drawQuad();
+}
+
+/**
+ * @brief Sets the simulation's fixed step and the most steps a frame may run to catch up with the clock
+ *
+ * @param dt Seconds of simulation per step; every step of every engine is taken with it
+ * @param maxSubsteps Steps a frame runs at most; time beyond that is dropped, so a slow frame slows the simulation instead of making every
+ * following frame slower still
+ */
+void GG1_C38_Handler::setTimestep(float dt, int maxSubsteps) {
+    this->dt = dt;
+    this->maxSubsteps = maxSubsteps;
 }
 
 void GG1_C38_Handler::objUpdateHandler() {
@@ -342,24 +615,116 @@ void GG1_C38_Handler::objUpdateHandler() {
     frame ++;
     auto curT = std::chrono::steady_clock::now();
     std::chrono::duration<float> diff = curT - lastT;
-    lastT = std::chrono::steady_clock::now();
-    dt = diff.count();
-    curFPS = (int)(1/dt);
+    lastT = curT;
+    float wall = diff.count();
+    curFPS = wall > 0.0f ? (int)(1/wall) : 0;
+
+    if (kernel->isHeadless()) {
+        // batch runs step the simulation clock instead of the wall clock, one fixed step a frame, as fast as the frames go
+        substeps = 1;
+        inputTaken = true;
+        scriptedInput();
+        return;
+    }
+
+    if (threaded) {
+        // the simulation thread keeps the clock; the frame's input goes to it, and the title shows the steps it ran since the last frame
+        inputTaken = inputs.push(frameInput());
+        int done = stepsDone.load(std::memory_order_relaxed);
+        substeps = done - shownSteps;
+        shownSteps = done;
+    } else {
+        // the simulation clock follows the wall clock in fixed steps, the remainder carried to the next frame
+        substeps = advanceClock(wall);
+        inputTaken = substeps > 0;
+    }
 
     // update title
-    string atitle = kernel->getTitle() + string(" - FPS: ") + std::to_string(curFPS) + string(" - Frame: ") + std::to_string(frame);
+    char sim[32];
+    snprintf(sim, sizeof(sim), "%.2f ms", simMs.load());
+    string atitle = kernel->getTitle() + string(lbm ? " (lattice)" : "") + string(" - FPS: ") + std::to_string(curFPS) + string(" - Frame: ")
+        + std::to_string(frame) + string(" - Steps: ") + std::to_string(substeps) + string(" - Sim: ") + string(sim);
     SDL_SetWindowTitle(kernel->getWindow(), atitle.c_str());
 }
 
+void GG1_C38_Handler::scriptedInput() {
+    int rx = kernel->getRX();
+    int ry = kernel->getRY();
+    float r = 0.25f * ry;
+    float a0 = 0.05f * (frame - 1);
+    float a1 = 0.05f * frame;
+
+    // window coordinates, top down, as SDL_MOUSEMOTION reports them
+    orgX = (int)(rx / 2 + r * std::cos(a0));
+    orgY = (int)(ry / 2 + r * std::sin(a0));
+    relX = (int)(rx / 2 + r * std::cos(a1)) - orgX;
+    relY = (int)(ry / 2 + r * std::sin(a1)) - orgY;
+    mouseDown = true;
+}
+
+void GG1_C38_Handler::drawQuad() {
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    glBindVertexArray(0);
+}
+
+/**
+ * @brief Creates the CPU engine's executor and the engine on the calling thread; a pinned pool pins it as slot 0, and the engine's planes
+ * are first touched by the pool's threads
+ */
+void GG1_C38_Handler::createEngine() {
+    int rx = kernel->getRX();
+    int ry = kernel->getRY();
+
+    pool = makeExecutor(opts.executor, threads, opts.pin);
+    if (pool == NULL) {
+        std::cout << "executor " << opts.executor << " not available in this build; using pool\n";
+        pool = new ThreadPool(threads, opts.pin);
+    }
+    if (lbm)
+        lbmFluid = new LbmFluid(rx, ry, pool);
+    else
+        cpuFluid = new CpuFluid(rx, ry, pool, opts);
+}
+
 void GG1_C38_Handler::objPreLoopStep() {
     lastT = std::chrono::steady_clock::now();
+    int rx = kernel->getRX();
+    int ry = kernel->getRY();
+
+    // with --threaded only the simulation thread creates and touches the engine and its executor
+    if (cpu && threaded) {
+        bool software = kernel->isSoftware();
+        if (software)
+            framePixels.resize((size_t)rx * ry);
+        else
+            frameTexels.resize((size_t)rx * ry * 4);
+        simRunning = true;
+        simThread = std::thread(&GG1_C38_Handler::simLoop, this, software, rx);
+    } else if (cpu) {
+        createEngine();
+    }
+
+    // the software path has no GL context; the engine writes its dye into the kernel's frame (cpuStep)
+    if (kernel->isSoftware())
+        return;
     
     // sets the clear color to black
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
+    // the full screen quad, fluid.vs's pos at attribute 0; a core context has no glBegin
+    float quad[8] = { -1, -1, -1, 1, 1, 1, 1, -1 };
+    glGenVertexArrays(1, &quadVAO);
+    glGenBuffers(1, &quadVBO);
+    glBindVertexArray(quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
     // setup FBO's
-    int rx = kernel->getRX();
-    int ry = kernel->getRY();
     vel1 = new TexturePair(rx, ry);
     vel2 = new TexturePair(rx, ry);
     tmp = new TexturePair(rx, ry);
@@ -372,7 +737,32 @@ void GG1_C38_Handler::objPreLoopStep() {
     curQnt = qnt1; nxtQnt = qnt2;
     curPrs = prs1; nxtPrs = prs2;
 
-    // setup fluid shaders
+    // upload ring for CPU side producers
+    stream = new StreamBuffer(rx, ry);
+    glGenQueries(SIM_QUERIES, simQuery);
+
+    // lattice populations at rest, each texture cleared to its populations' weights (and popC's density to 1)
+    if (lbm && !cpu) {
+        float rest[3][4] = {
+            { LBM_W[1], LBM_W[2], LBM_W[3], LBM_W[4] },
+            { LBM_W[5], LBM_W[6], LBM_W[7], LBM_W[8] },
+            { LBM_W[0], 1.0f, 0.0f, 1.0f }
+        };
+        for (int k = 0; k < 2; k ++) {
+            for (int j = 0; j < 3; j ++) {
+                pop[k][j] = new TexturePair(rx, ry, GL_RGBA32F);
+                glBindFramebuffer(GL_FRAMEBUFFER, pop[k][j]->FBO);
+                glClearBufferfv(GL_COLOR, 0, rest[j]);
+            }
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glGenFramebuffers(1, &latFBO);
+    }
+
+    // setup fluid shaders; the stencil bodies they include are generated (--gen-glsl) from the specs the CPU kernels are built from
+    if (!stencilGLSLCurrent("GG1_C38/src/math/stencils.fs"))
+        std::cout << "WARNING: GG1_C38/src/math/stencils.fs does not match GG1_C38/cpu/stencilSpec.h; the GPU and CPU stencils differ "
+            "until it is regenerated with --gen-glsl\n";
     string compilePath = "GG1_C38/compiled";
     string shaderVS = compileGLSL("GG1_C38/src/fluid.vs", compilePath);
     string shaderFS = compileGLSL("GG1_C38/src/fluid.fs", compilePath);
@@ -383,6 +773,7 @@ void GG1_C38_Handler::objPreLoopStep() {
     string divFS = compileGLSL("GG1_C38/src/divStep.fs", compilePath);
     string prsFS = compileGLSL("GG1_C38/src/prsStep.fs", compilePath);
     string grdFS = compileGLSL("GG1_C38/src/grdStep.fs", compilePath);
+    string latFS = compileGLSL("GG1_C38/src/lbmStep.fs", compilePath);
     
     advStep = new Shader(shaderVS.c_str(), advFS.c_str());
     frcStep = new Shader(shaderVS.c_str(), frcFS.c_str());
@@ -390,6 +781,7 @@ void GG1_C38_Handler::objPreLoopStep() {
     divStep = new Shader(shaderVS.c_str(), divFS.c_str());
     prsStep = new Shader(shaderVS.c_str(), prsFS.c_str());
     grdStep = new Shader(shaderVS.c_str(), grdFS.c_str());
+    latStep = new Shader(shaderVS.c_str(), latFS.c_str());
 
     fluidShader = new Shader(shaderVS.c_str(), shaderFS.c_str());
 }
\ No newline at end of file
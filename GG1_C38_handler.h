@@ -9,31 +9,40 @@
 #ifndef GG1_C38_HANDLER_H
 #define GG1_C38_HANDLER_H
 
+#include <atomic>
 #include <chrono>
 #include <cstdarg>
+#include <cstdint>
 #include <string>
+#include <thread>
 using std::string;
 
 #include "util/handler.h"
 #include "util/glslInclude.h"
+#include "util/spscQueue.h"
+#include "util/tripleBuffer.h"
 #include "objects/helper.h"
+#include "objects/streamBuffer.h"
+#include "GG1_C38/cpu/cpuFluid.h"
+#include "GG1_C38/cpu/lbmFluid.h"
 
 class TexturePair {
     public:
-        TexturePair(int rx, int ry) {
+        // format is the texture's internal format; the simulation's fields are RGBA16F, the lattice's populations need RGBA32F
+        TexturePair(int rx, int ry, GLenum format = GL_RGBA16F) {
             FBO = 0; TEX = 0;
-            setupFBO(rx, ry);
+            setupFBO(rx, ry, format);
         }
 
         GLuint FBO, TEX;
     private:
-        void setupFBO(int rx, int ry) {
+        void setupFBO(int rx, int ry, GLenum format) {
             cout << "setup: ";
             glGenFramebuffers(1, &FBO);
 
             glGenTextures(1, &TEX);
             glBindTexture(GL_TEXTURE_2D, TEX);
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, rx, ry, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, rx, ry, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
@@ -61,7 +70,7 @@ class TexturePair {
 
 class GG1_C38_Handler : public Handler {
     public:
-        GG1_C38_Handler();
+        GG1_C38_Handler(bool cpu = false, int threads = 0, CpuOptions opts = CpuOptions(), bool lbm = false, bool threaded = false);
         ~GG1_C38_Handler();
 
         void objEventHandler() override;
@@ -69,6 +78,14 @@ class GG1_C38_Handler : public Handler {
         void objUpdateHandler() override;
         void objPreLoopStep() override;
 
+        void setTimestep(float dt, int maxSubsteps);
+
+        // streaming of CPU produced fields into the simulation textures; write rx * ry RGBA texels into mapUpload(),
+        // then commit them into the current velocity or quantity texture
+        float* mapUpload();
+        void commitVelocity();
+        void commitQuantity();
+
     private:
         void setShader(Shader* shader);
         void advectionStep();
@@ -77,15 +94,49 @@ class GG1_C38_Handler : public Handler {
         void divergenceStep();
         void pressureStep();
         void gradientStep();
+        void latticeStep();
+        void cpuStep();
+
+        FluidInput frameInput();
+        FluidInput stepInput(const FluidInput& in, int k, int n);
+        int advanceClock(float wall);
+
+        // the CPU engine, projection or lattice
+        void stepEngine(const FluidInput& in);
+        void writeDye(float* rgba);
+        void presentDye(uint32_t* pixels, int pitch);
+
+        void createEngine();
+        void simLoop(bool software, int rx);
+        void presentPublished(bool software);
+
+        // draws the full screen quad every pass renders with
+        void drawQuad();
+
+        // headless runs have no events; a drag circling the center stands in for the mouse, the same on every run
+        void scriptedInput();
 
         int frame = 0;
-        float dt = 0.0f;
         int curFPS = 0;
+
+        // the simulation clock: every step is dt seconds, and a frame runs as many (substeps, at most maxSubsteps) as the wall clock has
+        // gone past it, carrying the rest in accumulator. steps counts them all, and is the frame the shaders and engines see
+        float dt = 1.0f / 60.0f;
+        int maxSubsteps = 4;
+        float accumulator = 0.0f;
+        int substeps = 0;
+        int steps = 0;
+        FluidInput stepIn; // input of the current step of the step shaders
+
+        std::atomic<float> simMs{0.0f}; // the last measured frame of the simulation passes, on the GPU (timer queries) or the CPU
+        enum { SIM_QUERIES = 4 }; // frames of timer queries in flight
+        GLuint simQuery[SIM_QUERIES];
         std::chrono::steady_clock::time_point lastT;
 
         int relX, relY, orgX, orgY;
         bool wDown, aDown, sDown, dDown, spDown, shDown, enDown;
         bool mouseDown;
+        bool inputTaken; // whether the last frame's motion was stepped (or queued), so the next one starts from none
         
         // scene objects
         /* ----- FLUID PLANE ----- */
@@ -94,6 +145,39 @@ class GG1_C38_Handler : public Handler {
         TexturePair *curVel, *nxtVel, *curQnt, *nxtQnt, *curPrs, *nxtPrs;
         
         Shader* fluidShader;
+        GLuint quadVAO, quadVBO;
+
+        /* ----- LATTICE BOLTZMANN ----- */
+        // the populations, three textures (math/lattice.fs) and their ping-pong partners, drawn to at once through latFBO
+        Shader* latStep;
+        TexturePair *pop[2][3];
+        int curPop;
+        GLuint latFBO;
+
+        StreamBuffer* stream;
+
+        // when set, the simulation runs on the CPU engine and only the dye is uploaded for display
+        bool cpu;
+        int threads;
+        CpuOptions opts;
+        Executor* pool;
+        CpuFluid* cpuFluid;
+
+        // when set, the lattice Boltzmann engine replaces the projection method, on the GPU or (with cpu) on the CPU
+        bool lbm;
+        LbmFluid* lbmFluid;
+
+        // when set, the CPU engine steps on its own thread (simLoop) on the fixed clock, while this one polls events and presents. Each
+        // frame's input reaches it through a lock free queue, so a long step never loses any, and it publishes finished dye frames through
+        // a triple buffer (as pixels in software mode, texels for the upload ring otherwise), so presenting never holds up the solver
+        bool threaded;
+        std::thread simThread;
+        std::atomic<bool> simRunning{false};
+        SpscQueue<FluidInput> inputs;
+        TripleBuffer<uint32_t> framePixels;
+        TripleBuffer<float> frameTexels;
+        std::atomic<int> stepsDone{0};
+        int shownSteps = 0;
 
 };
 
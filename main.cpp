@@ -6,6 +6,8 @@
  * @date 2022-09-03
  */
 
+#include <cstdlib>
+#include <exception>
 #include <iostream>
 #include <string>
 using std::cout;
@@ -14,17 +16,197 @@ using std::string;
 #include "util/kernel/kernel.h"
 #include "util/handler.h"
 #include "GG1_C38_handler.h"
+#include "GG1_C38/cpu/bench.h"
+#include "GG1_C38/cpu/stencilSpec.h"
 #include "objects/helper.h"
 
 int main(int argc, char* argv[]) {
-    Kernel* kernel = new Kernel(string("Fluid"), 800, 800);
-    GG1_C38_Handler* handler = new GG1_C38_Handler();
+    // --cpu runs the simulation on the CPU engine instead of the step shaders
+    // --threads n sets the CPU engine's thread count (default: all hardware threads)
+    // --pin pins the CPU engine's threads to cores, node by node, so each socket's rows stay in its own memory
+    // --huge-pages maps the CPU engine's planes on 2 MB pages where the OS allows
+    // --bench-threads [res] prints thread scaling of the CPU engine and exits
+    // --bench-jacobi [res] compares plain and temporally blocked pressure solves and exits
+    // --no-fuse runs the CPU engine's passes separately instead of fused (for validation)
+    // --bench-fused [res] compares fused and separate passes of the CPU engine and exits
+    // --no-graph ends every pass of the CPU engine at a barrier instead of running the frame as a task graph
+    // --bench-graph [res] compares the CPU engine's frame with barriers and as a task graph and exits
+    // --executor serial|pool|std|openmp sets the backend the CPU engine's passes run on (default pool)
+    // --bench-executors [res] times the CPU engine on every executor backend in this build and exits
+    // --bench-reduce [res] compares deterministic and unordered reductions on 1 to 64 threads and exits
+    // --bench-sizes compares the generic and size specialized stencil kernels and exits
+    // --gen-glsl [path] writes the GLSL stencil bodies generated from GG1_C38/cpu/stencilSpec.h to path (default
+    //     GG1_C38/src/math/stencils.fs, which is checked in) and exits; run it after changing a spec
+    // --bench-layouts [res] compares row major, tiled and Morton field layouts per pass up to res x res and exits
+    // --half stores the CPU engine's planes as halfs, like the GPU path's RGBA16F textures
+    // --bench-half [res] compares float and half storage of the CPU engine and exits
+    // --sparse runs the CPU engine's passes only over the blocks in motion (approximate; the full grid is the default)
+    // --bench-sparse [res] compares the full grid and sparse CPU engines and exits
+    // --bench-arena [res] prints the CPU engine's frame arena use and spills to the heap per frame and exits
+    // --bench-decomp [res] prints strong and weak scaling of the CPU engine split into slabs over worker processes and exits
+    // --out-of-core dir keeps the CPU engine's planes in mapped files in dir and streams each frame through them, for grids larger than memory
+    // --bench-ooc [res] compares the CPU engine in memory and out of core and exits
+    // --bench-ensemble [res] compares an ensemble of 16 CPU engine instances, one per vector lane, with separate engines up to res x res and exits
+    // --lbm runs a lattice Boltzmann (D2Q9) engine instead of the projection method, on the GPU or with --cpu on the CPU
+    // --bench-lbm [res] compares the projection and lattice Boltzmann CPU engines up to res x res and exits
+    // --software presents the CPU engine's dye through an SDL texture without creating a GL context (implies --cpu)
+    // --headless [frames] runs that many frames (default 600) on an offscreen GL context with no window, as fast as possible, with a scripted
+    //     drag for input, and saves the last one to renders/fluid.bmp; needs EGL_MESA_platform_surfaceless (Mesa, llvmpipe without a GPU)
+    // --threaded steps the CPU engine on its own thread, fed input through a queue and presented from a triple buffer, so neither waits on
+    //     the other (implies --cpu; headless runs stay in lockstep)
+    // --dt seconds sets the simulation's fixed step (default 1/60); frames run as many steps as the wall clock has passed
+    // --max-substeps n caps the steps a frame runs to catch up (default 4); a slower machine then runs the simulation slower than real time
+    // --border zero|clamp|periodic|mirror sets what the CPU engine's stencils read outside the grid (default zero, like the GPU path)
+    // a rank of --bench-decomp, started by it as a worker process
+    if (argc == 4 && string(argv[1]) == "--decomp-worker")
+        return runDecompWorker(argv[2], atoi(argv[3]));
+
+    bool cpu = false;
+    bool lbm = false;
+    bool threaded = false;
+    KernelMode mode = KernelMode::GL;
+    int frames = 0;
+    int threads = 0;
+    float dt = 1.0f / 60.0f;
+    int maxSubsteps = 4;
+    CpuOptions opts;
+    for (int i = 1; i < argc; i ++) {
+        string arg = argv[i];
+        if (arg == "--cpu") {
+            cpu = true;
+        } else if (arg == "--lbm") {
+            lbm = true;
+        } else if (arg == "--threaded") {
+            threaded = true;
+            cpu = true;
+        } else if (arg == "--software") {
+            mode = KernelMode::Software;
+            cpu = true;
+        } else if (arg == "--headless") {
+            mode = KernelMode::Headless;
+            int n = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            frames = n > 0 ? n : 600;
+            if (n > 0)
+                i ++;
+        } else if (arg == "--dt" && i + 1 < argc) {
+            dt = (float)atof(argv[++ i]);
+        } else if (arg == "--max-substeps" && i + 1 < argc) {
+            maxSubsteps = atoi(argv[++ i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++ i]);
+        } else if (arg == "--pin") {
+            opts.pin = true;
+        } else if (arg == "--huge-pages") {
+            opts.hugePages = true;
+        } else if (arg == "--bench-threads") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchThreads(res > 0 ? res : 1024, 20);
+            return 0;
+        } else if (arg == "--bench-jacobi") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchJacobi(res > 0 ? res : 2048, 3);
+            return 0;
+        } else if (arg == "--no-fuse") {
+            opts.fused = false;
+        } else if (arg == "--bench-fused") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchFused(res > 0 ? res : 1024, 20);
+            return 0;
+        } else if (arg == "--executor" && i + 1 < argc) {
+            opts.executor = argv[++ i];
+        } else if (arg == "--bench-executors") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchExecutors(res > 0 ? res : 1024, 20);
+            return 0;
+        } else if (arg == "--bench-reduce") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchReduce(res > 0 ? res : 1024, 10);
+            return 0;
+        } else if (arg == "--no-graph") {
+            opts.graph = false;
+        } else if (arg == "--bench-graph") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchGraph(res > 0 ? res : 1024, 20);
+            return 0;
+        } else if (arg == "--border" && i + 1 < argc) {
+            string b = argv[++ i];
+            if (b == "clamp") opts.border = Border::Clamp;
+            else if (b == "periodic") opts.border = Border::Periodic;
+            else if (b == "mirror") opts.border = Border::Mirror;
+            else if (b != "zero")
+                cout << "--border " << b << " not recognized (zero, clamp, periodic, mirror)\n";
+        } else if (arg == "--bench-sizes") {
+            benchSizes(10);
+            return 0;
+        } else if (arg == "--half") {
+            opts.half = true;
+        } else if (arg == "--bench-half") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchHalf(res > 0 ? res : 1024, 20);
+            return 0;
+        } else if (arg == "--sparse") {
+            opts.sparse = true;
+        } else if (arg == "--bench-sparse") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchSparse(res > 0 ? res : 1024, 60);
+            return 0;
+        } else if (arg == "--bench-arena") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchArena(res > 0 ? res : 2048, 10);
+            return 0;
+        } else if (arg == "--bench-decomp") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchDecomp(res > 0 ? res : 1024, 20);
+            return 0;
+        } else if (arg == "--out-of-core" && i + 1 < argc) {
+            opts.outOfCore = argv[++ i];
+        } else if (arg == "--bench-ooc") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchOutOfCore(res > 0 ? res : 2048, 5);
+            return 0;
+        } else if (arg == "--bench-ensemble") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchEnsemble(res > 0 ? res : 64, 16, 20);
+            return 0;
+        } else if (arg == "--bench-lbm") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchLattice(res > 0 ? res : 1024, 20);
+            return 0;
+        } else if (arg == "--gen-glsl") {
+            string path = (i + 1 < argc) ? argv[i + 1] : "GG1_C38/src/math/stencils.fs";
+            try {
+                writeStencilGLSL(path);
+            } catch (const std::exception& e) {
+                cout << e.what() << "\n";
+                return 1;
+            }
+            cout << "wrote " << path << "\n";
+            return 0;
+        } else if (arg == "--bench-layouts") {
+            int res = (i + 1 < argc) ? atoi(argv[i + 1]) : 0;
+            benchLayouts(res > 0 ? res : 4096, 3);
+            return 0;
+        }
+    }
+
+    Kernel* kernel = new Kernel(string("Fluid"), 800, 800, mode);
+    kernel->setFrameLimit(frames);
+    if (threaded && mode == KernelMode::Headless) {
+        cout << "--threaded has no effect on headless runs, which step once per frame\n";
+        threaded = false;
+    }
+    GG1_C38_Handler* handler = new GG1_C38_Handler(cpu, threads, opts, lbm, threaded);
+    handler->setTimestep(dt > 0.0f ? dt : 1.0f / 60.0f, maxSubsteps > 0 ? maxSubsteps : 1);
 
     Handler::registerKernel(kernel);
     Handler::registerHandler(handler);
 
     kernel->start();
+    if (mode == KernelMode::Headless)
+        kernel->saveImage(kernel->getWindow(), kernel->getRenderer(), "renders/fluid.bmp");
     
+    // stops the simulation thread, if any
+    delete handler;
     delete kernel;
 
     return 0;
@@ -0,0 +1,129 @@
+/**
+ * @file streamBuffer.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Triple buffered pixel unpack ring for streaming CPU produced fields (velocity, dye) into GL textures without stalling the pipeline
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include "helper.h"
+
+/**
+ * @brief Ring of pixel unpack buffer slots that CPU producers write RGBA32F texels into.
+ * With ARB_buffer_storage (GL 4.4) the whole ring is mapped once with GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, so
+ * writes land directly in driver visible memory with no extra copy. Each slot is fenced after its glTexSubImage2D, and
+ * map() only waits if the GPU is still reading the slot it is about to hand back (i.e. the CPU is more than `slots` frames ahead).
+ * On a plain 4.3 context it falls back to unsynchronized glMapBufferRange on the same fenced slots.
+ */
+class StreamBuffer {
+    public:
+        StreamBuffer(int rx, int ry, int slots = 3) : rx(rx), ry(ry), slots(slots) {
+            PBO = 0; base = NULL; cur = 0; stalls = 0; mapped = false;
+            fences = new GLsync[slots];
+            for (int i = 0; i < slots; i ++)
+                fences[i] = NULL;
+            setupPBO();
+        }
+
+        ~StreamBuffer() {
+            for (int i = 0; i < slots; i ++)
+                if (fences[i] != NULL)
+                    glDeleteSync(fences[i]);
+            delete[] fences;
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+            if (persistent || mapped)
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glDeleteBuffers(1, &PBO);
+        }
+
+        /**
+         * @brief Returns the write pointer of the current slot (rx * ry RGBA float texels, rows bottom to top like the textures). Blocks only if the GPU has not yet consumed this slot
+         */
+        float* map() {
+            waitSlot(cur);
+
+            if (persistent)
+                return (float*)((char*)base + cur * slotSize);
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+            void* ptr = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, cur * slotSize, slotSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            mapped = true;
+            return (float*)ptr;
+        }
+
+        /**
+         * @brief Copies the current slot into tex (which must be rx by ry) on the GPU timeline, fences the slot and advances the ring
+         *
+         * @param tex Destination texture (e.g. TexturePair::TEX)
+         */
+        void upload(GLuint tex) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+            if (mapped) {
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                mapped = false;
+            }
+
+            glBindTexture(GL_TEXTURE_2D, tex);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rx, ry, GL_RGBA, GL_FLOAT, (void*)(cur * slotSize));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            fences[cur] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            cur = (cur + 1) % slots;
+        }
+
+        // number of map() calls that had to wait on the GPU; should stay at 0 in steady state
+        int getStalls() { return stalls; }
+        bool isPersistent() { return persistent; }
+
+    private:
+        void setupPBO() {
+            // keep slots aligned so every slot offset is a valid mapping offset
+            slotSize = ((GLsizeiptr)rx * ry * 4 * sizeof(float) + 255) & ~(GLsizeiptr)255;
+            GLsizeiptr total = slotSize * slots;
+
+            glGenBuffers(1, &PBO);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, PBO);
+            persistent = GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+            if (persistent) {
+                GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glBufferStorage(GL_PIXEL_UNPACK_BUFFER, total, NULL, flags);
+                base = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, total, flags);
+                std::cout << "stream buffer: persistent " << slots << " x " << slotSize << " bytes\n";
+            } else {
+                glBufferData(GL_PIXEL_UNPACK_BUFFER, total, NULL, GL_STREAM_DRAW);
+                std::cout << "stream buffer: ARB_buffer_storage unavailable, using unsynchronized mapping\n";
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        void waitSlot(int i) {
+            if (fences[i] == NULL)
+                return;
+
+            GLenum res = glClientWaitSync(fences[i], 0, 0);
+            if (res == GL_TIMEOUT_EXPIRED) {
+                stalls ++;
+                do {
+                    res = glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1ms
+                } while (res == GL_TIMEOUT_EXPIRED);
+            }
+            glDeleteSync(fences[i]);
+            fences[i] = NULL;
+        }
+
+        int rx, ry, slots, cur, stalls;
+        GLuint PBO;
+        GLsizeiptr slotSize;
+        GLsync* fences;
+        void* base;
+        bool persistent, mapped;
+};
+
+#endif
@@ -0,0 +1,186 @@
+/**
+ * @file executor.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Interchangeable backends that the CPU passes split their row tiles over
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "executor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <thread>
+
+#include "threadPool.h"
+
+#if __has_include(<execution>)
+#include <execution>
+#endif
+// the std backend needs the parallel algorithms and a library behind them; MSVC has its own, libstdc++ needs TBB linked (EXECUTOR_STD)
+#if defined(__cpp_lib_parallel_algorithm) && (defined(_MSC_VER) || defined(EXECUTOR_STD))
+#define EXECUTOR_HAS_STD
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+static thread_local int threadIndex = 0;
+
+int Executor::currentThread() {
+    return threadIndex;
+}
+
+void Executor::setCurrentThread(int index) {
+    threadIndex = index;
+}
+
+double Executor::parallelReduce(int n, int grain, FnRef<double(int, int)> body, Combine combine) {
+    if (grain < 1)
+        grain = 1;
+    int tiles = (n + grain - 1) / grain;
+    if (tiles == 0)
+        return combine == Combine::Max ? -HUGE_VAL : combine == Combine::Min ? HUGE_VAL : 0.0;
+
+    // per call, so overlapping reductions do not share it; on the stack up to a few thousand rows in the usual tiles
+    double local[512];
+    std::vector<double> heap;
+    double* partials = local;
+    if (tiles > 512) {
+        heap.resize(tiles);
+        partials = heap.data();
+    }
+
+    // tiles are the same rows whatever the backend cuts them out for, so each lands in its own slot of partials
+    parallelFor(n, grain, [&](int y0, int y1) {
+        partials[y0 / grain] = body(y0, y1);
+    });
+    return reduceTree(partials, tiles, combine).value();
+}
+
+void SerialExecutor::parallelFor(int n, int grain, FnRef<void(int, int)> body) {
+    if (grain < 1)
+        grain = 1;
+    for (int y = 0; y < n; y += grain)
+        body(y, y + grain < n ? y + grain : n);
+}
+
+#ifdef EXECUTOR_HAS_STD
+// tiles [t0, t1) of slot i of threads, in the contiguous dealing ThreadPool::parallelFor uses
+static void slotTiles(int tiles, int i, int threads, int& t0, int& t1) {
+    t0 = (int)((long long)tiles * i / threads);
+    t1 = (int)((long long)tiles * (i + 1) / threads);
+}
+
+/**
+ * @brief The standard parallel algorithms; one element per slot, so the library decides which of its threads runs which block
+ */
+class StdExecutor : public Executor {
+    public:
+        explicit StdExecutor(int threads) : slots(threads) {
+            std::iota(slots.begin(), slots.end(), 0);
+        }
+
+        void parallelFor(int n, int grain, FnRef<void(int, int)> body) override {
+            if (grain < 1)
+                grain = 1;
+            int tiles = (n + grain - 1) / grain;
+            int threads = size();
+            std::for_each(std::execution::par, slots.begin(), slots.end(), [&](int i) {
+                setCurrentThread(i);
+                int t0, t1;
+                slotTiles(tiles, i, threads, t0, t1);
+                for (int t = t0; t < t1; t ++)
+                    body(t * grain, t * grain + grain < n ? t * grain + grain : n);
+            });
+            setCurrentThread(0);
+        }
+
+        void runOnEach(FnRef<void(int)> body) override {
+            std::for_each(std::execution::par, slots.begin(), slots.end(), [&](int i) {
+                setCurrentThread(i);
+                body(i);
+            });
+            setCurrentThread(0);
+        }
+
+        int size() override { return (int)slots.size(); }
+        const char* name() override { return "std"; }
+
+    private:
+        std::vector<int> slots; // 0 .. threads - 1, the range the algorithms run over
+};
+#endif
+
+#ifdef _OPENMP
+/**
+ * @brief OpenMP parallel regions of threads threads; the runtime may hand out fewer, which only leaves slots idle
+ */
+class OmpExecutor : public Executor {
+    public:
+        explicit OmpExecutor(int threads) : threads(threads) {}
+
+        void parallelFor(int n, int grain, FnRef<void(int, int)> body) override {
+            if (grain < 1)
+                grain = 1;
+            int tiles = (n + grain - 1) / grain;
+            #pragma omp parallel num_threads(threads)
+            {
+                setCurrentThread(omp_get_thread_num());
+                #pragma omp for schedule(static)
+                for (int t = 0; t < tiles; t ++)
+                    body(t * grain, t * grain + grain < n ? t * grain + grain : n);
+            }
+            setCurrentThread(0);
+        }
+
+        void runOnEach(FnRef<void(int)> body) override {
+            #pragma omp parallel num_threads(threads)
+            {
+                setCurrentThread(omp_get_thread_num());
+                body(omp_get_thread_num());
+            }
+            setCurrentThread(0);
+        }
+
+        int size() override { return threads; }
+        const char* name() override { return "openmp"; }
+
+    private:
+        int threads;
+};
+#endif
+
+Executor* makeExecutor(const char* name, int threads, bool pin) {
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    if (strcmp(name, "serial") == 0)
+        return new SerialExecutor();
+    if (strcmp(name, "pool") == 0)
+        return new ThreadPool(threads, pin);
+#ifdef EXECUTOR_HAS_STD
+    if (strcmp(name, "std") == 0)
+        return new StdExecutor(threads);
+#endif
+#ifdef _OPENMP
+    if (strcmp(name, "openmp") == 0)
+        return new OmpExecutor(threads);
+#endif
+    return NULL;
+}
+
+std::vector<const char*> availableExecutors() {
+    std::vector<const char*> names = { "serial", "pool" };
+#ifdef EXECUTOR_HAS_STD
+    names.push_back("std");
+#endif
+#ifdef _OPENMP
+    names.push_back("openmp");
+#endif
+    return names;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file executor.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Interchangeable backends that the CPU passes split their row tiles over
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <vector>
+
+#include "fnRef.h"
+#include "reduce.h"
+
+/*
+Every CPU pass reaches its threads through an Executor, so the backend can be picked at run time (makeExecutor, --executor):
+
+    serial   the calling thread only
+    pool     ThreadPool (threadPool.h); per thread deques dealt contiguous blocks of tiles, work stealing, optional pinning. The default
+    std      std::for_each(std::execution::par) over one slot per thread, each running a contiguous block of tiles; the standard
+             library's threads (TBB under libstdc++, the Windows thread pool under MSVC). par rather than par_unseq, since a tile takes
+             its thread's scratch from the frame arena and two tiles interleaved on one thread would share it
+    openmp   omp parallel, tiles dealt statically in contiguous blocks like the pool's, so rows stay with the thread that first touched them
+
+std and openmp are only compiled in where the toolchain has them (availableExecutors()). For std that is more than the header: MSVC's
+parallel algorithms are built in, but libstdc++ runs them on TBB, which then has to be linked (-ltbb), so other toolchains build std in
+only when EXECUTOR_STD is defined. Whatever the backend, a tile or runOnEach body
+runs with currentThread() set to a slot in [0, size()) that no other body holds at the same time; per thread scratch is indexed by it.
+*/
+
+class Executor {
+    public:
+        virtual ~Executor() {}
+
+        // runs body(y0, y1) over the rows [0, n) in tiles of grain rows, returning once all are done
+        virtual void parallelFor(int n, int grain, FnRef<void(int, int)> body) = 0;
+
+        // runs body(i) once for every slot i, each on its own thread where the backend allows; for work that has to happen on a
+        // particular thread, like first touch
+        virtual void runOnEach(FnRef<void(int)> body) = 0;
+
+        // number of slots
+        virtual int size() = 0;
+
+        virtual const char* name() = 0;
+
+        // the CPU slot index is pinned to, or -1 if it is not
+        virtual int getCpu(int index) { (void)index; return -1; }
+
+        /**
+         * @brief body(y0, y1) over the tiles of parallelFor(n, grain), combined in a fixed pairwise tree over the tile indices (reduce.h).
+         * The result only depends on n, grain and body, not on the backend or the number of slots, as long as body itself is computed in
+         * a fixed order. The partials are kept per call, so reductions may overlap on one executor
+         */
+        double parallelReduce(int n, int grain, FnRef<double(int, int)> body, Combine combine = Combine::Sum);
+
+        // slot of the calling thread within the pass it is running a tile for; 0 outside of one
+        static int currentThread();
+
+    protected:
+        static void setCurrentThread(int index);
+};
+
+/**
+ * @brief Runs everything on the calling thread, honoring the tile size
+ */
+class SerialExecutor : public Executor {
+    public:
+        void parallelFor(int n, int grain, FnRef<void(int, int)> body) override;
+        void runOnEach(FnRef<void(int)> body) override { body(0); }
+        int size() override { return 1; }
+        const char* name() override { return "serial"; }
+};
+
+/**
+ * @brief Makes backend name with threads slots (0: every hardware thread); pin only applies to the pool. NULL if name is unknown or
+ * was not compiled in
+ */
+Executor* makeExecutor(const char* name, int threads = 0, bool pin = false);
+
+// the names makeExecutor accepts in this build
+std::vector<const char*> availableExecutors();
+
+#endif
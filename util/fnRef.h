@@ -0,0 +1,40 @@
+/**
+ * @file fnRef.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Non owning reference to a callable, for passing pass bodies to the thread pool without allocating
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef FN_REF_H
+#define FN_REF_H
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+template<class Sig>
+class FnRef;
+
+/**
+ * @brief Refers to a callable (usually a lambda) for as long as the callable lives, which for an argument is until the call it was passed
+ * to returns. Unlike std::function it never copies the callable, so never allocates, however much the lambda captures
+ */
+template<class R, class... A>
+class FnRef<R(A...)> {
+    public:
+        template<class F, class = typename std::enable_if<!std::is_same<typename std::decay<F>::type, FnRef>::value>::type>
+        FnRef(F&& f) : obj((void*)std::addressof(f)) {
+            call = [](void* o, A... a) -> R {
+                return (*(typename std::remove_reference<F>::type*)o)(std::forward<A>(a)...);
+            };
+        }
+
+        R operator()(A... a) const { return call(obj, std::forward<A>(a)...); }
+
+    private:
+        void* obj;
+        R (*call)(void*, A...);
+};
+
+#endif
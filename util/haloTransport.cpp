@@ -0,0 +1,377 @@
+/**
+ * @file haloTransport.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Message transports between the ranks of a domain decomposed solver, and launching this program again as worker processes
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "haloTransport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+// the counters are shared between processes, which only works if they are lock free
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "the rings need lock free atomics");
+
+static const uint64_t BLOCK_MAGIC = 0x67673163333868ull; // "gg1c38h"
+
+// slots per channel and payload bytes per slot; a 2048 wide row of floats fits in one slot, and a rank can run a few messages ahead
+static const int SLOTS = 8;
+static const size_t SLOT_BYTES = 16 * 1024;
+
+static long long nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Spins on ready() for a while, then keeps checking between yields, since the other side may be waiting for a core
+ */
+template<typename F>
+static void spinUntil(F ready) {
+    for (int i = 0; !ready(); i ++)
+        if (i >= 256)
+            std::this_thread::yield();
+}
+
+struct BlockHeader {
+    uint64_t magic;
+    int n;
+    size_t userBytes;
+    alignas(64) std::atomic<int> arrived;    // ranks in the current barrier
+    alignas(64) std::atomic<int> generation; // barriers completed
+};
+
+struct Slot {
+    uint64_t bytes;
+    long long ready; // nowNs() from which recv may take it
+    alignas(64) unsigned char data[SLOT_BYTES];
+};
+
+/**
+ * @brief Ring of one ordered pair of neighbors; messages are head to tail - 1, slot index mod SLOTS
+ */
+struct RingTransport::Channel {
+    alignas(64) std::atomic<uint64_t> head; // advanced by the receiver
+    alignas(64) std::atomic<uint64_t> tail; // advanced by the sender
+    Slot slots[SLOTS];
+};
+
+static size_t roundLine(size_t b) {
+    return (b + 63) / 64 * 64;
+}
+
+// the two channels out of every rank (down, up), then the user area
+size_t RingTransport::blockBytes(int n, size_t userBytes) {
+    return roundLine(sizeof(BlockHeader)) + 2 * (size_t)n * sizeof(Channel) + roundLine(userBytes);
+}
+
+void RingTransport::layout(void* block, int n, size_t userBytes) {
+    memset(block, 0, blockBytes(n, userBytes));
+    BlockHeader* h = new (block) BlockHeader();
+    h->n = n;
+    h->userBytes = userBytes;
+    h->arrived.store(0);
+    h->generation.store(0);
+    Channel* c = (Channel*)((char*)block + roundLine(sizeof(BlockHeader)));
+    for (int i = 0; i < 2 * n; i ++) {
+        new (&c[i].head) std::atomic<uint64_t>(0);
+        new (&c[i].tail) std::atomic<uint64_t>(0);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = BLOCK_MAGIC;
+}
+
+void RingTransport::attach(void* block, int rank) {
+    this->block = block;
+    me = rank;
+    n = ((BlockHeader*)block)->n;
+}
+
+RingTransport::Channel* RingTransport::channel(int from, int to) {
+    Channel* c = (Channel*)((char*)block + roundLine(sizeof(BlockHeader)));
+    return &c[2 * from + (to > from ? 1 : 0)];
+}
+
+void* RingTransport::shared() {
+    return (char*)block + roundLine(sizeof(BlockHeader)) + 2 * (size_t)n * sizeof(Channel);
+}
+
+void RingTransport::send(int to, const void* data, size_t bytes) {
+    Channel* c = channel(me, to);
+    const unsigned char* src = (const unsigned char*)data;
+    stats.messages ++;
+    stats.bytes += (long long)bytes;
+
+    do {
+        size_t len = std::min(bytes, SLOT_BYTES);
+        uint64_t t = c->tail.load(std::memory_order_relaxed);
+        spinUntil([&]() { return t - c->head.load(std::memory_order_acquire) < (uint64_t)SLOTS; });
+
+        Slot& s = c->slots[t % SLOTS];
+        memcpy(s.data, src, len);
+        s.bytes = len;
+        s.ready = latencyNs > 0 ? nowNs() + latencyNs : 0;
+        c->tail.store(t + 1, std::memory_order_release);
+
+        src += len;
+        bytes -= len;
+    } while (bytes > 0);
+}
+
+void RingTransport::recv(int from, void* data, size_t bytes) {
+    Channel* c = channel(from, me);
+    unsigned char* dst = (unsigned char*)data;
+
+    do {
+        uint64_t h = c->head.load(std::memory_order_relaxed);
+        auto ready = [&]() {
+            return c->tail.load(std::memory_order_acquire) > h && (latencyNs == 0 || nowNs() >= c->slots[h % SLOTS].ready);
+        };
+        if (!ready()) {
+            long long t0 = nowNs();
+            spinUntil(ready);
+            stats.waitSeconds += (nowNs() - t0) * 1e-9;
+        }
+
+        Slot& s = c->slots[h % SLOTS];
+        size_t len = (size_t)s.bytes;
+        memcpy(dst, s.data, len);
+        c->head.store(h + 1, std::memory_order_release);
+
+        dst += len;
+        bytes -= std::min(bytes, len);
+    } while (bytes > 0);
+}
+
+void RingTransport::barrier() {
+    BlockHeader* h = (BlockHeader*)block;
+    int g = h->generation.load(std::memory_order_acquire);
+    if (h->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == n) {
+        h->arrived.store(0, std::memory_order_relaxed);
+        h->generation.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    spinUntil([&]() { return h->generation.load(std::memory_order_acquire) != g; });
+}
+
+/*
+Shared memory
+*/
+
+// the OS level name of a segment; POSIX names start with a slash, Windows ones stay in the session's namespace
+static std::string segmentName(const std::string& name) {
+#ifdef _WIN32
+    return "Local\\" + name;
+#else
+    return "/" + name;
+#endif
+}
+
+SharedMemoryTransport* SharedMemoryTransport::create(const std::string& name, int n, size_t userBytes) {
+    size_t bytes = blockBytes(n, userBytes);
+    std::string seg = segmentName(name);
+    void* p = NULL;
+    intptr_t handle = 0;
+#ifdef _WIN32
+    HANDLE m = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)bytes >> 32), (DWORD)bytes, seg.c_str());
+    if (m == NULL)
+        return NULL;
+    p = MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (p == NULL) {
+        CloseHandle(m);
+        return NULL;
+    }
+    handle = (intptr_t)m;
+#else
+    int fd = shm_open(seg.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        return NULL;
+    if (ftruncate(fd, (off_t)bytes) != 0 || (p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        close(fd);
+        shm_unlink(seg.c_str());
+        return NULL;
+    }
+    handle = fd;
+#endif
+    layout(p, n, userBytes);
+
+    SharedMemoryTransport* t = new SharedMemoryTransport();
+    t->segment = seg;
+    t->handle = handle;
+    t->bytes = bytes;
+    t->owner = true;
+    t->attach(p, 0);
+    return t;
+}
+
+SharedMemoryTransport* SharedMemoryTransport::open(const std::string& name, int rank) {
+    std::string seg = segmentName(name);
+    void* p = NULL;
+    intptr_t handle = 0;
+    size_t bytes = 0;
+#ifdef _WIN32
+    HANDLE m = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, seg.c_str());
+    if (m == NULL)
+        return NULL;
+    p = MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (p == NULL || VirtualQuery(p, &info, sizeof(info)) == 0) {
+        if (p != NULL)
+            UnmapViewOfFile(p);
+        CloseHandle(m);
+        return NULL;
+    }
+    bytes = info.RegionSize;
+    handle = (intptr_t)m;
+#else
+    int fd = shm_open(seg.c_str(), O_RDWR, 0600);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    bytes = (size_t)st.st_size;
+    handle = fd;
+#endif
+
+    SharedMemoryTransport* t = new SharedMemoryTransport();
+    t->segment = seg;
+    t->handle = handle;
+    t->bytes = bytes;
+    t->block = p;
+    BlockHeader* h = (BlockHeader*)p;
+    if (h->magic != BLOCK_MAGIC || rank < 0 || rank >= h->n) {
+        delete t;
+        return NULL;
+    }
+    t->attach(p, rank);
+    return t;
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+#ifdef _WIN32
+    if (block != NULL)
+        UnmapViewOfFile(block);
+    CloseHandle((HANDLE)handle);
+#else
+    if (block != NULL)
+        munmap(block, bytes);
+    close((int)handle);
+    if (owner)
+        shm_unlink(segment.c_str());
+#endif
+}
+
+/*
+Loopback
+*/
+
+class LoopbackTransport : public RingTransport {
+    public:
+        LoopbackTransport(void* block, int rank, double latencyUs) {
+            attach(block, rank);
+            latencyNs = (long long)(latencyUs * 1000.0);
+        }
+
+        const char* name() override { return latencyNs > 0 ? "loopback with latency" : "loopback"; }
+};
+
+LoopbackGroup::LoopbackGroup(int n, size_t userBytes, double latencyUs) {
+    block = ::operator new(RingTransport::blockBytes(n, userBytes), std::align_val_t(64));
+    RingTransport::layout(block, n, userBytes);
+    for (int r = 0; r < n; r ++)
+        endpoints.push_back(new LoopbackTransport(block, r, latencyUs));
+}
+
+LoopbackGroup::~LoopbackGroup() {
+    for (HaloTransport* e : endpoints)
+        delete e;
+    ::operator delete(block, std::align_val_t(64));
+}
+
+HaloTransport* LoopbackGroup::endpoint(int rank) {
+    return endpoints[rank];
+}
+
+/*
+Worker processes
+*/
+
+intptr_t launchSelf(const std::vector<std::string>& args) {
+#ifdef _WIN32
+    char exe[MAX_PATH];
+    DWORD len = GetModuleFileNameA(NULL, exe, MAX_PATH);
+    if (len == 0 || len == MAX_PATH)
+        return 0;
+    std::string cmd = std::string("\"") + exe + "\"";
+    for (const std::string& a : args)
+        cmd += " \"" + a + "\"";
+    STARTUPINFOA si = {};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi = {};
+    if (!CreateProcessA(exe, &cmd[0], NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi))
+        return 0;
+    CloseHandle(pi.hThread);
+    return (intptr_t)pi.hProcess;
+#elif defined(__linux__)
+    std::vector<char*> argv;
+    std::string exe = "/proc/self/exe";
+    argv.push_back(&exe[0]);
+    std::vector<std::string> copy = args;
+    for (std::string& a : copy)
+        argv.push_back(&a[0]);
+    argv.push_back(NULL);
+    pid_t pid = 0;
+    if (posix_spawn(&pid, exe.c_str(), NULL, NULL, argv.data(), environ) != 0)
+        return 0;
+    return (intptr_t)pid;
+#else
+    (void)args;
+    return 0;
+#endif
+}
+
+int waitProcess(intptr_t process) {
+#ifdef _WIN32
+    HANDLE h = (HANDLE)process;
+    DWORD code = (DWORD)-1;
+    if (WaitForSingleObject(h, INFINITE) != WAIT_OBJECT_0 || !GetExitCodeProcess(h, &code))
+        code = (DWORD)-1;
+    CloseHandle(h);
+    return (int)code;
+#else
+    int status = 0;
+    if (waitpid((pid_t)process, &status, 0) != (pid_t)process || !WIFEXITED(status))
+        return -1;
+    return WEXITSTATUS(status);
+#endif
+}
+
+int processId() {
+#ifdef _WIN32
+    return (int)GetCurrentProcessId();
+#else
+    return (int)getpid();
+#endif
+}
@@ -0,0 +1,157 @@
+/**
+ * @file haloTransport.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Message transports between the ranks of a domain decomposed solver, and launching this program again as worker processes
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef HALO_TRANSPORT_H
+#define HALO_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+Ranks 0 to n - 1 each own a slab of rows and only ever talk to the ranks right below and above them (see slabFluid.h). Every ordered
+pair of neighbors has a channel: a single producer, single consumer ring of fixed size slots in one block of memory, with the two
+counters in their own cache lines. send copies a message into free slots (split over several if it is long) and returns as soon as it
+is in the ring, so a rank can post its halo rows and go on computing while the neighbor picks them up; recv waits for the next
+message from a neighbor. Messages on a channel arrive in the order they were sent, so the two sides only have to agree on the order.
+
+Where the block lives is the only thing the transports differ in:
+
+    SharedMemoryTransport   a named shared memory segment (POSIX shm_open / Windows file mapping) mapped by one process per rank on
+                            the same node; the counters are lock free atomics, which work across processes
+    LoopbackTransport       ordinary memory shared by ranks that are threads of one process, with an optional delivery latency. It
+                            stands in for a transport between nodes, so the decomposition (and how well it hides latency) can be tried
+                            without a network
+
+A transport between nodes would implement HaloTransport the same way over sockets or MPI.
+*/
+
+/**
+ * @brief Traffic of one rank
+ */
+struct HaloStats {
+    long long messages = 0;
+    long long bytes = 0;
+    double waitSeconds = 0.0; // blocked in recv, i.e. communication that was not hidden behind computation
+};
+
+class HaloTransport {
+    public:
+        virtual ~HaloTransport() {}
+
+        virtual int rank() = 0;
+        virtual int ranks() = 0;
+        virtual const char* name() = 0;
+
+        // queues bytes of data for rank to, returning once it is copied out (it only waits while the channel is full)
+        virtual void send(int to, const void* data, size_t bytes) = 0;
+
+        // waits for the next bytes bytes from rank from
+        virtual void recv(int from, void* data, size_t bytes) = 0;
+
+        // returns once every rank has called it
+        virtual void barrier() = 0;
+
+        // memory every rank sees, userBytes long (see the constructors); for parameters and results
+        virtual void* shared() = 0;
+
+        HaloStats getStats() { return stats; }
+        void resetStats() { stats = HaloStats(); }
+
+    protected:
+        HaloStats stats;
+};
+
+/**
+ * @brief send, recv and barrier over the rings in a block laid out by RingTransport::layout; the subclasses provide the block
+ */
+class RingTransport : public HaloTransport {
+    public:
+        int rank() override { return me; }
+        int ranks() override { return n; }
+        void send(int to, const void* data, size_t bytes) override;
+        void recv(int from, void* data, size_t bytes) override;
+        void barrier() override;
+        void* shared() override;
+
+        // bytes of a block for n ranks with userBytes of shared memory, and laying out a fresh one
+        static size_t blockBytes(int n, size_t userBytes);
+        static void layout(void* block, int n, size_t userBytes);
+
+    protected:
+        RingTransport() : block(NULL), me(0), n(0), latencyNs(0) {}
+
+        // the rank's view of a laid out block
+        void attach(void* block, int rank);
+
+        struct Channel;
+        Channel* channel(int from, int to);
+
+        void* block;
+        int me, n;
+        long long latencyNs; // a message becomes visible to recv this long after it was sent
+};
+
+/**
+ * @brief One rank of a group of processes on one node, over a named shared memory segment
+ */
+class SharedMemoryTransport : public RingTransport {
+    public:
+        // creates the segment name for n ranks (one process calls this, as rank 0) ...
+        static SharedMemoryTransport* create(const std::string& name, int n, size_t userBytes);
+        // ... and the others open it as their rank; NULL if the segment does not exist or the OS has no shared memory
+        static SharedMemoryTransport* open(const std::string& name, int rank);
+
+        ~SharedMemoryTransport();
+
+        const char* name() override { return "shared memory"; }
+
+    private:
+        SharedMemoryTransport() : handle(0), bytes(0), owner(false) {}
+
+        std::string segment; // the OS level name
+        intptr_t handle;     // the mapping (Windows) or descriptor (POSIX)
+        size_t bytes;
+        bool owner;          // removes the name on destruction
+};
+
+/**
+ * @brief n ranks that are threads of one process; endpoint(r) is rank r's transport, for the thread running rank r
+ */
+class LoopbackGroup {
+    public:
+        // latencyUs delays every message's delivery, like a network hop would
+        LoopbackGroup(int n, size_t userBytes, double latencyUs = 0.0);
+        ~LoopbackGroup();
+
+        LoopbackGroup(const LoopbackGroup&) = delete;
+        LoopbackGroup& operator=(const LoopbackGroup&) = delete;
+
+        HaloTransport* endpoint(int rank);
+
+    private:
+        void* block;
+        std::vector<HaloTransport*> endpoints;
+};
+
+/*
+Worker processes: the program started again with other arguments, so that each rank of a decomposition gets a process of its own
+(CreateProcess on Windows, posix_spawn of /proc/self/exe on Linux).
+*/
+
+// starts this program with args as its arguments; 0 if it could not
+intptr_t launchSelf(const std::vector<std::string>& args);
+
+// waits for a process from launchSelf to end and returns its exit code (-1 if it could not be waited for)
+int waitProcess(intptr_t process);
+
+// this process's id, for naming segments
+int processId();
+
+#endif
@@ -20,7 +20,7 @@ using std::string;
 class Handler {
     public:
         Handler();
-        ~Handler();
+        virtual ~Handler();
 
         // the way this works is that classes that extend Handler 
         // reimplement obj handlers, which is called by their respective
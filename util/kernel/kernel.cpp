@@ -8,15 +8,35 @@
 
 #include "kernel.h"
 
+#include <chrono>
+#include <cstring>
+
+// the headless mode needs EGL and its surfaceless platform (Mesa); elsewhere it reports that it is unavailable
+#if __has_include(<EGL/egl.h>)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#define KERNEL_EGL
+#endif
+
 /**
  * @brief Construct a new Kernel object
  * 
  * @param title Title of the window
  * @param rx X dimension of the window in pixels
  * @param ry Y dimension of the window in pixels
+ * @param mode Present through OpenGL, through an SDL streaming texture (no GL driver needed), or offscreen without a window (KernelMode)
  */
-Kernel::Kernel(string title, int rx, int ry) : title(title), rx(rx), ry(ry) {
+Kernel::Kernel(string title, int rx, int ry, KernelMode mode) : title(title), rx(rx), ry(ry), mode(mode) {
     cout << title << endl;
+    window = NULL;
+    renderer = NULL;
+    glContext = NULL;
+    frame = NULL;
+    pixels = NULL;
+    pitch = 0;
+    eglDisplay = NULL;
+    eglContext = NULL;
+    offscreenFBO = offscreenRBO = 0;
 }
 
 /**
@@ -24,8 +44,27 @@ Kernel::Kernel(string title, int rx, int ry) : title(title), rx(rx), ry(ry) {
  */
 Kernel::~Kernel() {
     cout << "Removing kernel " << title << endl;
+    if (mode == KernelMode::Headless) {
+        if (offscreenFBO != 0) {
+            glDeleteFramebuffers(1, &offscreenFBO);
+            glDeleteRenderbuffers(1, &offscreenRBO);
+        }
+#ifdef KERNEL_EGL
+        if (eglDisplay != NULL) {
+            eglMakeCurrent((EGLDisplay)eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (eglContext != NULL)
+                eglDestroyContext((EGLDisplay)eglDisplay, (EGLContext)eglContext);
+            eglTerminate((EGLDisplay)eglDisplay);
+        }
+#endif
+        return;
+    }
+
+    if (frame != NULL)
+        SDL_DestroyTexture(frame);
     SDL_DestroyRenderer(renderer);
-    SDL_GL_DeleteContext(glContext);
+    if (glContext != NULL)
+        SDL_GL_DeleteContext(glContext);
     SDL_DestroyWindow(window);
 
     renderer = NULL;
@@ -67,20 +106,74 @@ SDL_Renderer* Kernel::getRenderer() {
     return renderer;
 }
 
+/**
+ * @brief Whether the kernel presents through an SDL streaming texture instead of OpenGL
+ */
+bool Kernel::isSoftware() {
+    return mode == KernelMode::Software;
+}
+
+/**
+ * @brief Whether the kernel renders offscreen, without a window or events
+ */
+bool Kernel::isHeadless() {
+    return mode == KernelMode::Headless;
+}
+
+/**
+ * @brief Gets the framebuffer frames are drawn into; the handler binds it for its final pass instead of 0
+ */
+GLuint Kernel::getFramebuffer() {
+    return offscreenFBO;
+}
+
+/**
+ * @brief Gets the locked frame in software mode, NULL outside the renderer handler
+ */
+Uint32* Kernel::getPixels() {
+    return pixels;
+}
+
+/**
+ * @brief Gets the bytes between rows of the locked frame
+ */
+int Kernel::getPitch() {
+    return pitch;
+}
+
 
 /**
  * @brief Computes render data based on a function that determines the objects in the scene, and passes render to the screen. A valid renderer handler must have already been called in order to avoid undefined behavior.
  */
 void Kernel::render() {
+    if (mode == KernelMode::Software) {
+        // the handler writes the frame straight into the texture's memory, which SDL then draws to the window
+        void* p;
+        if (SDL_LockTexture(frame, NULL, &p, &pitch) != 0) {
+            SDL_Log("Could not lock frame: %s\n", SDL_GetError());
+            return;
+        }
+        pixels = (Uint32*)p;
+        rendererHandler();
+        SDL_UnlockTexture(frame);
+        pixels = NULL;
+
+        SDL_RenderCopy(renderer, frame, NULL, NULL);
+        SDL_RenderPresent(renderer);
+        return;
+    }
+
     // clear screen
+    glBindFramebuffer(GL_FRAMEBUFFER, offscreenFBO);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     // render objects
     rendererHandler();
 
-    // flush and render to SDL window (swaps render buffers)
+    // flush and render to SDL window (swaps render buffers); offscreen there is nothing to swap, nor a display to wait for
     glFlush();
-    SDL_GL_SwapWindow(window);
+    if (mode != KernelMode::Headless)
+        SDL_GL_SwapWindow(window);
 }
 
 /**
@@ -93,6 +186,12 @@ bool Kernel::initSDL() {
         SDL_Log("Unable to initialize SDL: %s\n", SDL_GetError());
         return false;
     }
+
+    // the GL attributes would also apply to a GL backed SDL renderer, which cannot run on a 4.3 core context
+    if (mode == KernelMode::Software) {
+        SDL_Log("SDL Initialized");
+        return true;
+    }
     
     //Specify OpenGL Version (4.3)
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
@@ -120,9 +219,31 @@ bool Kernel::initGL() {
     // Check GLEW initialization
     glewExperimental = GL_TRUE;
     GLenum error = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // a GLEW built for GLX loads the entry points of an EGL context, then fails looking for a GLX display it does not need
+    if (mode == KernelMode::Headless && error == GLEW_ERROR_NO_GLX_DISPLAY)
+        error = GLEW_OK;
+#endif
     if(error != GLEW_OK) {
         SDL_Log("Could not initialize GLEW: %s\n", glewGetErrorString(error));
         return false;
+    } else if (mode == KernelMode::Headless) {
+        SDL_Log("GLEW initialized successfully");
+
+        // the frame's color buffer, where a window would have its back buffer; there is no vsync to set
+        glGenRenderbuffers(1, &offscreenRBO);
+        glBindRenderbuffer(GL_RENDERBUFFER, offscreenRBO);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, rx, ry);
+        glGenFramebuffers(1, &offscreenFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, offscreenFBO);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, offscreenRBO);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            SDL_Log("Offscreen framebuffer incomplete\n");
+            return false;
+        }
+        glViewport(0, 0, rx, ry);
+        SDL_Log("Offscreen framebuffer created");
+        return true;
     } else {
         SDL_Log("GLEW initialized successfully");
         glViewport(0, 0, (GLsizei)SDL_GetWindowSurface(window)->w, (GLsizei)SDL_GetWindowSurface(window)->h);
@@ -138,6 +259,53 @@ bool Kernel::initGL() {
     return true;
 }
 
+/**
+ * @brief Creates and binds an offscreen OpenGL 4.3 core context on Mesa's surfaceless EGL platform, which needs no display or window
+ * system and runs on llvmpipe without a GPU. The context has no surface; frames go to the framebuffer initGL creates
+ * 
+ * @return bool representing the success of the operation
+ */
+bool Kernel::initHeadless() {
+#ifdef KERNEL_EGL
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (extensions == NULL || strstr(extensions, "EGL_MESA_platform_surfaceless") == NULL || getPlatformDisplay == NULL) {
+        SDL_Log("EGL_MESA_platform_surfaceless is not available\n");
+        return false;
+    }
+
+    EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        SDL_Log("Could not initialize EGL: 0x%x\n", eglGetError());
+        return false;
+    }
+    eglDisplay = display;
+
+    // no config and no surface (EGL_KHR_no_config_context, EGL_KHR_surfaceless_context)
+    EGLint attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = EGL_NO_CONTEXT;
+    if (eglBindAPI(EGL_OPENGL_API))
+        context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        SDL_Log("Could not create a headless OpenGL 4.3 context: 0x%x\n", eglGetError());
+        return false;
+    }
+    eglContext = context;
+
+    SDL_Log("Headless EGL %d.%d context created", major, minor);
+    return true;
+#else
+    SDL_Log("Headless mode needs EGL (EGL_MESA_platform_surfaceless), which this build does not have\n");
+    return false;
+#endif
+}
+
 /**
  * @brief Initializes SDL_Image image loading
  * 
@@ -198,6 +366,15 @@ bool Kernel::registerPreLoopStep(void (*f)()) {
     return true;
 }
 
+/**
+ * @brief Sets the number of frames after which the render loop stops by itself
+ * 
+ * @param frames Frames to run; 0 runs until stop() is called
+ */
+void Kernel::setFrameLimit(int frames) {
+    frameLimit = frames;
+}
+
 /**
  * @brief Creates a window object with a registered OpenGL context
  * 
@@ -213,7 +390,7 @@ SDL_Window* Kernel::createWindow(string title, int rx, int ry) {
         SDL_WINDOWPOS_CENTERED,
         rx,
         ry,
-        SDL_WINDOW_OPENGL
+        mode == KernelMode::Software ? 0 : SDL_WINDOW_OPENGL
     );
 
     if(wind == NULL) {
@@ -232,7 +409,9 @@ SDL_Window* Kernel::createWindow(string title, int rx, int ry) {
  * @return SDL_Renderer* pointer to SDL renderer
  */
 SDL_Renderer* Kernel::createRenderer(SDL_Window* wind) {
-    SDL_Renderer* rend = SDL_CreateRenderer(wind, -1, SDL_RENDERER_ACCELERATED);
+    // in software mode any driver SDL has will do, down to its own software renderer; vsync as initGL's
+    Uint32 flags = mode == KernelMode::Software ? SDL_RENDERER_PRESENTVSYNC : SDL_RENDERER_ACCELERATED;
+    SDL_Renderer* rend = SDL_CreateRenderer(wind, -1, flags);
     
     if(rend == NULL) {
         SDL_Log("Could not create renderer: %s\n", SDL_GetError());
@@ -247,44 +426,75 @@ SDL_Renderer* Kernel::createRenderer(SDL_Window* wind) {
  * @brief Initializes necessary objects and starts the render loop
  */
 void Kernel::start() {
-    // init SDL
-    if (!initSDL())
-        throw std::runtime_error("SDL failed to initialize. Initialization failed");
-
-    // create window
-    window = createWindow(title, rx, ry);
-    if (window == NULL)
-        throw std::runtime_error("Window failed to be created. Initialization failed");
-
-    // link renderer
-    renderer = createRenderer(window);
-    if (renderer == NULL)
-        throw std::runtime_error("Renderer failed to be created. Initialization failed");
-
-    // create gl context
-    glContext = SDL_GL_CreateContext(window);
-
-    // init openGL
-    if (!initGL())
-        throw std::runtime_error("OpenGL failed to initialize. Initialization failed");
-    
-    // init SDL Image
-    if (!initIMG())
-        throw std::runtime_error("SDL Image failed to initialize. Initialization failed");
+    if (mode == KernelMode::Headless) {
+        // an offscreen context instead of SDL; no window, renderer or image loading
+        if (!initHeadless())
+            throw std::runtime_error("Headless OpenGL context failed to be created. Initialization failed");
+
+        // init openGL
+        if (!initGL())
+            throw std::runtime_error("OpenGL failed to initialize. Initialization failed");
+    } else {
+        // init SDL
+        if (!initSDL())
+            throw std::runtime_error("SDL failed to initialize. Initialization failed");
+
+        // create window
+        window = createWindow(title, rx, ry);
+        if (window == NULL)
+            throw std::runtime_error("Window failed to be created. Initialization failed");
+
+        // link renderer
+        renderer = createRenderer(window);
+        if (renderer == NULL)
+            throw std::runtime_error("Renderer failed to be created. Initialization failed");
+
+        if (mode == KernelMode::Software) {
+            // the frame the renderer handler writes into, instead of a gl context
+            frame = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, rx, ry);
+            if (frame == NULL)
+                throw std::runtime_error("Frame texture failed to be created. Initialization failed");
+            SDL_Log("Software frame created");
+        } else {
+            // create gl context
+            glContext = SDL_GL_CreateContext(window);
+
+            // init openGL
+            if (!initGL())
+                throw std::runtime_error("OpenGL failed to initialize. Initialization failed");
+        }
+        
+        // init SDL Image
+        if (!initIMG())
+            throw std::runtime_error("SDL Image failed to initialize. Initialization failed");
+    }
     
     SDL_Log("Render loop started");
     running = true;
     
     preLoopStep(); // shadershader program
+    int frames = 0;
+    auto t0 = std::chrono::steady_clock::now();
     while (running) {
-        // handle events
-        eventHandler();
+        // handle events; offscreen there are none
+        if (mode != KernelMode::Headless)
+            eventHandler();
 
         // update objects
         updateHandler();
 
         // render objects
         render();
+
+        frames ++;
+        if (frames == frameLimit)
+            running = false;
+    }
+
+    if (mode == KernelMode::Headless) {
+        glFinish();
+        std::chrono::duration<double> d = std::chrono::steady_clock::now() - t0;
+        cout << frames << " frames in " << d.count() << " s (" << frames / d.count() << " frames/s)" << endl;
     }
     SDL_Log("Render loop stopped");
 }
@@ -359,11 +569,32 @@ void Kernel::flipSurface(SDL_Surface* surface) {
  */
 bool Kernel::saveImage(SDL_Window* window, SDL_Renderer* renderer, const char* file) {
     int w,h;
-    SDL_GetRendererOutputSize(renderer, &w, &h);
+    if (mode == KernelMode::Headless) {
+        w = rx;
+        h = ry;
+    } else {
+        SDL_GetRendererOutputSize(renderer, &w, &h);
+    }
+
+    if (mode == KernelMode::Software) {
+        // the back buffer holds nothing after a present, so the frame is drawn once more to be read back
+        SDL_Surface* image = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
+        SDL_RenderCopy(renderer, frame, NULL, NULL);
+        SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ABGR8888, image->pixels, image->pitch);
+        SDL_SaveBMP(image, file);
+        SDL_FreeSurface(image);
+        return true;
+    }
 
     SDL_Surface* image = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0);
 
-    glReadBuffer(GL_FRONT);
+    // offscreen, the frame is the color buffer of the kernel's framebuffer
+    if (mode == KernelMode::Headless) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, offscreenFBO);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+    } else {
+        glReadBuffer(GL_FRONT);
+    }
     glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, image->pixels);
 
     flipSurface(image);
@@ -31,9 +31,19 @@ using std::string;
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+/**
+ * @brief How a kernel shows its frames
+ */
+enum class KernelMode {
+    GL,         // a window with an OpenGL 4.3 core context
+    Software,   // a window without GL; the renderer handler writes the frame into a streaming texture (getPixels) that SDL presents
+    Headless    // no window, events or vsync; an offscreen OpenGL 4.3 core context (EGL_MESA_platform_surfaceless) rendering into
+                // getFramebuffer(), for machines without a display. Runs as many frames as setFrameLimit asks, as fast as it can
+};
+
 class Kernel {
     public:
-        Kernel(string title, int rx, int ry);
+        Kernel(string title, int rx, int ry, KernelMode mode = KernelMode::GL);
         ~Kernel();
 
         // renders to the screen based off of a function that draws all objects on the screen (independently of the kernel object)
@@ -47,6 +57,9 @@ class Kernel {
         // A function that runs immediately before the start loop
         bool registerPreLoopStep(void (*f)());
 
+        // stops the render loop after this many frames; 0 (the default) runs until stop()
+        void setFrameLimit(int frames);
+
         // starts window render loop
         void start();
         
@@ -59,6 +72,16 @@ class Kernel {
         int getRY();
         SDL_Window* getWindow();
         SDL_Renderer* getRenderer();
+        bool isSoftware();
+        bool isHeadless();
+
+        // the framebuffer the frame is drawn into; 0 (the window's) except in headless mode
+        GLuint getFramebuffer();
+
+        // software mode; the locked frame, rx * ry pixels of SDL_PIXELFORMAT_ABGR8888 rows getPitch() bytes apart, top row first. Only
+        // valid within the renderer handler
+        Uint32* getPixels();
+        int getPitch();
 
         // save window as image
         bool saveImage(SDL_Window* window, SDL_Renderer* renderer, const char* file);
@@ -69,6 +92,7 @@ class Kernel {
 
         bool initSDL();
         bool initGL();
+        bool initHeadless();
         bool initIMG();
 
         Uint32 getPixel(SDL_Surface* surface, int x, int y);
@@ -80,6 +104,19 @@ class Kernel {
         SDL_Window* window;
         SDL_Renderer* renderer;
         SDL_GLContext glContext;
+
+        KernelMode mode;
+        int frameLimit = 0;
+
+        // software mode
+        SDL_Texture* frame;
+        Uint32* pixels;
+        int pitch;
+
+        // headless mode; the EGL display and context (EGLDisplay, EGLContext), and the offscreen framebuffer and its color buffer
+        void* eglDisplay;
+        void* eglContext;
+        GLuint offscreenFBO, offscreenRBO;
         
         void (*eventHandler)() = NULL;
         void (*rendererHandler)() = NULL;
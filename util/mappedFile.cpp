@@ -0,0 +1,152 @@
+/**
+ * @file mappedFile.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Files mapped into memory, with read ahead and write back hints for streaming through them (mmap / madvise on POSIX, file
+ * mappings / PrefetchVirtualMemory on Windows)
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "mappedFile.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static size_t pageSize() {
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwPageSize;
+#else
+    return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+bool mapFile(const std::string& path, size_t bytes, MappedFile* f) {
+    f->path = path;
+    f->bytes = bytes;
+#ifdef _WIN32
+    HANDLE h = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+    HANDLE m = CreateFileMappingA(h, NULL, PAGE_READWRITE, (DWORD)((uint64_t)bytes >> 32), (DWORD)bytes, NULL);
+    void* p = m != NULL ? MapViewOfFile(m, FILE_MAP_ALL_ACCESS, 0, 0, bytes) : NULL;
+    if (p == NULL) {
+        if (m != NULL)
+            CloseHandle(m);
+        CloseHandle(h);
+        DeleteFileA(path.c_str());
+        return false;
+    }
+    f->file = (intptr_t)h;
+    f->mapping = (intptr_t)m;
+    f->base = p;
+#else
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0)
+        return false;
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, (off_t)bytes) == 0)
+        p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        close(fd);
+        unlink(path.c_str());
+        return false;
+    }
+    f->file = fd;
+    f->base = p;
+#endif
+    return true;
+}
+
+void unmapFile(MappedFile* f, bool remove) {
+    if (f->base == NULL)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(f->base);
+    CloseHandle((HANDLE)f->mapping);
+    CloseHandle((HANDLE)f->file);
+    if (remove)
+        DeleteFileA(f->path.c_str());
+#else
+    munmap(f->base, f->bytes);
+    close((int)f->file);
+    if (remove)
+        unlink(f->path.c_str());
+#endif
+    f->base = NULL;
+}
+
+void prefetchFile(const MappedFile& f, size_t off, size_t len) {
+    if (off >= f.bytes)
+        return;
+    size_t page = pageSize();
+    size_t a = off / page * page;
+    size_t e = std::min(off + len, f.bytes);
+    if (e <= a)
+        return;
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY r;
+    r.VirtualAddress = (char*)f.base + a;
+    r.NumberOfBytes = e - a;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &r, 0);
+#else
+    madvise((char*)f.base + a, e - a, MADV_WILLNEED);
+#endif
+}
+
+void evictFile(const MappedFile& f, size_t off, size_t len) {
+    size_t page = pageSize();
+    size_t a = (off + page - 1) / page * page;
+    size_t e = std::min(off + len, f.bytes) / page * page;
+    if (e <= a)
+        return;
+    char* p = (char*)f.base + a;
+#ifdef _WIN32
+    // starts the write back, then trims the pages from the working set (unlocking pages that are not locked does exactly that)
+    FlushViewOfFile(p, e - a);
+    VirtualUnlock(p, e - a);
+#else
+    // start the write back without waiting for it, unmap the pages from the process, and let the page cache drop them once clean. For a
+    // shared file mapping MADV_DONTNEED loses nothing: dirty pages are still in the page cache and reach the file
+    msync(p, e - a, MS_ASYNC);
+#ifdef __linux__
+    sync_file_range((int)f.file, (off_t)a, (off_t)(e - a), SYNC_FILE_RANGE_WRITE);
+#endif
+    madvise(p, e - a, MADV_DONTNEED);
+#ifdef POSIX_FADV_DONTNEED
+    posix_fadvise((int)f.file, (off_t)a, (off_t)(e - a), POSIX_FADV_DONTNEED);
+#endif
+#endif
+}
+
+size_t residentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS c;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &c, sizeof(c)))
+        return 0;
+    return c.WorkingSetSize;
+#elif defined(__linux__)
+    // the second field of statm is the resident set in pages
+    FILE* s = fopen("/proc/self/statm", "r");
+    if (s == NULL)
+        return 0;
+    unsigned long size = 0, resident = 0;
+    int n = fscanf(s, "%lu %lu", &size, &resident);
+    fclose(s);
+    return n == 2 ? resident * pageSize() : 0;
+#else
+    return 0;
+#endif
+}
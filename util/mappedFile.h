@@ -0,0 +1,48 @@
+/**
+ * @file mappedFile.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Files mapped into memory, with read ahead and write back hints for streaming through them (mmap / madvise on POSIX, file
+ * mappings / PrefetchVirtualMemory on Windows)
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+A mapped file lets a structure larger than RAM be addressed like memory: the OS reads pages in on first access and writes dirty ones
+back when it needs the memory. Left alone it does both a page at a time and picks its own victims, so a sweep over the file turns into
+random I/O. prefetchFile asks for a range to be read ahead before it is needed, and evictFile starts writing a range back and drops it
+from the process (and, once clean, from the page cache), so that a program sweeping the file in order keeps a bounded window resident
+and reads and writes every page once, sequentially. Both are hints; the data is the same whether or not the OS follows them.
+*/
+
+struct MappedFile {
+    void* base = NULL;
+    size_t bytes = 0;
+    intptr_t file = -1;   // descriptor (POSIX) or handle (Windows)
+    intptr_t mapping = 0; // the file mapping object (Windows)
+    std::string path;
+};
+
+// creates (or truncates) path to bytes of zeros and maps it shared, read write; false if the OS refused
+bool mapFile(const std::string& path, size_t bytes, MappedFile* f);
+
+// unmaps f and closes it, deleting the file if remove
+void unmapFile(MappedFile* f, bool remove);
+
+// reads [off, off + len) ahead; the range is widened to whole pages
+void prefetchFile(const MappedFile& f, size_t off, size_t len);
+
+// writes back the pages inside [off, off + len) and drops them; only whole pages, so neighbors sharing a page are left alone
+void evictFile(const MappedFile& f, size_t off, size_t len);
+
+// bytes of the process that are resident in memory, or 0 where the OS does not say
+size_t residentBytes();
+
+#endif
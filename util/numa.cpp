@@ -0,0 +1,288 @@
+/**
+ * @file numa.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief NUMA topology, thread pinning and page placement, straight from the OS (sysfs and syscalls on Linux, the NUMA API on Windows)
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "numa.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+// huge page size mappings are rounded to; 2 MB on x86-64 for both Linux and Windows
+static const size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+const char* pageKindName(PageKind k) {
+    switch (k) {
+        case PageKind::Huge: return "huge pages";
+        case PageKind::Transparent: return "transparent huge pages";
+        default: return "normal pages";
+    }
+}
+
+/**
+ * @brief The machine's nodes and CPUs, read once
+ */
+struct Topology {
+    int nodes = 1;
+    std::vector<int> cpus;   // node by node
+    std::vector<int> nodeOf; // by CPU number
+
+    Topology();
+};
+
+#if !defined(_WIN32) && defined(__linux__)
+static std::string readFile(const std::string& path) {
+    std::ifstream f(path);
+    std::stringstream s;
+    s << f.rdbuf();
+    return s.str();
+}
+
+// a sysfs list such as "0-3,8-11"
+static std::vector<int> parseList(const std::string& s) {
+    std::vector<int> v;
+    size_t i = 0;
+    auto number = [&]() {
+        int n = 0;
+        while (i < s.size() && s[i] >= '0' && s[i] <= '9')
+            n = n * 10 + (s[i ++] - '0');
+        return n;
+    };
+    while (i < s.size()) {
+        if (s[i] < '0' || s[i] > '9') {
+            i ++;
+            continue;
+        }
+        int a = number(), b = a;
+        if (i < s.size() && s[i] == '-') {
+            i ++;
+            b = number();
+        }
+        for (int c = a; c <= b; c ++)
+            v.push_back(c);
+    }
+    return v;
+}
+#endif
+
+Topology::Topology() {
+#ifdef _WIN32
+    ULONG highest = 0;
+    if (GetNumaHighestNodeNumber(&highest))
+        nodes = (int)highest + 1;
+    for (int n = 0; n < nodes; n ++) {
+        GROUP_AFFINITY ga = {};
+        if (!GetNumaNodeProcessorMaskEx((USHORT)n, &ga))
+            continue;
+        for (int b = 0; b < 64; b ++) {
+            if (ga.Mask & ((KAFFINITY)1 << b)) {
+                int cpu = ga.Group * 64 + b;
+                cpus.push_back(cpu);
+                if ((int)nodeOf.size() <= cpu)
+                    nodeOf.resize(cpu + 1, 0);
+                nodeOf[cpu] = n;
+            }
+        }
+    }
+#elif defined(__linux__)
+    // only the CPUs this process is allowed on (taskset, cgroups)
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveAllowed = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+    std::vector<int> online = parseList(readFile("/sys/devices/system/node/online"));
+    for (int n : online) {
+        for (int cpu : parseList(readFile("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist"))) {
+            if (haveAllowed && (cpu >= CPU_SETSIZE || !CPU_ISSET(cpu, &allowed)))
+                continue;
+            cpus.push_back(cpu);
+            if ((int)nodeOf.size() <= cpu)
+                nodeOf.resize(cpu + 1, 0);
+            nodeOf[cpu] = n;
+        }
+        nodes = std::max(nodes, n + 1);
+    }
+    if (cpus.empty() && haveAllowed) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu ++)
+            if (CPU_ISSET(cpu, &allowed))
+                cpus.push_back(cpu);
+    }
+#endif
+
+    // no topology; one node holding every hardware thread
+    if (cpus.empty()) {
+        nodes = 1;
+        int n = (int)std::thread::hardware_concurrency();
+        for (int cpu = 0; cpu < std::max(n, 1); cpu ++)
+            cpus.push_back(cpu);
+    }
+    if (nodeOf.empty())
+        nodeOf.assign(cpus.back() + 1, 0);
+}
+
+static const Topology& topology() {
+    static Topology t;
+    return t;
+}
+
+int numaNodeCount() {
+    return topology().nodes;
+}
+
+std::vector<int> cpusByNode() {
+    return topology().cpus;
+}
+
+int cpuNode(int cpu) {
+    const Topology& t = topology();
+    return cpu >= 0 && cpu < (int)t.nodeOf.size() ? t.nodeOf[cpu] : 0;
+}
+
+bool pinThread(int cpu) {
+#ifdef _WIN32
+    GROUP_AFFINITY a = {};
+    a.Group = (WORD)(cpu / 64);
+    a.Mask = (KAFFINITY)1 << (cpu % 64);
+    return SetThreadGroupAffinity(GetCurrentThread(), &a, NULL) != 0;
+#elif defined(__linux__)
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void* mapPages(size_t& bytes, bool huge, PageKind* kind) {
+    size_t b = (std::max(bytes, (size_t)1) + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+    void* p = NULL;
+    PageKind got = PageKind::Normal;
+
+#ifdef _WIN32
+    // large pages need the "Lock pages in memory" privilege, which most accounts lack; then the plain allocation
+    SIZE_T large = GetLargePageMinimum();
+    if (huge && large != 0 && b % large == 0) {
+        p = VirtualAlloc(NULL, b, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        got = PageKind::Huge;
+    }
+    if (p == NULL) {
+        p = VirtualAlloc(NULL, b, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        got = PageKind::Normal;
+    }
+    if (p == NULL)
+        throw std::bad_alloc();
+#else
+    p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    // only succeeds if the administrator reserved huge pages (vm.nr_hugepages)
+    if (huge) {
+        p = mmap(NULL, b, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        got = PageKind::Huge;
+    }
+#endif
+    if (p == MAP_FAILED) {
+        p = mmap(NULL, b, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            throw std::bad_alloc();
+        got = PageKind::Normal;
+#ifdef MADV_HUGEPAGE
+        if (huge && madvise(p, b, MADV_HUGEPAGE) == 0)
+            got = PageKind::Transparent;
+#endif
+    }
+#endif
+
+    bytes = b;
+    if (kind != NULL)
+        *kind = got;
+    return p;
+}
+
+void unmapPages(void* p, size_t bytes) {
+    if (p == NULL)
+        return;
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, bytes);
+#endif
+}
+
+bool pageNodes(const void* p, size_t bytes, std::vector<long long>& perNode) {
+    int nodes = numaNodeCount();
+    perNode.assign(nodes, 0);
+    const size_t BATCH = 4096;
+
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    uintptr_t page = si.dwPageSize;
+    uintptr_t a = (uintptr_t)p / page * page, e = (uintptr_t)p + bytes;
+    std::vector<PSAPI_WORKING_SET_EX_INFORMATION> info;
+    for (; a < e; ) {
+        info.clear();
+        for (; a < e && info.size() < BATCH; a += page) {
+            PSAPI_WORKING_SET_EX_INFORMATION w = {};
+            w.VirtualAddress = (PVOID)a;
+            info.push_back(w);
+        }
+        if (!QueryWorkingSetEx(GetCurrentProcess(), info.data(), (DWORD)(info.size() * sizeof(info[0]))))
+            return false;
+        for (const PSAPI_WORKING_SET_EX_INFORMATION& w : info)
+            if (w.VirtualAttributes.Valid && (int)w.VirtualAttributes.Node < nodes)
+                perNode[w.VirtualAttributes.Node] ++;
+    }
+    return true;
+#elif defined(__linux__) && defined(SYS_move_pages)
+    // move_pages with no target nodes only reports where each page is
+    uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t a = (uintptr_t)p / page * page, e = (uintptr_t)p + bytes;
+    std::vector<void*> pages;
+    std::vector<int> status;
+    for (; a < e; ) {
+        pages.clear();
+        for (; a < e && pages.size() < BATCH; a += page)
+            pages.push_back((void*)a);
+        status.assign(pages.size(), -1);
+        if (syscall(SYS_move_pages, 0, (unsigned long)pages.size(), pages.data(), NULL, status.data(), 0) < 0)
+            return false;
+        for (int s : status)
+            if (s >= 0 && s < nodes)
+                perNode[s] ++;
+    }
+    return true;
+#else
+    (void)p;
+    (void)bytes;
+    (void)BATCH;
+    return false;
+#endif
+}
@@ -0,0 +1,63 @@
+/**
+ * @file numa.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief NUMA topology, thread pinning and page placement, straight from the OS (sysfs and syscalls on Linux, the NUMA API on Windows)
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <cstddef>
+#include <vector>
+
+/*
+On a multi-socket machine each socket's memory is a NUMA node, and a page lives on the node of the thread that first writes it. The
+CPU engine uses this to place every row of a plane on the socket of the pool thread whose tiles sweep it: the pool pins its threads to
+cores node by node (so consecutive threads, which get neighboring rows, share a node), and fields are mapped untouched and then zeroed
+row range by row range from those threads.
+
+Where the OS gives no topology (or there is one node) everything still works, as one node with every logical CPU on it.
+*/
+
+// what backs a mapping
+enum class PageKind {
+    Normal,      // the OS's base pages
+    Transparent, // base pages the OS was asked to merge into huge pages (Linux THP)
+    Huge         // explicit huge / large pages
+};
+
+const char* pageKindName(PageKind k);
+
+// NUMA nodes of the machine; 1 where unknown
+int numaNodeCount();
+
+// logical CPUs the process may run on, node by node, ascending within a node
+std::vector<int> cpusByNode();
+
+// node of a logical CPU; 0 where unknown
+int cpuNode(int cpu);
+
+// restricts the calling thread to one logical CPU; false if the OS refused or cannot
+bool pinThread(int cpu);
+
+/**
+ * @brief Maps fresh zero pages that no thread has touched yet, so the first thread to write a page decides its node
+ *
+ * @param bytes Length; rounded up to a whole number of huge pages, the mapping's real length
+ * @param huge Try explicit huge pages, then transparent ones, before base pages
+ * @param kind What the mapping got
+ */
+void* mapPages(size_t& bytes, bool huge, PageKind* kind);
+void unmapPages(void* p, size_t bytes);
+
+/**
+ * @brief Counts the resident pages of [p, p + bytes) per node
+ *
+ * @param perNode Resized to numaNodeCount(); pages not resident or on unknown nodes are not counted
+ * @return false if the OS cannot say where pages are
+ */
+bool pageNodes(const void* p, size_t bytes, std::vector<long long>& perNode);
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * @file reduce.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Fixed shape, optionally compensated combination of per tile partial results, for reductions that do not depend on the thread count
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <cmath>
+
+/*
+Floating point addition is not associative, so a sum whose terms are grouped by thread (per thread partials, an atomic accumulator)
+changes in the last bits with the thread count and the schedule. Executor::parallelReduce instead cuts the range into tiles of a size the
+caller fixes, keeps one value per tile, and combines them here in a pairwise tree whose shape only depends on the number of tiles; the
+result is the same bits on any backend and any number of threads. A pairwise tree also bounds the rounding error by O(log tiles) rather
+than O(tiles); CompensatedSum additionally carries each addition's rounding error through the tree (Neumaier), and NeumaierSum does the
+same inside a tile.
+*/
+
+// how the tiles' values are combined
+enum class Combine {
+    Sum,
+    CompensatedSum,
+    Max,
+    Min
+};
+
+/**
+ * @brief Running sum with Neumaier's compensation; the rounding error of every addition is kept in c and added back at the end
+ */
+struct NeumaierSum {
+    double sum = 0.0;
+    double c = 0.0;
+
+    void add(double x) {
+        double t = sum + x;
+        if (std::fabs(sum) >= std::fabs(x))
+            c += (sum - t) + x;
+        else
+            c += (x - t) + sum;
+        sum = t;
+    }
+
+    // merges another partial sum, compensating the addition of the two
+    void add(const NeumaierSum& o) {
+        add(o.sum);
+        c += o.c;
+    }
+
+    double value() const { return sum + c; }
+};
+
+/**
+ * @brief v[0, n) combined in a pairwise tree, splitting every range at its midpoint; n > 0
+ */
+inline NeumaierSum reduceTree(const double* v, int n, Combine combine) {
+    if (n == 1) {
+        NeumaierSum s;
+        s.sum = v[0];
+        return s;
+    }
+    NeumaierSum a = reduceTree(v, n / 2, combine);
+    NeumaierSum b = reduceTree(v + n / 2, n - n / 2, combine);
+    switch (combine) {
+        case Combine::CompensatedSum:
+            a.add(b);
+            break;
+        case Combine::Max:
+            a.sum = a.sum >= b.sum ? a.sum : b.sum;
+            break;
+        case Combine::Min:
+            a.sum = a.sum <= b.sum ? a.sum : b.sum;
+            break;
+        default:
+            a.sum += b.sum;
+            break;
+    }
+    return a;
+}
+
+#endif
@@ -0,0 +1,59 @@
+/**
+ * @file spscQueue.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Bounded lock free queue between one producer thread and one consumer thread
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Ring of capacity slots (rounded up to a power of two), the two counters in their own cache lines like the channels of
+ * haloTransport.cpp. Neither side takes a lock or waits: push fails while the ring is full, pop while it is empty
+ */
+template<class T>
+class SpscQueue {
+    public:
+        explicit SpscQueue(int capacity = 256) {
+            size_t n = 1;
+            while (n < (size_t)capacity)
+                n <<= 1;
+            buf.resize(n);
+            mask = n - 1;
+        }
+
+        // producer only
+        bool push(const T& v) {
+            uint64_t t = tail.load(std::memory_order_relaxed);
+            if (t - head.load(std::memory_order_acquire) > mask)
+                return false;
+            buf[t & mask] = v;
+            tail.store(t + 1, std::memory_order_release);
+            return true;
+        }
+
+        // consumer only
+        bool pop(T& v) {
+            uint64_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+                return false;
+            v = buf[h & mask];
+            head.store(h + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        alignas(64) std::atomic<uint64_t> head{0}; // advanced by the consumer
+        alignas(64) std::atomic<uint64_t> tail{0}; // advanced by the producer
+        std::vector<T> buf;
+        uint64_t mask;
+};
+
+#endif
@@ -0,0 +1,182 @@
+/**
+ * @file taskGraph.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Dependency graph of row tiled passes, run on an Executor so that independent passes overlap
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "taskGraph.h"
+
+#include <algorithm>
+#include <thread>
+
+// whether a and b share a field
+static bool overlaps(const std::vector<const void*>& a, const std::vector<const void*>& b) {
+    for (const void* p : a)
+        if (std::find(b.begin(), b.end(), p) != b.end())
+            return true;
+    return false;
+}
+
+int TaskGraph::add(const char* name, int rows, int grain, std::function<void(int, int)> body, std::initializer_list<const void*> reads,
+    std::initializer_list<const void*> writes, std::function<void()> prologue) {
+    int index = (int)nodes.size();
+    nodes.emplace_back();
+    Node& n = nodes.back();
+    n.name = name;
+    n.rows = rows;
+    n.grain = grain < 1 ? 1 : grain;
+    n.tiles = (rows + n.grain - 1) / n.grain;
+    n.body = body;
+    n.prologue = prologue;
+    n.reads = reads;
+    n.writes = writes;
+    n.rank = 0;
+
+    // read after write, write after read, write after write
+    for (int k = 0; k < index; k ++) {
+        Node& e = nodes[k];
+        if (overlaps(e.writes, n.reads) || overlaps(e.reads, n.writes) || overlaps(e.writes, n.writes)) {
+            n.preds.push_back(k);
+            e.succs.push_back(index);
+        }
+    }
+
+    preparedFor = 0;
+    return index;
+}
+
+/**
+ * @brief Ranks the nodes and sizes their claim counters for threads threads; only after add() or a change of pool
+ */
+void TaskGraph::prepare(int threads) {
+    if (preparedFor == threads)
+        return;
+
+    // predecessors always have lower indices, so walking backwards sees every successor first
+    for (int i = (int)nodes.size() - 1; i >= 0; i --) {
+        long long after = 0;
+        for (int s : nodes[i].succs)
+            after = std::max(after, nodes[s].rank);
+        nodes[i].rank = nodes[i].tiles + after;
+    }
+
+    order.resize(nodes.size());
+    for (int i = 0; i < (int)nodes.size(); i ++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return nodes[a].rank > nodes[b].rank; });
+
+    for (Node& n : nodes)
+        n.claimed.reset(new std::atomic<int>[threads]);
+    preparedFor = threads;
+}
+
+void TaskGraph::run(Executor* pool) {
+    int threads = pool != NULL ? pool->size() : 1;
+
+    // one thread; program order is an order the graph allows
+    if (threads == 1) {
+        for (Node& n : nodes) {
+            if (n.prologue)
+                n.prologue();
+            for (int y = 0; y < n.rows; y += n.grain)
+                n.body(y, std::min(y + n.grain, n.rows));
+        }
+        return;
+    }
+
+    prepare(threads);
+    for (Node& n : nodes) {
+        n.waiting.store((int)n.preds.size(), std::memory_order_relaxed);
+        n.open.store(false, std::memory_order_relaxed);
+        n.done.store(0, std::memory_order_relaxed);
+        for (int t = 0; t < threads; t ++)
+            n.claimed[t].store(0, std::memory_order_relaxed);
+    }
+    remaining.store((int)nodes.size());
+
+    for (Node& n : nodes)
+        if (n.preds.empty())
+            openNode(n);
+
+    pool->runOnEach([&](int self) {
+        schedule(self, threads);
+    });
+}
+
+/**
+ * @brief Runs n's prologue and lets threads claim its tiles; finishes it at once if it has none
+ */
+void TaskGraph::openNode(Node& n) {
+    if (n.prologue)
+        n.prologue();
+    if (n.tiles == 0)
+        finish(n);
+    else
+        n.open.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Marks n done, opening every successor it was the last predecessor of
+ */
+void TaskGraph::finish(Node& n) {
+    for (int s : n.succs)
+        if (nodes[s].waiting.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            openNode(nodes[s]);
+    remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+/**
+ * @brief Takes an unclaimed tile of n, from thread self's own section if any is left, else from the others in turn
+ */
+bool TaskGraph::claim(Node& n, int self, int threads, int& tile) {
+    for (int k = 0; k < threads; k ++) {
+        int s = (self + k) % threads;
+        int b = (int)((long long)n.tiles * s / threads);
+        int e = (int)((long long)n.tiles * (s + 1) / threads);
+        if (n.claimed[s].load(std::memory_order_relaxed) >= e - b)
+            continue;
+        int t = n.claimed[s].fetch_add(1, std::memory_order_relaxed);
+        if (t < e - b) {
+            tile = b + t;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief One thread's share of run(): tiles of the most critical open node, until every node is done
+ */
+void TaskGraph::schedule(int self, int threads) {
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        bool ran = false;
+        for (int k : order) {
+            Node& n = nodes[k];
+            int tile;
+            if (!n.open.load(std::memory_order_acquire) || !claim(n, self, threads, tile))
+                continue;
+
+            int y0 = tile * n.grain;
+            n.body(y0, std::min(y0 + n.grain, n.rows));
+            // the last tile's thread sees every other tile's writes through the release sequence on done
+            if (n.done.fetch_add(1, std::memory_order_acq_rel) + 1 == n.tiles)
+                finish(n);
+            ran = true;
+            break;
+        }
+        if (!ran)
+            std::this_thread::yield();
+    }
+}
+
+void TaskGraph::dump(FILE* out) const {
+    for (int i = 0; i < (int)nodes.size(); i ++) {
+        const Node& n = nodes[i];
+        fprintf(out, "%3d %-22s %5d tiles  rank %6lld  after", i, n.name, n.tiles, n.rank);
+        for (int p : n.preds)
+            fprintf(out, " %d", p);
+        fprintf(out, "\n");
+    }
+}
@@ -0,0 +1,92 @@
+/**
+ * @file taskGraph.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Dependency graph of row tiled passes, run on an Executor so that independent passes overlap
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef TASK_GRAPH_H
+#define TASK_GRAPH_H
+
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include "executor.h"
+
+/*
+Executor::parallelFor runs one pass at a time, with a barrier after it; threads that finish their share early wait there. A
+TaskGraph instead holds a whole frame's passes (nodes), each a body over row tiles like parallelFor's, plus the fields it reads and
+writes. add() orders a node after every earlier node it conflicts with (it reads what that one writes, or writes what that one reads or
+writes), so the graph runs the passes as if in program order while passes with no path between them can run at the same time.
+
+run() starts a scheduler loop on every executor slot (runOnEach). A node opens once its predecessors are done (its prologue, if any, runs first, on
+the thread that finished the last of them). Threads claim tiles of open nodes, most critical node first (the one with the most tiles
+still ahead of it on its longest path), so the long chain keeps every thread it can use and the tiles of short independent passes fill
+the gaps at the end of each of its passes. Within a node, thread i starts on the i-th contiguous section of the tiles, the rows
+parallelFor would deal it, and takes tiles from other sections once its own is exhausted.
+
+Graphs are built once and run every frame; run() itself does not allocate. Fields are identified by address only.
+*/
+
+class TaskGraph {
+    public:
+        TaskGraph() = default;
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        /**
+         * @brief Adds a pass over rows [0, rows) in tiles of grain rows, after every earlier pass it conflicts with
+         *
+         * @param name Label for dump()
+         * @param body Called with each tile's [y0, y1), on any pool thread
+         * @param reads Fields the pass reads
+         * @param writes Fields the pass writes
+         * @param prologue Run once before any tile, after every predecessor is done (e.g. refreshing ghost cells); may be empty
+         * @return Index of the node
+         */
+        int add(const char* name, int rows, int grain, std::function<void(int, int)> body, std::initializer_list<const void*> reads,
+            std::initializer_list<const void*> writes, std::function<void()> prologue = std::function<void()>());
+
+        // runs every node, returning once all are done; pool may be NULL (program order on the calling thread)
+        void run(Executor* pool);
+
+        // nodes, and for each its predecessors
+        void dump(FILE* out) const;
+
+        int size() const { return (int)nodes.size(); }
+
+    private:
+        struct Node {
+            const char* name;
+            int rows, grain, tiles;
+            std::function<void(int, int)> body;
+            std::function<void()> prologue;
+            std::vector<const void*> reads, writes;
+            std::vector<int> preds, succs;
+            long long rank; // tiles on the longest path from this node to the end, its own included
+
+            std::atomic<int> waiting{0};  // predecessors not yet done
+            std::atomic<bool> open{false};
+            std::atomic<int> done{0};     // tiles finished
+            std::unique_ptr<std::atomic<int>[]> claimed; // tiles taken from each thread's section
+        };
+
+        void prepare(int threads);
+        void schedule(int self, int threads);
+        bool claim(Node& n, int self, int threads, int& tile);
+        void openNode(Node& n);
+        void finish(Node& n);
+
+        std::deque<Node> nodes;
+        std::vector<int> order; // by rank, highest first
+        int preparedFor = 0;    // thread count the claim counters and order are for; 0 after add()
+        std::atomic<int> remaining{0};
+};
+
+#endif
@@ -0,0 +1,256 @@
+/**
+ * @file threadPool.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Work stealing thread pool for splitting solver passes into row tiles
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "threadPool.h"
+
+#include "numa.h"
+
+/**
+ * @brief Empties the deque and grows it to a power of two holding at least capacity tiles
+ */
+void WorkDeque::reset(int capacity) {
+    size_t size = 1;
+    while (size < (size_t)capacity)
+        size <<= 1;
+    if (buf.size() < size)
+        buf.resize(size);
+    mask = (long long)buf.size() - 1;
+    top.store(0, std::memory_order_relaxed);
+    bottom.store(0, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Pushes a tile at the bottom. Owner only (or any thread while the pool is between passes)
+ */
+void WorkDeque::push(Tile t) {
+    long long b = bottom.load(std::memory_order_relaxed);
+    buf[b & mask] = t;
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Pops the most recently pushed tile. Owner only
+ *
+ * @return false if the deque was empty (or the last tile was lost to a thief)
+ */
+bool WorkDeque::pop(Tile& t) {
+    long long b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long tp = top.load(std::memory_order_relaxed);
+
+    if (tp > b) {
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    t = buf[b & mask];
+    if (tp == b) {
+        // last tile; race any thief for it
+        bool won = top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+    return true;
+}
+
+/**
+ * @brief Steals the oldest tile. Any thread
+ *
+ * @return STOLEN with t set, EMPTY, or RETRY if another thread won the race for the same tile
+ */
+int WorkDeque::steal(Tile& t) {
+    long long tp = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long b = bottom.load(std::memory_order_acquire);
+
+    if (tp >= b)
+        return EMPTY;
+
+    t = buf[tp & mask];
+    if (!top.compare_exchange_strong(tp, tp + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return RETRY;
+    return STOLEN;
+}
+
+/**
+ * @brief Construct a new ThreadPool
+ *
+ * @param threads Total number of threads including the caller; 0 uses every hardware thread
+ * @param pin Pin every thread, the caller included, to its own CPU, node by node
+ */
+ThreadPool::ThreadPool(int threads, bool pin) {
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    if (pin) {
+        std::vector<int> order = cpusByNode();
+        for (int i = 0; i < threads; i ++)
+            cpus.push_back(order[i % order.size()]);
+        pinThread(cpus[0]);
+    }
+
+    deques = std::vector<WorkDeque>(threads);
+    for (int i = 1; i < threads; i ++)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        stopping = true;
+        epoch ++;
+    }
+    parkCv.notify_all();
+    for (std::thread& w : workers)
+        w.join();
+}
+
+/**
+ * @brief Runs body over row tiles on every thread of the pool, returning once all rows are done
+ *
+ * @param n Number of rows
+ * @param grain Rows per tile
+ * @param body Function called with each tile's [y0, y1)
+ */
+void ThreadPool::parallelFor(int n, int grain, FnRef<void(int, int)> body) {
+    if (grain < 1)
+        grain = 1;
+    int tiles = (n + grain - 1) / grain;
+    int threads = size();
+
+    // nothing to share; still honor the tile size, callers may depend on it
+    if (threads == 1 || tiles <= 1) {
+        for (int y = 0; y < n; y += grain)
+            body(y, y + grain < n ? y + grain : n);
+        return;
+    }
+
+    // deal contiguous blocks of tiles to each deque; pushed in reverse so the owner pops them top to bottom
+    for (int i = 0; i < threads; i ++) {
+        int t0 = (int)((long long)tiles * i / threads);
+        int t1 = (int)((long long)tiles * (i + 1) / threads);
+        deques[i].reset(t1 - t0);
+        for (int t = t1 - 1; t >= t0; t --) {
+            Tile tile = { t * grain, t * grain + grain < n ? t * grain + grain : n };
+            deques[i].push(tile);
+        }
+    }
+
+    this->body = &body;
+    pending.store(tiles);
+    active.store(threads - 1);
+    {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        epoch ++;
+    }
+    parkCv.notify_all();
+
+    setCurrentThread(0);
+    runTiles(0);
+
+    // barrier; every tile finished and every worker out of its deques before they can be refilled
+    while (pending.load() > 0 || active.load() > 0)
+        std::this_thread::yield();
+    this->body = NULL;
+}
+
+/**
+ * @brief Runs body(i) on every thread i of the pool, returning once all have
+ */
+void ThreadPool::runOnEach(FnRef<void(int)> body) {
+    int threads = size();
+    if (threads > 1) {
+        this->each = &body;
+        pending.store(0);
+        active.store(threads - 1);
+        {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            epoch ++;
+        }
+        parkCv.notify_all();
+    }
+
+    setCurrentThread(0);
+    body(0);
+
+    while (active.load() > 0)
+        std::this_thread::yield();
+    this->each = NULL;
+}
+
+/**
+ * @brief Drains this thread's deque, then steals from the others until every deque is empty
+ */
+void ThreadPool::runTiles(int index) {
+    const FnRef<void(int, int)>& f = *body;
+    int threads = size();
+    unsigned int rng = 2654435761u * (index + 1);
+
+    Tile t;
+    while (true) {
+        while (deques[index].pop(t)) {
+            f(t.y0, t.y1);
+            pending.fetch_sub(1);
+        }
+
+        // look for a victim, starting at a random one so thieves spread out
+        bool found = false, retry = false;
+        rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+        for (int k = 0; k < threads && !found; k ++) {
+            int v = (int)((rng + k) % threads);
+            if (v == index)
+                continue;
+            int r = deques[v].steal(t);
+            if (r == WorkDeque::STOLEN)
+                found = true;
+            else if (r == WorkDeque::RETRY)
+                retry = true;
+        }
+
+        if (found) {
+            steals.fetch_add(1, std::memory_order_relaxed);
+            f(t.y0, t.y1);
+            pending.fetch_sub(1);
+        } else if (!retry) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::workerLoop(int index) {
+    setCurrentThread(index);
+    if (!cpus.empty())
+        pinThread(cpus[index]);
+    unsigned int seen = 0;
+
+    while (true) {
+        // spin briefly for the next pass (passes follow each other closely within a frame), then park
+        int spins = 0;
+        while (epoch.load() == seen && spins < 2000) {
+            std::this_thread::yield();
+            spins ++;
+        }
+        if (epoch.load() == seen) {
+            std::unique_lock<std::mutex> lock(parkMutex);
+            parkCv.wait(lock, [&]() { return epoch.load() != seen; });
+        }
+        seen = epoch.load();
+        if (stopping.load())
+            return;
+
+        if (each != NULL)
+            (*each)(index);
+        else
+            runTiles(index);
+        active.fetch_sub(1);
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * @file threadPool.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Work stealing thread pool for splitting solver passes into row tiles
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "executor.h"
+
+/**
+ * @brief Half open range of rows [y0, y1)
+ */
+struct Tile {
+    int y0, y1;
+};
+
+/**
+ * @brief Fixed capacity Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models").
+ * The owner pushes and pops at the bottom, any other thread steals from the top; neither side takes a lock
+ */
+class alignas(64) WorkDeque {
+    public:
+        enum { EMPTY = 0, STOLEN = 1, RETRY = 2 };
+
+        // drops all tiles and makes room for at least capacity; only while no thread is popping or stealing
+        void reset(int capacity);
+
+        void push(Tile t);
+        bool pop(Tile& t);
+        int steal(Tile& t);
+
+    private:
+        std::atomic<long long> top{0};
+        std::atomic<long long> bottom{0};
+        std::vector<Tile> buf;
+        long long mask = 0;
+};
+
+/**
+ * @brief Pool of size() - 1 worker threads plus the calling thread. parallelFor deals the tiles of a pass out to per thread deques in
+ * contiguous blocks (so each thread sweeps neighboring rows), every thread drains its own deque and then steals from the others,
+ * and the call returns once all tiles are done (a barrier between passes).
+ *
+ * A pinned pool restricts thread i (the caller being thread 0) to the i-th CPU of cpusByNode() (numa.h), so threads with neighboring
+ * indices, which get neighboring rows, share a socket, and the rows a thread first touched stay on its node
+ */
+class ThreadPool : public Executor {
+    public:
+        explicit ThreadPool(int threads = 0, bool pin = false);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // runs body(y0, y1) over the rows [0, n) in tiles of grain rows
+        void parallelFor(int n, int grain, FnRef<void(int, int)> body) override;
+
+        // runs body(i) once on every thread i, with no stealing; for work that has to happen on a particular thread, like first touch
+        void runOnEach(FnRef<void(int)> body) override;
+
+        // the CPU thread index is pinned to, or -1 if the pool is not pinned
+        int getCpu(int index) override { return cpus.empty() ? -1 : cpus[index]; }
+
+        int size() override { return (int)deques.size(); }
+        const char* name() override { return "pool"; }
+
+        // tiles taken from another thread's deque since the last reset
+        long long getSteals() { return steals.load(); }
+        void resetSteals() { steals = 0; }
+
+    private:
+        void workerLoop(int index);
+        void runTiles(int index);
+
+        std::vector<std::thread> workers;
+        std::vector<WorkDeque> deques;
+        std::vector<int> cpus; // per thread, if pinned
+
+        // current pass; a body of tiles, or one to run once per thread
+        const FnRef<void(int, int)>* body = NULL;
+        const FnRef<void(int)>* each = NULL;
+        std::atomic<long long> pending{0}; // tiles not yet finished
+        std::atomic<int> active{0};        // workers that have not yet left the pass
+        std::atomic<long long> steals{0};
+
+        // parking of idle workers between passes; the mutex is only taken to sleep and wake, never to hand out work
+        std::mutex parkMutex;
+        std::condition_variable parkCv;
+        std::atomic<unsigned int> epoch{0};
+        std::atomic<bool> stopping{false};
+};
+
+#endif
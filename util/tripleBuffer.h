@@ -0,0 +1,57 @@
+/**
+ * @file tripleBuffer.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief Lock free handoff of the latest complete frame from one producer thread to one consumer thread
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Three buffers of the same size: the producer writes the back one, the consumer reads the front one, and the third is the last
+ * published frame. publish swaps the back buffer with it, acquire swaps it with the front buffer if a new frame was published since;
+ * both are one atomic exchange, so neither side ever waits on the other. A consumer slower than the producer skips frames, one faster
+ * reads the same frame again
+ */
+template<class T>
+class TripleBuffer {
+    public:
+        explicit TripleBuffer(size_t n = 0) { resize(n); }
+
+        // only before either thread uses it; the buffers start zeroed
+        void resize(size_t n) {
+            for (int i = 0; i < 3; i ++)
+                buf[i].assign(n, T());
+            back = 0;
+            front = 1;
+            middle.store(2, std::memory_order_relaxed);
+        }
+
+        // producer only: the buffer to write the next frame into, and handing it over once it is complete
+        T* write() { return buf[back].data(); }
+        void publish() { back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX; }
+
+        // consumer only: takes the latest published frame if there is a new one (returning whether there was), and the frame taken last
+        bool acquire() {
+            if ((middle.load(std::memory_order_relaxed) & FRESH) == 0)
+                return false;
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+            return true;
+        }
+        const T* read() const { return buf[front].data(); }
+
+    private:
+        enum { INDEX = 3, FRESH = 4 };
+
+        std::vector<T> buf[3];
+        int back, front;             // owned by the producer and the consumer
+        alignas(64) std::atomic<int> middle; // index of the shared buffer, FRESH while it holds a frame the consumer has not taken
+};
+
+#endif
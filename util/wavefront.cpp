@@ -0,0 +1,47 @@
+/**
+ * @file wavefront.cpp
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief A chain of row tiled passes run as one skewed sweep over the tiles, so that each tile goes through every pass while resident
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#include "wavefront.h"
+
+#include <algorithm>
+
+void Wavefront::add(const char* name, std::function<void(int, int)> body) {
+    levels.push_back({ name, std::move(body) });
+    active.reserve(levels.size());
+}
+
+void Wavefront::run(Executor* pool, int rows, int tileRows, FnRef<void(int, int)> window) {
+    int n = (int)levels.size();
+    if (n == 0 || rows <= 0)
+        return;
+    int tiles = (rows + tileRows - 1) / tileRows;
+
+    for (int s = 0; s < tiles + 2 * (n - 1); s ++) {
+        window(s, s - 2 * (n - 1));
+
+        active.clear();
+        for (int k = 0; k < n; k ++) {
+            int t = s - 2 * k;
+            if (t >= 0 && t < tiles)
+                active.push_back(k);
+        }
+
+        // one item per level, most of them a few rows each; the step ends at the executor's barrier
+        auto item = [&](int i0, int i1) {
+            for (int i = i0; i < i1; i ++) {
+                int k = active[i];
+                int t = s - 2 * k;
+                levels[k].body(t * tileRows, std::min(rows, (t + 1) * tileRows));
+            }
+        };
+        if (pool != NULL)
+            pool->parallelFor((int)active.size(), 1, item);
+        else
+            item(0, (int)active.size());
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * @file wavefront.h
+ * @author Eron Ristich (eron@ristich.com)
+ * @brief A chain of row tiled passes run as one skewed sweep over the tiles, so that each tile goes through every pass while resident
+ * @version 0.1
+ * @date 2026-10-18
+ */
+
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include <functional>
+#include <vector>
+
+#include "executor.h"
+#include "fnRef.h"
+
+/*
+Running a chain of passes one after the other streams every plane they touch through memory once per pass. A Wavefront runs them as
+levels of one sweep over tiles of rows instead: at step s, level k works on tile s - 2k, so the levels form a front moving up the grid
+with every level two tiles behind the one before it. This holds for chains where each pass reads the previous ones' output at most one
+row outside its own tile (Jacobi iterations, divergence, gradient), and where a pass writing into a plane that an earlier level also
+wrote (ping-pong) only overwrites data no later level still reads; given that, it computes exactly what running the passes in order does:
+
+    - level k - 1 finished tile t + 1, which level k reads the bottom row of, at step s - 1
+    - level k - 1 is working on tile t + 2 at step s, out of level k's reach, so all the levels of a step run at the same time
+    - level k + 1 reads tile t - 1 of level k's output, and level k - 1 writes tile t + 2: no two levels of a step touch the same rows
+
+Only the tiles between the front and the last level (2 * levels + 1 tiles) are in use at any time; window() tells the owner which, so it
+can read the tiles ahead of the front in before they are needed and drop the ones behind the last level (see tileStore.h).
+*/
+
+class Wavefront {
+    public:
+        Wavefront() = default;
+        Wavefront(const Wavefront&) = delete;
+        Wavefront& operator=(const Wavefront&) = delete;
+
+        // appends a level, body(y0, y1) over the rows of a tile; levels run in the order added
+        void add(const char* name, std::function<void(int, int)> body);
+
+        /**
+         * @brief Sweeps every level over rows [0, rows) in tiles of tileRows
+         *
+         * @param pool Runs the levels of each step side by side; NULL runs them in turn on the calling thread
+         * @param window Called before each step with the tile the first level is about to run (front) and the tile the last one is (back,
+         * possibly negative); tiles below back - 1 are no longer read
+         */
+        void run(Executor* pool, int rows, int tileRows, FnRef<void(int front, int back)> window);
+
+        int size() const { return (int)levels.size(); }
+
+        // tiles in use at once, the front's and the last level's included
+        int span() const { return 2 * (int)levels.size() + 1; }
+
+        const char* name(int level) const { return levels[level].name; }
+
+    private:
+        struct Level {
+            const char* name;
+            std::function<void(int, int)> body;
+        };
+
+        std::vector<Level> levels;
+        std::vector<int> active; // the levels with a tile in the current step
+};
+
+#endif